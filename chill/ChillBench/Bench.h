@@ -0,0 +1,52 @@
+/** @file */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace chill {
+
+  class ProcessingGraph;
+
+  namespace bench {
+
+    /**
+     *  Split a comma separated list of integers.
+     *  @param _list The list, e.g. "100,1000,10000".
+     *  @return The integers.
+     **/
+    std::vector<int> parseSizes(const std::string& _list);
+
+    /**
+     *  Build a graph of nodes linked one after the other, with a few tweaks each.
+     *  @param _size The number of nodes.
+     *  @return The graph.
+     **/
+    std::shared_ptr<ProcessingGraph> buildChain(int _size);
+
+    /**
+     *  Run the UI frame benchmark on synthetic graphs.
+     *  @return The exit code of the program.
+     **/
+    int ui(int _argc, char** _argv);
+
+    /**
+     *  Run the node header parsing benchmark over a node library.
+     *  @return The exit code of the program.
+     **/
+    int parse(int _argc, char** _argv);
+
+    /**
+     *  Run the graph loading benchmark, Lua against binary graphs.
+     *  @return The exit code of the program.
+     **/
+    int load(int _argc, char** _argv);
+
+    /**
+     *  Check that the journal of a loaded graph restores its edits after a crash.
+     *  @return The exit code of the program, 1 if the edits are lost.
+     **/
+    int journal(int _argc, char** _argv);
+  }
+}
@@ -0,0 +1,127 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "GraphJournal.h"
+#include "GraphLoader.h"
+#include "IOs.h"
+#include "NodeEditor.h"
+#include "ProcessingGraph.h"
+
+namespace chill {
+  namespace bench {
+
+    namespace {
+      /** The nodes, their tweaks and their links by name, in an order that does not depend on the addresses */
+      std::vector<std::string> describe(ProcessingGraph& _graph) {
+        std::vector<std::string> lines;
+        for (std::shared_ptr<Processor> processor : *_graph.processors()) {
+          std::string line = processor->name();
+          for (std::shared_ptr<ProcessorInput> input : processor->inputs()) {
+            line += std::string(" ") + input->name() + "=";
+            if (input->m_link) {
+              line += std::string(input->m_link->owner()->name()) + "/" + input->m_link->name();
+            } else {
+              line += input->getLuaValue();
+            }
+          }
+          lines.push_back(line);
+          ProcessingGraph* inner = dynamic_cast<ProcessingGraph*>(processor.get());
+          if (inner) {
+            std::vector<std::string> nested = describe(*inner);
+            lines.insert(lines.end(), nested.begin(), nested.end());
+          }
+        }
+        std::sort(lines.begin(), lines.end());
+        return lines;
+      }
+
+      std::shared_ptr<ProcessingGraph> load(const fs::path& _path) {
+        std::string error;
+        std::unique_ptr<GraphLoader> loader = GraphLoader::open(_path, error);
+        if (!loader) {
+          std::cerr << "cannot load " << _path.string() << ": " << error << std::endl;
+          return nullptr;
+        }
+        loader->finish();
+        return loader->graph();
+      }
+    }
+
+    //-------------------------------------------------------
+
+    int journal(int _argc, char** _argv) {
+      int size = 100;
+      for (int i = 0; i + 1 < _argc; i += 2) {
+        std::string option = _argv[i];
+        std::string value  = _argv[i + 1];
+        if (option == "--size") {
+          size = std::max(3, std::stoi(value));
+        } else {
+          std::cerr << "unknown option " << option << std::endl;
+          return 1;
+        }
+      }
+
+      NodeEditor* editor    = NodeEditor::Instance();
+      editor->m_auto_save   = false;
+      editor->m_auto_export = false;
+
+      // a file written by an earlier session, its nodes named after other addresses
+      fs::path path = fs::temp_directory_path() / "chill-journal.graph";
+      std::error_code removed;
+      fs::remove(path.string() + ".journal", removed);
+      fs::remove(path.string() + ".journal.next", removed);
+      {
+        LuaWriter writer;
+        buildChain(size)->save(writer);
+        writer.save(path);
+      }
+
+      std::shared_ptr<ProcessingGraph> graph = load(path);
+      if (!graph) {
+        return 1;
+      }
+      // never closed, as when the editor is killed
+      GraphJournal* journal = new GraphJournal();
+      journal->open(path, *graph, false);
+
+      // one tweak and one link
+      std::vector<std::shared_ptr<Processor>>& nodes = *graph->processors();
+      nodes[size / 2]->input("radius")->setValue("4.5");
+      Processor::disconnect(nodes[size / 2 + 1]->input("shape"));
+      journal->record(*graph);
+      // the editor polls at each frame, the edits are synced once the batch is old enough
+      for (int i = 0; i < 10; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        journal->poll();
+      }
+
+      std::shared_ptr<ProcessingGraph> reloaded = load(path);
+      if (!reloaded) {
+        return 1;
+      }
+      std::vector<std::string> expected = describe(*graph);
+      std::vector<std::string> recovered = describe(*reloaded);
+      size_t differences = 0;
+      for (size_t i = 0; i < std::max(expected.size(), recovered.size()); ++i) {
+        if (i >= expected.size() || i >= recovered.size() || expected[i] != recovered[i]) {
+          differences++;
+        }
+      }
+      editor->setMainGraph(std::shared_ptr<ProcessingGraph>(new ProcessingGraph()));
+
+      std::cout << "nodes           " << size << std::endl;
+      std::cout << "journal         " << journal->bytes() << " bytes, " << journal->snapshots() << " snapshots" << std::endl;
+      if (differences > 0) {
+        std::cout << "replay          FAILED, " << differences << " nodes differ" << std::endl;
+        return 1;
+      }
+      std::cout << "replay          ok" << std::endl;
+      return 0;
+    }
+  }
+}
@@ -0,0 +1,213 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include "GraphBinary.h"
+#include "GraphData.h"
+#include "GraphParser.h"
+#include "GraphSaver.h"
+#include "IOs.h"
+#include "NodeEditor.h"
+#include "ProcessingGraph.h"
+
+namespace chill {
+  namespace bench {
+
+    std::shared_ptr<ProcessingGraph> buildChain(int _size) {
+      std::shared_ptr<ProcessingGraph> graph(new ProcessingGraph("chain"));
+      std::shared_ptr<Processor> previous;
+      for (int i = 0; i < _size; ++i) {
+        std::shared_ptr<Processor> node = graph->addProcessor<Processor>("node " + std::to_string(i));
+        node->setPosition(Vec2((i % 64) * 220.0F, (i / 64) * 160.0F));
+
+        std::shared_ptr<ProcessorInput> shape(new ImplicitInput());
+        shape->setName("shape");
+        node->addInput(shape);
+        std::shared_ptr<ProcessorInput> radius(new RealInput(1.0F + i % 7, 0.0F, 10.0F));
+        radius->setName("radius");
+        node->addInput(radius);
+        std::shared_ptr<ProcessorInput> count(new IntInput(i % 5, 0, 10));
+        count->setName("count");
+        node->addInput(count);
+        node->addOutput("shape", IOType::IMPLICIT);
+
+        if (previous) {
+          Processor::connect(previous->output("shape"), node->input("shape"));
+        }
+        previous = node;
+      }
+      return graph;
+    }
+
+    //-------------------------------------------------------
+
+    namespace {
+      typedef std::chrono::high_resolution_clock Clock;
+
+      double since(Clock::time_point _start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - _start).count();
+      }
+
+      size_t countNodes(ProcessingGraph& _graph) {
+        size_t count = 0;
+        for (std::shared_ptr<Processor> processor : *_graph.processors()) {
+          ProcessingGraph* inner = dynamic_cast<ProcessingGraph*>(processor.get());
+          count += 1 + (inner ? countNodes(*inner) : 0);
+        }
+        return count;
+      }
+
+      struct Result {
+        std::string name;
+        size_t nodes        = 0;
+        size_t lua_bytes    = 0;
+        size_t binary_bytes = 0;
+        double lua_ms       = 0.0;
+        double text_ms      = 0.0;
+        double open_ms      = 0.0;
+        double binary_ms    = 0.0;
+      };
+
+      Result run(const std::string& _name, std::shared_ptr<ProcessingGraph> _graph, int _iterations) {
+        Result result;
+        result.name  = _name;
+        result.nodes = countNodes(*_graph);
+
+        fs::path folder = fs::temp_directory_path();
+        fs::path lua    = folder / "chill-bench.graph";
+        fs::path binary = folder / (std::string("chill-bench") + GraphBinary::c_extension);
+
+        LuaWriter writer;
+        _graph->save(writer);
+        writer.save(lua);
+        result.lua_bytes = writer.size();
+
+        GraphData data = GraphData::capture(*_graph);
+        GraphBinary::save(data, binary);
+        result.binary_bytes = static_cast<size_t>(fs::file_size(binary));
+
+        for (int i = 0; i < _iterations; ++i) {
+          auto start = Clock::now();
+          std::shared_ptr<ProcessingGraph> executed;
+          {
+            GraphSaver loader;
+            loader.execute(&lua);
+            executed = loader.mainGraph();
+          }
+          result.lua_ms += since(start);
+          executed.reset();
+
+          start = Clock::now();
+          {
+            std::ifstream stream(lua, std::ios::binary);
+            std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+            GraphData parsed;
+            std::string error;
+            if (GraphParser::parse(text, parsed, error)) {
+              parsed.view().instantiate();
+            }
+          }
+          result.text_ms += since(start);
+
+          start = Clock::now();
+          GraphBinary file;
+          file.open(binary);
+          result.open_ms += since(start);
+          std::shared_ptr<ProcessingGraph> loaded = file.view().instantiate();
+          result.binary_ms += since(start);
+          loaded.reset();
+        }
+        result.lua_ms    /= _iterations;
+        result.text_ms   /= _iterations;
+        result.open_ms   /= _iterations;
+        result.binary_ms /= _iterations;
+        return result;
+      }
+    }
+
+    //-------------------------------------------------------
+
+    int load(int _argc, char** _argv) {
+      std::vector<int> sizes = { 100, 1000, 10000 };
+      std::string graph;
+      int iterations = 5;
+      std::string csv;
+
+      for (int i = 0; i + 1 < _argc; i += 2) {
+        std::string option = _argv[i];
+        std::string value  = _argv[i + 1];
+        if (option == "--sizes") {
+          sizes = parseSizes(value);
+        } else if (option == "--graph") {
+          graph = value;
+        } else if (option == "--iterations") {
+          iterations = std::max(1, std::stoi(value));
+        } else if (option == "--csv") {
+          csv = value;
+        } else {
+          std::cerr << "unknown option " << option << std::endl;
+          return 1;
+        }
+      }
+
+      NodeEditor* editor    = NodeEditor::Instance();
+      editor->m_auto_save   = false;
+      editor->m_auto_export = false;
+
+      std::vector<Result> results;
+      if (!graph.empty()) {
+        // an existing graph, loaded once through Lua to get it in memory
+        fs::path path(graph);
+        GraphSaver loader;
+        loader.execute(&path);
+        if (!loader.mainGraph()) {
+          std::cerr << "cannot load " << graph << std::endl;
+          return 1;
+        }
+        results.push_back(run(path.filename().string(), loader.mainGraph(), iterations));
+      } else {
+        for (int size : sizes) {
+          results.push_back(run("chain", buildChain(size), iterations));
+        }
+      }
+      editor->setMainGraph(std::shared_ptr<ProcessingGraph>(new ProcessingGraph()));
+
+      std::cout << std::left << std::setw(16) << "graph" << std::right
+                << std::setw(8)  << "nodes"
+                << std::setw(12) << "lua bytes"
+                << std::setw(12) << "lua ms"
+                << std::setw(12) << "text ms"
+                << std::setw(12) << "bin bytes"
+                << std::setw(10) << "open ms"
+                << std::setw(10) << "bin ms"
+                << std::setw(10) << "speedup" << std::endl;
+      for (const Result& r : results) {
+        std::cout << std::left << std::setw(16) << r.name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(8)  << r.nodes
+                  << std::setw(12) << r.lua_bytes
+                  << std::setw(12) << r.lua_ms
+                  << std::setw(12) << r.text_ms
+                  << std::setw(12) << r.binary_bytes
+                  << std::setw(10) << r.open_ms
+                  << std::setw(10) << r.binary_ms
+                  << std::setw(9)  << std::setprecision(1) << (r.binary_ms > 0.0 ? r.lua_ms / r.binary_ms : 0.0) << "x" << std::endl;
+      }
+
+      if (!csv.empty()) {
+        std::ofstream file(csv);
+        file << "graph,nodes,lua_bytes,lua_ms,text_ms,binary_bytes,open_ms,binary_ms" << std::endl;
+        for (const Result& r : results) {
+          file << r.name << "," << r.nodes << "," << r.lua_bytes << "," << r.lua_ms << "," << r.text_ms << ","
+               << r.binary_bytes << "," << r.open_ms << "," << r.binary_ms << std::endl;
+        }
+      }
+      return 0;
+    }
+  }
+}
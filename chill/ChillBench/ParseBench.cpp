@@ -0,0 +1,115 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "NodeCatalog.h"
+#include "NodeEditor.h"
+#include "NodeSignature.h"
+
+namespace chill {
+  namespace bench {
+
+    namespace {
+      typedef std::chrono::high_resolution_clock Clock;
+
+      struct NodeFile {
+        std::string path;
+        std::string program;
+      };
+    }
+
+    //-------------------------------------------------------
+
+    int parse(int _argc, char** _argv) {
+      std::string nodes;
+      int iterations = 20;
+      std::string csv;
+
+      for (int i = 0; i + 1 < _argc; i += 2) {
+        std::string option = _argv[i];
+        std::string value  = _argv[i + 1];
+        if (option == "--nodes") {
+          nodes = value;
+        } else if (option == "--iterations") {
+          iterations = std::max(1, std::stoi(value));
+        } else if (option == "--csv") {
+          csv = value;
+        } else {
+          std::cerr << "unknown option " << option << std::endl;
+          return 1;
+        }
+      }
+
+      NodeCatalog catalog;
+      catalog.setRoot(nodes.empty() ? NodeEditor::Instance()->nodeCatalog().root() : nodes);
+
+      // files are read once, only the parsing is timed
+      std::vector<NodeFile> files;
+      size_t bytes = 0;
+      for (const NodeCatalog::Node& node : catalog.nodes()) {
+        std::ifstream file(node.path, std::ios::binary);
+        std::ostringstream content;
+        content << file.rdbuf();
+        files.push_back({ node.path, content.str() });
+        bytes += files.back().program.size();
+      }
+      if (files.empty()) {
+        std::cerr << "no node file in " << catalog.root() << std::endl;
+        return 1;
+      }
+
+      std::ofstream csv_file;
+      if (!csv.empty()) {
+        csv_file.open(csv);
+        csv_file << "path,bytes,inputs,outputs,us" << std::endl;
+      }
+
+      size_t inputs  = 0;
+      size_t outputs = 0;
+      double total_ms = 0.0;
+      double best_ms  = 0.0;
+      std::vector<double> file_us(files.size(), 0.0);
+      for (int it = 0; it < iterations; ++it) {
+        double pass_ms = 0.0;
+        for (size_t f = 0; f < files.size(); ++f) {
+          auto start = Clock::now();
+          NodeSignature signature = NodeSignature::parse(files[f].program);
+          double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+          pass_ms    += us / 1000.0;
+          file_us[f] += us;
+          if (it == 0) {
+            inputs  += signature.inputs.size();
+            outputs += signature.outputs.size();
+          }
+        }
+        total_ms += pass_ms;
+        best_ms   = (it == 0) ? pass_ms : std::min(best_ms, pass_ms);
+      }
+
+      double avg_ms = total_ms / iterations;
+      double mb     = bytes / (1024.0 * 1024.0);
+      std::cout << std::fixed << std::setprecision(3)
+                << "library     " << catalog.root() << std::endl
+                << "files       " << files.size() << " (" << mb << " MB, "
+                << inputs << " inputs, " << outputs << " outputs)" << std::endl
+                << "pass ms     " << avg_ms << " avg, " << best_ms << " best over " << iterations << std::endl
+                << "throughput  " << mb / (best_ms / 1000.0) << " MB/s, "
+                << files.size() / (best_ms / 1000.0) << " files/s" << std::endl;
+
+      if (csv_file.is_open()) {
+        for (size_t f = 0; f < files.size(); ++f) {
+          NodeSignature signature = NodeSignature::parse(files[f].program);
+          csv_file << files[f].path << "," << files[f].program.size() << ","
+                   << signature.inputs.size() << "," << signature.outputs.size() << ","
+                   << file_us[f] / iterations << std::endl;
+        }
+      }
+      return 0;
+    }
+  }
+}
@@ -0,0 +1,260 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "HeadlessUI.h"
+#include "IOs.h"
+#include "NodeEditor.h"
+#include "ProcessingGraph.h"
+
+namespace chill {
+  namespace bench {
+
+    namespace {
+      const ImVec2 c_view_size   = ImVec2(1600, 900);
+      const ImVec2 c_spacing     = ImVec2(220, 160);
+      const int    c_columns     = 64;
+      const int    c_group_nodes = 8;
+      const int    c_group_depth = 4;
+
+      typedef std::chrono::high_resolution_clock Clock;
+
+      Vec2 gridPosition(int _index) {
+        return Vec2((_index % c_columns) * c_spacing.x, (_index / c_columns) * c_spacing.y);
+      }
+
+      // The synthetic graphs have no cycle, and Processor::connect walks every
+      // upstream node to look for one: wire them directly.
+      void link(std::shared_ptr<ProcessorOutput> _from, std::shared_ptr<ProcessorInput> _to) {
+        _to->m_link = _from;
+        _from->m_links.push_back(_to);
+      }
+
+      std::shared_ptr<Processor> addNode(ProcessingGraph& _graph, int _index) {
+        std::shared_ptr<Processor> node = _graph.addProcessor<Processor>("node " + std::to_string(_index));
+        node->setPosition(gridPosition(_index));
+
+        std::shared_ptr<ProcessorInput> shape(new ImplicitInput());
+        shape->setName("shape");
+        node->addInput(shape);
+
+        std::shared_ptr<ProcessorInput> radius(new RealInput(1.0F, 0.0F, 10.0F));
+        radius->setName("radius");
+        node->addInput(radius);
+
+        node->addOutput("shape", IOType::IMPLICIT);
+        return node;
+      }
+
+      /** Nodes linked one after the other */
+      int buildChain(ProcessingGraph& _graph, int _size) {
+        std::shared_ptr<Processor> previous;
+        for (int i = 0; i < _size; ++i) {
+          std::shared_ptr<Processor> node = addNode(_graph, i);
+          if (previous) {
+            link(previous->output("shape"), node->input("shape"));
+          }
+          previous = node;
+        }
+        return _size;
+      }
+
+      /** One node feeding all the others */
+      int buildFan(ProcessingGraph& _graph, int _size) {
+        std::shared_ptr<Processor> source = addNode(_graph, 0);
+        for (int i = 1; i < _size; ++i) {
+          link(source->output("shape"), addNode(_graph, i)->input("shape"));
+        }
+        return _size;
+      }
+
+      /** A chain of groups, each one holding a few nodes and the next nested group */
+      int buildGroup(ProcessingGraph& _group, int _depth) {
+        int count = buildChain(_group, c_group_nodes);
+        if (_depth > 1) {
+          std::shared_ptr<ProcessingGraph> inner = _group.addProcessor<ProcessingGraph>("group");
+          inner->setPosition(gridPosition(c_group_nodes));
+          count += 1 + buildGroup(*inner, _depth - 1);
+        }
+        return count;
+      }
+
+      int buildDeep(ProcessingGraph& _graph, int _size) {
+        int per_group = c_group_depth * (c_group_nodes + 1);
+        int groups    = std::max(1, _size / per_group);
+        int count     = 0;
+
+        std::shared_ptr<ProcessingGraph> previous;
+        for (int i = 0; i < groups; ++i) {
+          std::shared_ptr<ProcessingGraph> group = _graph.addProcessor<ProcessingGraph>("group " + std::to_string(i));
+          group->setPosition(gridPosition(i));
+          group->addInput(std::shared_ptr<ProcessorInput>(new ImplicitInput()))->setName("shape");
+          group->addOutput("shape", IOType::IMPLICIT);
+          if (previous) {
+            link(previous->output("shape"), group->input("shape"));
+          }
+          previous = group;
+          count += 1 + buildGroup(*group, c_group_depth);
+        }
+        return count;
+      }
+
+      struct Result {
+        std::string shape;
+        int    nodes     = 0;
+        double build_ms  = 0.0;
+        double avg_ms    = 0.0;
+        double max_ms    = 0.0;
+        double phases_ms[FrameProfiler::PHASE_COUNT] = {};
+        HeadlessUI::DrawStats draw;
+      };
+
+      Result run(HeadlessUI& _ui, const std::string& _shape, int _size, int _frames, int _warmup) {
+        Result result;
+        result.shape = _shape;
+
+        auto build_start = Clock::now();
+        std::shared_ptr<ProcessingGraph> graph(new ProcessingGraph());
+        if (_shape == "fan") {
+          result.nodes = buildFan(*graph, _size);
+        } else if (_shape == "deep") {
+          result.nodes = buildDeep(*graph, _size);
+        } else {
+          result.nodes = buildChain(*graph, _size);
+        }
+        // a dirty node would trigger an undo snapshot of the whole graph
+        for (std::shared_ptr<Processor> processor : *graph->processors()) {
+          processor->setDirty(false);
+        }
+        result.build_ms = std::chrono::duration<double, std::milli>(Clock::now() - build_start).count();
+
+        NodeEditor* editor = NodeEditor::Instance();
+        editor->setMainGraph(graph);
+
+        for (int f = 0; f < _warmup + _frames; ++f) {
+          // keep the mouse over the view so that the hit tests run
+          ImGui::GetIO().MousePos = ImVec2(200, 20) + c_view_size / 2.0F;
+
+          auto start = Clock::now();
+          _ui.newFrame();
+          editor->drawGraphView(c_view_size);
+          HeadlessUI::DrawStats stats = _ui.render();
+          double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+          if (f < _warmup) {
+            continue;
+          }
+          result.avg_ms += ms;
+          result.max_ms  = std::max(result.max_ms, ms);
+          for (int p = 0; p < FrameProfiler::PHASE_COUNT; ++p) {
+            result.phases_ms[p] += editor->profiler().lastMs(static_cast<FrameProfiler::Phase>(p));
+          }
+          result.draw = stats;
+        }
+
+        int n = std::max(_frames, 1);
+        result.avg_ms /= n;
+        for (int p = 0; p < FrameProfiler::PHASE_COUNT; ++p) {
+          result.phases_ms[p] /= n;
+        }
+        return result;
+      }
+    }
+
+    //-------------------------------------------------------
+
+    int ui(int _argc, char** _argv) {
+      std::vector<std::string> shapes = { "chain", "fan", "deep" };
+      std::vector<int>         sizes  = { 100, 1000, 10000, 50000 };
+      int frames = 120;
+      int warmup = 10;
+      std::string csv;
+
+      for (int i = 0; i + 1 < _argc; i += 2) {
+        std::string option = _argv[i];
+        std::string value  = _argv[i + 1];
+        if (option == "--shapes") {
+          shapes.clear();
+          std::stringstream stream(value);
+          std::string shape;
+          while (std::getline(stream, shape, ',')) shapes.push_back(shape);
+        } else if (option == "--sizes") {
+          sizes = parseSizes(value);
+        } else if (option == "--frames") {
+          frames = std::stoi(value);
+        } else if (option == "--warmup") {
+          warmup = std::stoi(value);
+        } else if (option == "--csv") {
+          csv = value;
+        } else {
+          std::cerr << "unknown option " << option << std::endl;
+          return 1;
+        }
+      }
+
+      NodeEditor* editor    = NodeEditor::Instance();
+      editor->m_auto_save   = false;
+      editor->m_auto_export = false;
+
+      HeadlessUI headless(ImVec2(200, 20) + c_view_size);
+
+      std::ofstream csv_file;
+      if (!csv.empty()) {
+        csv_file.open(csv);
+        csv_file << "shape,nodes,build_ms,frame_ms,max_ms";
+        for (int p = 0; p < FrameProfiler::PHASE_COUNT; ++p) {
+          std::string name = FrameProfiler::phaseName(p);
+          std::replace(name.begin(), name.end(), ' ', '_');
+          csv_file << "," << name << "_ms";
+        }
+        csv_file << ",vertices,indices,commands" << std::endl;
+      }
+
+      std::cout << std::left << std::setw(7) << "shape" << std::right
+                << std::setw(8)  << "nodes"
+                << std::setw(11) << "frame ms"
+                << std::setw(10) << "max ms"
+                << std::setw(10) << "grid"
+                << std::setw(10) << "pipes"
+                << std::setw(10) << "nodes"
+                << std::setw(11) << "vertices"
+                << std::setw(10) << "indices"
+                << std::setw(8)  << "cmds" << std::endl;
+
+      for (const std::string& shape : shapes) {
+        for (int size : sizes) {
+          Result r = run(headless, shape, size, frames, warmup);
+
+          std::cout << std::left << std::setw(7) << r.shape << std::right << std::fixed << std::setprecision(3)
+                    << std::setw(8)  << r.nodes
+                    << std::setw(11) << r.avg_ms
+                    << std::setw(10) << r.max_ms
+                    << std::setw(10) << r.phases_ms[FrameProfiler::GRID]
+                    << std::setw(10) << r.phases_ms[FrameProfiler::PIPES]
+                    << std::setw(10) << r.phases_ms[FrameProfiler::NODES]
+                    << std::setw(11) << r.draw.vertices
+                    << std::setw(10) << r.draw.indices
+                    << std::setw(8)  << r.draw.commands << std::endl;
+
+          if (csv_file.is_open()) {
+            csv_file << r.shape << "," << r.nodes << "," << r.build_ms << "," << r.avg_ms << "," << r.max_ms;
+            for (int p = 0; p < FrameProfiler::PHASE_COUNT; ++p) {
+              csv_file << "," << r.phases_ms[p];
+            }
+            csv_file << "," << r.draw.vertices << "," << r.draw.indices << "," << r.draw.commands << std::endl;
+          }
+        }
+      }
+
+      // release the last graph while the ImGui context is still alive
+      editor->setMainGraph(std::shared_ptr<ProcessingGraph>(new ProcessingGraph()));
+      return 0;
+    }
+  }
+}
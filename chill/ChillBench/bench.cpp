@@ -0,0 +1,60 @@
+#include "Bench.h"
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace chill {
+  namespace bench {
+
+    std::vector<int> parseSizes(const std::string& _list) {
+      std::vector<int> sizes;
+      std::stringstream stream(_list);
+      std::string item;
+      while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+          sizes.push_back(std::stoi(item));
+        }
+      }
+      return sizes;
+    }
+  }
+}
+
+//-------------------------------------------------------
+
+static void usage() {
+  std::cout << "usage: ChillBench <benchmark> [options]" << std::endl
+            << "  ui    draw synthetic graphs without GL backend" << std::endl
+            << "        --shapes chain,fan,deep  --sizes 100,1000,10000,50000" << std::endl
+            << "        --frames 120  --warmup 10  --csv <file>" << std::endl
+            << "  parse parse the headers of every node of a library" << std::endl
+            << "        --nodes <folder>  --iterations 20  --csv <file>" << std::endl
+            << "  load  load graphs saved as Lua and as binary" << std::endl
+            << "        --sizes 100,1000,10000 | --graph <file>  --iterations 5  --csv <file>" << std::endl
+            << "  journal  edit a loaded graph, stop without closing its journal, check the reload" << std::endl
+            << "        --size 100" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    usage();
+    return 1;
+  }
+
+  if (std::strcmp(argv[1], "ui") == 0) {
+    return chill::bench::ui(argc - 2, argv + 2);
+  }
+  if (std::strcmp(argv[1], "parse") == 0) {
+    return chill::bench::parse(argc - 2, argv + 2);
+  }
+  if (std::strcmp(argv[1], "load") == 0) {
+    return chill::bench::load(argc - 2, argv + 2);
+  }
+  if (std::strcmp(argv[1], "journal") == 0) {
+    return chill::bench::journal(argc - 2, argv + 2);
+  }
+
+  usage();
+  return 1;
+}
@@ -0,0 +1,63 @@
+/** @file */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace chill {
+
+  /**
+   *  Vec2 struct.
+   *  A position or a size in graph coordinates. The model needs no window:
+   *  the editor converts to the types of ImGui as it draws, see ImGuiTypes.h.
+   **/
+  struct Vec2
+  {
+    float x, y;
+
+    Vec2() : x(0.0f), y(0.0f) {}
+    Vec2(float _x, float _y) : x(_x), y(_y) {}
+
+    float  operator[](size_t _i) const { return _i == 0 ? x : y; }
+    float& operator[](size_t _i)       { return _i == 0 ? x : y; }
+  };
+
+  inline Vec2  operator*(const Vec2& _a, float _s)       { return Vec2(_a.x * _s, _a.y * _s); }
+  inline Vec2  operator/(const Vec2& _a, float _s)       { return Vec2(_a.x / _s, _a.y / _s); }
+  inline Vec2  operator+(const Vec2& _a, const Vec2& _b) { return Vec2(_a.x + _b.x, _a.y + _b.y); }
+  inline Vec2  operator-(const Vec2& _a, const Vec2& _b) { return Vec2(_a.x - _b.x, _a.y - _b.y); }
+  inline Vec2& operator+=(Vec2& _a, const Vec2& _b)      { _a.x += _b.x; _a.y += _b.y; return _a; }
+  inline Vec2& operator-=(Vec2& _a, const Vec2& _b)      { _a.x -= _b.x; _a.y -= _b.y; return _a; }
+  inline Vec2& operator*=(Vec2& _a, float _s)            { _a.x *= _s; _a.y *= _s; return _a; }
+  inline Vec2& operator/=(Vec2& _a, float _s)            { _a.x /= _s; _a.y /= _s; return _a; }
+
+  //-------------------------------------------------------
+
+  /**
+   *  Color struct.
+   *  An 8 bits per channel color, as written in the graph files.
+   **/
+  struct Color
+  {
+    uint8_t r, g, b, a;
+
+    Color() : r(0), g(0), b(0), a(255) {}
+    Color(int _r, int _g, int _b, int _a = 255)
+      : r(static_cast<uint8_t>(_r)), g(static_cast<uint8_t>(_g)), b(static_cast<uint8_t>(_b)), a(static_cast<uint8_t>(_a)) {}
+
+    /**
+     *  Get the same color with another opacity.
+     *  @param _a The opacity, 0 to 255.
+     **/
+    Color withAlpha(int _a) const {
+      return Color(r, g, b, _a);
+    }
+
+    bool operator==(const Color& _other) const {
+      return r == _other.r && g == _other.g && b == _other.b && a == _other.a;
+    }
+    bool operator!=(const Color& _other) const {
+      return !(*this == _other);
+    }
+  };
+}
@@ -3,7 +3,7 @@
 #include <string>
 #include <vector>
 
-static const std::vector<const char*> OFD_FILTER_GRAPHS = std::vector<const char*>({ "*.graph", "*.lua" });
+static const std::vector<const char*> OFD_FILTER_GRAPHS = std::vector<const char*>({ "*.graph", "*.graphb", "*.lua" });
 static const std::vector<const char*> OFD_FILTER_NODES  = std::vector<const char*>({ "*.node" , "*.lua" });
 static const std::vector<const char*> OFD_FILTER_LUA    = std::vector<const char*>({ "*.lua" });
 static const std::vector<const char*> OFD_FILTER_ALL    = std::vector<const char*>({ "*.*" });
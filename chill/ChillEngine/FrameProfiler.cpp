@@ -0,0 +1,148 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <fstream>
+#include <iostream>
+
+#include <LibSL/LibSL.h>
+
+namespace chill {
+
+  const char* FrameProfiler::phaseName(int _phase) {
+    static const char* names[PHASE_COUNT] = {
+      "hit test", "grid", "pipes", "nodes", "menus", "evaluate", "export", "save", "undo"
+    };
+    return (_phase >= 0 && _phase < PHASE_COUNT) ? names[_phase] : "unknown";
+  }
+
+  //-------------------------------------------------------
+
+  FrameProfiler::FrameProfiler() {
+    std::fill(&m_ms[0][0], &m_ms[0][0] + PHASE_COUNT * c_history, 0.0F);
+    std::fill(&m_vertices[0][0], &m_vertices[0][0] + PHASE_COUNT * c_history, 0);
+    std::fill(&m_commands[0][0], &m_commands[0][0] + PHASE_COUNT * c_history, 0);
+    std::fill(m_frame_ms, m_frame_ms + c_history, 0.0F);
+    beginFrame();
+  }
+
+  //-------------------------------------------------------
+
+  void FrameProfiler::beginFrame() {
+    std::fill(m_current_ms, m_current_ms + PHASE_COUNT, 0.0F);
+    std::fill(m_current_vertices, m_current_vertices + PHASE_COUNT, 0);
+    std::fill(m_current_commands, m_current_commands + PHASE_COUNT, 0);
+    m_frame_start = Clock::now();
+  }
+
+  //-------------------------------------------------------
+
+  void FrameProfiler::endFrame() {
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+      m_ms[p][m_head]       = m_current_ms[p];
+      m_vertices[p][m_head] = m_current_vertices[p];
+      m_commands[p][m_head] = m_current_commands[p];
+    }
+    m_frame_ms[m_head] = std::chrono::duration<float, std::milli>(Clock::now() - m_frame_start).count();
+
+    m_head  = (m_head + 1) % c_history;
+    m_count = std::min(m_count + 1, c_history);
+    m_frame++;
+  }
+
+  //-------------------------------------------------------
+
+  void FrameProfiler::begin(Phase _phase) {
+    Running& running  = m_running[_phase];
+    running.draw_list = ImGui::GetWindowDrawList();
+    running.vertices  = running.draw_list ? running.draw_list->VtxBuffer.Size : 0;
+    running.commands  = running.draw_list ? running.draw_list->CmdBuffer.Size : 0;
+    running.start     = Clock::now();
+  }
+
+  //-------------------------------------------------------
+
+  void FrameProfiler::end(Phase _phase) {
+    Running& running = m_running[_phase];
+    m_current_ms[_phase] += std::chrono::duration<float, std::milli>(Clock::now() - running.start).count();
+    // the draw list can change when the phase opens a popup, only count what went in the original one
+    if (running.draw_list) {
+      m_current_vertices[_phase] += std::max(0, running.draw_list->VtxBuffer.Size - running.vertices);
+      m_current_commands[_phase] += std::max(0, running.draw_list->CmdBuffer.Size - running.commands);
+    }
+    running.draw_list = nullptr;
+  }
+
+  //-------------------------------------------------------
+
+  void FrameProfiler::draw(bool* _open, const std::string& _csvFilename) {
+    ImGui::SetNextWindowSize(ImVec2(440, 0), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Profiler", _open)) {
+      ImGui::End();
+      return;
+    }
+
+    int   n = std::max(m_count, 1);
+    float frame_avg = 0.0F;
+    for (int i = 0; i < m_count; ++i) {
+      frame_avg += m_frame_ms[i];
+    }
+    ImGui::Text("frame %6.2f ms (%d frames)", frame_avg / n, m_count);
+    ImGui::PlotHistogram("##frame", m_frame_ms, c_history, m_head, nullptr, 0.0F, FLT_MAX, ImVec2(0, 40));
+    ImGui::Separator();
+
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+      float avg_ms = 0.0F, max_ms = 0.0F;
+      int   avg_vtx = 0, avg_cmd = 0;
+      for (int i = 0; i < m_count; ++i) {
+        avg_ms  += m_ms[p][i];
+        max_ms   = std::max(max_ms, m_ms[p][i]);
+        avg_vtx += m_vertices[p][i];
+        avg_cmd += m_commands[p][i];
+      }
+      ImGui::Text("%-8s %6.2f ms  max %6.2f  %7d vtx  %5d cmd",
+        phaseName(p), avg_ms / n, max_ms, avg_vtx / n, avg_cmd / n);
+      ImGui::PushID(p);
+      ImGui::PlotHistogram("##phase", m_ms[p], c_history, m_head, nullptr, 0.0F, FLT_MAX, ImVec2(0, 24));
+      ImGui::PopID();
+    }
+
+    ImGui::Separator();
+    if (ImGui::Button("Save CSV")) {
+      if (saveCSV(_csvFilename)) {
+        std::cout << "profile saved to " << _csvFilename << std::endl;
+      }
+    }
+
+    ImGui::End();
+  }
+
+  //-------------------------------------------------------
+
+  bool FrameProfiler::saveCSV(const std::string& _filename) const {
+    std::ofstream file(_filename);
+    if (!file) {
+      std::cerr << Console::red << "Unable to write the profile to " << _filename << Console::gray << std::endl;
+      return false;
+    }
+
+    file << "frame,frame_ms";
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+      std::string name = phaseName(p);
+      std::replace(name.begin(), name.end(), ' ', '_');
+      file << "," << name << "_ms," << name << "_vertices," << name << "_commands";
+    }
+    file << "\n";
+
+    int first = (m_head - m_count + c_history) % c_history;
+    for (int i = 0; i < m_count; ++i) {
+      int slot = (first + i) % c_history;
+      file << (m_frame - m_count + i) << "," << m_frame_ms[slot];
+      for (int p = 0; p < PHASE_COUNT; ++p) {
+        file << "," << m_ms[p][slot] << "," << m_vertices[p][slot] << "," << m_commands[p][slot];
+      }
+      file << "\n";
+    }
+    return true;
+  }
+}
@@ -0,0 +1,141 @@
+/** @file */
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "imgui/imgui.h"
+
+namespace chill {
+
+  /**
+   *  FrameProfiler class.
+   *  Measures the CPU time and the draw list growth of the phases of a frame,
+   *  keeps a rolling history and shows it in an overlay.
+   **/
+  class FrameProfiler
+  {
+  public:
+    /** Phases of a frame, in drawing order */
+    enum Phase {
+      HIT_TEST = 0,
+      GRID,
+      PIPES,
+      NODES,
+      MENUS,
+      EVALUATE,
+      EXPORT,
+      SAVE,
+      UNDO,
+      PHASE_COUNT
+    };
+
+    /** Number of frames kept in the history */
+    static const int c_history = 240;
+
+    /**
+     *  Get the printable name of a phase.
+     *  @param _phase The phase.
+     *  @return The name of the phase.
+     **/
+    static const char* phaseName(int _phase);
+
+    /**
+     *  Scope class.
+     *  Measures a phase from its construction to its destruction.
+     **/
+    class Scope
+    {
+    public:
+      Scope(FrameProfiler& _profiler, Phase _phase) : m_profiler(_profiler), m_phase(_phase) {
+        m_profiler.begin(m_phase);
+      }
+      ~Scope() {
+        m_profiler.end(m_phase);
+      }
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+
+    private:
+      FrameProfiler& m_profiler;
+      Phase          m_phase;
+    };
+
+    FrameProfiler();
+
+    /**
+     *  Start a new frame, the measures of the phases are reset.
+     **/
+    void beginFrame();
+
+    /**
+     *  End the current frame and push its measures in the history.
+     **/
+    void endFrame();
+
+    /**
+     *  Start measuring a phase. A phase can be measured several times per frame,
+     *  the measures are summed.
+     *  @param _phase The phase.
+     **/
+    void begin(Phase _phase);
+
+    /**
+     *  Stop measuring a phase.
+     *  @param _phase The phase.
+     **/
+    void end(Phase _phase);
+
+    /**
+     *  Get the time spent in a phase during the last frame.
+     *  @param _phase The phase.
+     *  @return The time in milliseconds.
+     **/
+    float lastMs(Phase _phase) const {
+      return m_count > 0 ? m_ms[_phase][(m_head + c_history - 1) % c_history] : 0.0F;
+    }
+
+    /**
+     *  Draw the overlay window.
+     *  @param _open Set to false when the window is closed.
+     *  @param _csvFilename Where the history is saved from the overlay.
+     **/
+    void draw(bool* _open, const std::string& _csvFilename);
+
+    /**
+     *  Write the history in a CSV file, oldest frame first.
+     *  @param _filename The file to write.
+     *  @return true if the file was written.
+     **/
+    bool saveCSV(const std::string& _filename) const;
+
+  private:
+    typedef std::chrono::high_resolution_clock Clock;
+
+    struct Running {
+      Clock::time_point start;
+      ImDrawList*       draw_list = nullptr;
+      int               vertices  = 0;
+      int               commands  = 0;
+    };
+
+    Running m_running[PHASE_COUNT];
+
+    float m_current_ms[PHASE_COUNT];
+    int   m_current_vertices[PHASE_COUNT];
+    int   m_current_commands[PHASE_COUNT];
+
+    float m_ms[PHASE_COUNT][c_history];
+    int   m_vertices[PHASE_COUNT][c_history];
+    int   m_commands[PHASE_COUNT][c_history];
+    float m_frame_ms[c_history];
+
+    Clock::time_point m_frame_start;
+    /** Next slot written in the history */
+    int   m_head  = 0;
+    /** Number of frames in the history */
+    int   m_count = 0;
+    /** Number of frames since the start */
+    long long m_frame = 0;
+  };
+}
@@ -0,0 +1,240 @@
+#include "GraphBinary.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <LibSL/LibSL.h>
+
+#include "GraphJournal.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace chill {
+
+  const uint32_t GraphBinary::c_version   = 1;
+  const char*    GraphBinary::c_extension = ".graphb";
+
+  namespace {
+    const char     c_magic[8]   = { 'C', 'H', 'I', 'L', 'L', 'G', 'B', '\n' };
+    const uint32_t c_byte_order = 0x01020304u;
+
+    /** Offsets are from the start of the file */
+    struct Header {
+      char     magic[8];
+      uint32_t version;
+      uint32_t byte_order;
+      uint32_t root;
+      uint32_t node_count;
+      uint32_t port_count;
+      uint32_t edge_count;
+      uint32_t string_count;
+      uint32_t string_size;
+      uint64_t nodes;
+      uint64_t ports;
+      uint64_t edges;
+      uint64_t string_offsets;
+      uint64_t string_bytes;
+      uint64_t file_size;
+    };
+    static_assert(sizeof(Header) == 88, "GraphBinary header layout");
+
+    uint64_t align(uint64_t _offset) {
+      return (_offset + 7) & ~uint64_t(7);
+    }
+
+    // appends an array at the next aligned offset, returns the offset
+    uint64_t appendArray(std::string& _buffer, const void* _data, size_t _size) {
+      uint64_t offset = align(_buffer.size());
+      _buffer.resize(offset);
+      _buffer.append(static_cast<const char*>(_data), _size);
+      return offset;
+    }
+
+    bool inFile(uint64_t _offset, uint64_t _count, uint64_t _item, size_t _size) {
+      return _offset % 4 == 0 && _offset <= _size && _count <= (_size - _offset) / _item;
+    }
+  }
+
+  //-------------------------------------------------------
+
+  GraphBinary::~GraphBinary() {
+    close();
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphBinary::save(const GraphData& _data, const fs::path& _filename) {
+    Header header = {};
+    std::memcpy(header.magic, c_magic, sizeof(c_magic));
+    header.version      = c_version;
+    header.byte_order   = c_byte_order;
+    header.root         = _data.root;
+    header.node_count   = static_cast<uint32_t>(_data.nodes.size());
+    header.port_count   = static_cast<uint32_t>(_data.ports.size());
+    header.edge_count   = static_cast<uint32_t>(_data.edges.size());
+    header.string_count = static_cast<uint32_t>(_data.string_offsets.size() - 1);
+    header.string_size  = static_cast<uint32_t>(_data.string_bytes.size());
+
+    std::string buffer(sizeof(Header), '\0');
+    header.nodes          = appendArray(buffer, _data.nodes.data(), _data.nodes.size() * sizeof(GraphData::Node));
+    header.ports          = appendArray(buffer, _data.ports.data(), _data.ports.size() * sizeof(GraphData::Port));
+    header.edges          = appendArray(buffer, _data.edges.data(), _data.edges.size() * sizeof(GraphData::Edge));
+    header.string_offsets = appendArray(buffer, _data.string_offsets.data(), _data.string_offsets.size() * sizeof(uint32_t));
+    header.string_bytes   = appendArray(buffer, _data.string_bytes.data(), _data.string_bytes.size());
+    header.file_size      = buffer.size();
+    std::memcpy(&buffer[0], &header, sizeof(Header));
+
+    // written aside, synced then renamed, a crash never leaves half a graph
+    if (!GraphJournal::replaceFile(_filename, buffer)) {
+      std::cerr << Console::red << "Cannot write the graph " << _filename << Console::gray << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphBinary::recognize(const fs::path& _filename) {
+    std::ifstream file(_filename, std::ios::binary);
+    char magic[sizeof(c_magic)];
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, c_magic, sizeof(c_magic)) == 0;
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphBinary::map(const fs::path& _filename) {
+#ifdef WIN32
+    HANDLE file = CreateFileW(_filename.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+      mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (!mapping) {
+      CloseHandle(file);
+      return false;
+    }
+    m_data    = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    m_size    = static_cast<size_t>(size.QuadPart);
+    m_file    = file;
+    m_mapping = mapping;
+#else
+    int file = ::open(_filename.c_str(), O_RDONLY);
+    if (file < 0) {
+      return false;
+    }
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+      data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    // the mapping outlives the descriptor
+    ::close(file);
+    if (data == MAP_FAILED) {
+      return false;
+    }
+    m_data = static_cast<const char*>(data);
+    m_size = static_cast<size_t>(info.st_size);
+#endif
+    return m_data != nullptr;
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphBinary::open(const fs::path& _filename) {
+    close();
+    if (!map(_filename)) {
+      std::cerr << Console::red << "Cannot read the graph " << _filename << Console::gray << std::endl;
+      close();
+      return false;
+    }
+
+    Header header;
+    if (m_size < sizeof(Header)) {
+      std::cerr << Console::red << "Corrupted graph " << _filename << Console::gray << std::endl;
+      close();
+      return false;
+    }
+    std::memcpy(&header, m_data, sizeof(Header));
+    if (std::memcmp(header.magic, c_magic, sizeof(c_magic)) != 0 || header.byte_order != c_byte_order) {
+      std::cerr << Console::red << _filename << " is not a binary graph" << Console::gray << std::endl;
+      close();
+      return false;
+    }
+    if (header.version != c_version) {
+      std::cerr << Console::red << _filename << " was saved by another version of Chill (binary graph v"
+                << header.version << ", expected v" << c_version << ")" << Console::gray << std::endl;
+      close();
+      return false;
+    }
+
+    bool sized = header.file_size == m_size && header.string_count < GraphData::c_none
+      && inFile(header.nodes,          header.node_count,       sizeof(GraphData::Node), m_size)
+      && inFile(header.ports,          header.port_count,       sizeof(GraphData::Port), m_size)
+      && inFile(header.edges,          header.edge_count,       sizeof(GraphData::Edge), m_size)
+      && inFile(header.string_offsets, header.string_count + 1, sizeof(uint32_t),       m_size)
+      && inFile(header.string_bytes,   header.string_size,      1,                      m_size);
+    if (!sized) {
+      std::cerr << Console::red << "Corrupted graph " << _filename << Console::gray << std::endl;
+      close();
+      return false;
+    }
+
+    m_view.root           = header.root;
+    m_view.nodes          = reinterpret_cast<const GraphData::Node*>(m_data + header.nodes);
+    m_view.node_count     = header.node_count;
+    m_view.ports          = reinterpret_cast<const GraphData::Port*>(m_data + header.ports);
+    m_view.port_count     = header.port_count;
+    m_view.edges          = reinterpret_cast<const GraphData::Edge*>(m_data + header.edges);
+    m_view.edge_count     = header.edge_count;
+    m_view.string_offsets = reinterpret_cast<const uint32_t*>(m_data + header.string_offsets);
+    m_view.string_count   = header.string_count;
+    m_view.string_bytes   = m_data + header.string_bytes;
+    m_view.string_size    = header.string_size;
+
+    std::string error;
+    if (!m_view.validate(error)) {
+      std::cerr << Console::red << "Corrupted graph " << _filename << ": " << error << Console::gray << std::endl;
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  //-------------------------------------------------------
+
+  void GraphBinary::close() {
+#ifdef WIN32
+    if (m_data) {
+      UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+      CloseHandle(m_mapping);
+    }
+    if (m_file) {
+      CloseHandle(m_file);
+    }
+    m_file    = nullptr;
+    m_mapping = nullptr;
+#else
+    if (m_data) {
+      munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_view = GraphView();
+  }
+}
@@ -0,0 +1,76 @@
+/** @file */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "GraphData.h"
+
+namespace chill {
+
+#ifdef WIN32
+namespace fs = std::experimental::filesystem;
+#else
+namespace fs = std::filesystem;
+#endif
+
+  /**
+   *  GraphBinary class.
+   *  Binary graph files (.graphb): a header followed by the arrays of a
+   *  GraphData, aligned, in the byte order of the machine. Opening a file maps
+   *  it in memory and checks its indices, the arrays are then read in place.
+   *  The Lua .graph files remain the exchange format.
+   **/
+  class GraphBinary
+  {
+  public:
+    static const uint32_t c_version;
+    /** Extension of the binary graph files */
+    static const char*    c_extension;
+
+    GraphBinary() = default;
+    GraphBinary(const GraphBinary&) = delete;
+    GraphBinary& operator=(const GraphBinary&) = delete;
+    ~GraphBinary();
+
+    /**
+     *  Write a graph description to a binary file.
+     *  @param _data The description.
+     *  @param _filename The file, replaced.
+     *  @return false if the file cannot be written.
+     **/
+    static bool save(const GraphData& _data, const fs::path& _filename);
+
+    /**
+     *  Check the first bytes of a file.
+     *  @return true if the file is a binary graph, whatever its extension.
+     **/
+    static bool recognize(const fs::path& _filename);
+
+    /**
+     *  Map a binary graph file.
+     *  @param _filename The file.
+     *  @return false if the file cannot be read, is from another version or is corrupted.
+     **/
+    bool open(const fs::path& _filename);
+
+    void close();
+
+    /** The mapped graph, valid until close() */
+    const GraphView& view() const {
+      return m_view;
+    }
+
+  private:
+    bool map(const fs::path& _filename);
+
+    const char* m_data = nullptr;
+    size_t      m_size = 0;
+#ifdef WIN32
+    void*       m_file    = nullptr;
+    void*       m_mapping = nullptr;
+#endif
+    GraphView   m_view;
+  };
+}
@@ -0,0 +1,233 @@
+#include "GraphData.h"
+
+#include <unordered_set>
+
+#include "GraphLoader.h"
+#include "IOs.h"
+#include "LuaProcessor.h"
+#include "ProcessingGraph.h"
+
+namespace chill {
+
+  namespace {
+    typedef std::unordered_map<ProcessorOutput*, uint32_t> OutputPorts;
+    typedef std::unordered_map<ProcessorInput*, uint32_t>  InputPorts;
+
+    void setColor(GraphData::Node& _node, Color _color) {
+      _node.color[0] = _color.r;
+      _node.color[1] = _color.g;
+      _node.color[2] = _color.b;
+    }
+
+    void captureProcessor(GraphData& _data, Processor& _processor, uint32_t _parent, Vec2 _position,
+                          OutputPorts& _outputs, InputPorts& _inputs) {
+      LuaProcessor*    lua  = dynamic_cast<LuaProcessor*>(&_processor);
+      GraphData::Node& node = _data.addNode(lua ? GraphData::NODE : GraphData::PROCESSOR, _processor.name(), _parent);
+      node.path = lua ? _data.intern(lua->nodepath()) : GraphData::c_none;
+      node.x    = _position.x;
+      node.y    = _position.y;
+      setColor(node, _processor.color());
+
+      for (std::shared_ptr<ProcessorInput> input : _processor.inputs()) {
+        _inputs[input.get()] = static_cast<uint32_t>(_data.ports.size());
+        GraphData::Port& port = _data.addPort(input->name(), static_cast<uint8_t>(input->type()),
+                                              input->m_isDataOnly ? GraphData::DATA_ONLY : 0);
+        std::string text;
+        input->store(port, text);
+        if (!text.empty()) {
+          port.text = _data.intern(text);
+        }
+      }
+      for (std::shared_ptr<ProcessorOutput> output : _processor.outputs()) {
+        _outputs[output.get()] = static_cast<uint32_t>(_data.ports.size());
+        _data.addPort(output->name(), static_cast<uint8_t>(output->type()),
+                      GraphData::OUTPUT | (output->isEmitable() ? GraphData::EMITABLE : 0));
+      }
+    }
+
+    // positions are saved relative to the barycenter of the graph, as ProcessingGraph::save does
+    uint32_t captureGraph(GraphData& _data, ProcessingGraph& _graph, uint32_t _parent, Vec2 _position,
+                          OutputPorts& _outputs, InputPorts& _inputs) {
+      uint32_t         index = static_cast<uint32_t>(_data.nodes.size());
+      GraphData::Node& node  = _data.addNode(GraphData::GRAPH, _graph.name(), _parent);
+      node.x = _position.x;
+      node.y = _position.y;
+      setColor(node, _graph.color());
+
+      Vec2 bar = _graph.getBarycenter();
+      for (std::shared_ptr<Processor> processor : *_graph.processors()) {
+        Vec2 position = processor->getPosition() - bar;
+        ProcessingGraph* inner = dynamic_cast<ProcessingGraph*>(processor.get());
+        if (inner) {
+          captureGraph(_data, *inner, index, position, _outputs, _inputs);
+        } else {
+          captureProcessor(_data, *processor, index, position, _outputs, _inputs);
+        }
+      }
+
+      // every output of the graph is known by now
+      for (std::shared_ptr<Processor> processor : *_graph.processors()) {
+        for (std::shared_ptr<ProcessorInput> input : processor->inputs()) {
+          if (!input->m_link) continue;
+          auto output = _outputs.find(input->m_link.get());
+          if (output != _outputs.end()) {
+            _data.edges.push_back({ output->second, _inputs[input.get()] });
+          }
+        }
+      }
+      return index;
+    }
+  }
+
+  //-------------------------------------------------------
+
+  uint32_t GraphData::intern(std::string_view _text) {
+    auto found = m_strings.emplace(std::string(_text), static_cast<uint32_t>(string_offsets.size() - 1));
+    if (found.second) {
+      string_bytes.append(_text.data(), _text.size());
+      string_offsets.push_back(static_cast<uint32_t>(string_bytes.size()));
+    }
+    return found.first->second;
+  }
+
+  //-------------------------------------------------------
+
+  GraphData::Node& GraphData::addNode(Kind _kind, std::string_view _name, uint32_t _parent) {
+    Node node = {};
+    node.name       = intern(_name);
+    node.path       = c_none;
+    node.parent     = _parent;
+    node.first_port = static_cast<uint32_t>(ports.size());
+    node.kind       = _kind;
+    nodes.push_back(node);
+    return nodes.back();
+  }
+
+  //-------------------------------------------------------
+
+  GraphData::Port& GraphData::addPort(std::string_view _name, uint8_t _type, uint8_t _flags) {
+    Port port = {};
+    port.node  = static_cast<uint32_t>(nodes.size() - 1);
+    port.name  = intern(_name);
+    port.text  = c_none;
+    port.type  = _type;
+    port.flags = _flags;
+    ports.push_back(port);
+    nodes.back().port_count++;
+    return ports.back();
+  }
+
+  //-------------------------------------------------------
+
+  GraphView GraphData::view() const {
+    GraphView view;
+    view.root           = root;
+    view.nodes          = nodes.data();
+    view.node_count     = static_cast<uint32_t>(nodes.size());
+    view.ports          = ports.data();
+    view.port_count     = static_cast<uint32_t>(ports.size());
+    view.edges          = edges.data();
+    view.edge_count     = static_cast<uint32_t>(edges.size());
+    view.string_offsets = string_offsets.data();
+    view.string_count   = static_cast<uint32_t>(string_offsets.size() - 1);
+    view.string_bytes   = string_bytes.data();
+    view.string_size    = static_cast<uint32_t>(string_bytes.size());
+    return view;
+  }
+
+  //-------------------------------------------------------
+
+  GraphData GraphData::capture(ProcessingGraph& _graph) {
+    GraphData   data;
+    OutputPorts outputs;
+    InputPorts  inputs;
+    data.root = captureGraph(data, _graph, c_none, _graph.getPosition(), outputs, inputs);
+    return data;
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphView::validate(std::string& _error) const {
+    auto validString = [this](uint32_t _index) {
+      return _index < string_count || _index == GraphData::c_none;
+    };
+
+    for (uint32_t i = 0; i < string_count; ++i) {
+      if (string_offsets[i] > string_offsets[i + 1]) {
+        _error = "bad string table";
+        return false;
+      }
+    }
+    if (string_count > 0 && string_offsets[string_count] > string_size) {
+      _error = "bad string table";
+      return false;
+    }
+
+    if (root >= node_count || nodes[root].kind != GraphData::GRAPH || nodes[root].parent != GraphData::c_none) {
+      _error = "no main graph";
+      return false;
+    }
+
+    for (uint32_t n = 0; n < node_count; ++n) {
+      const GraphData::Node& node = nodes[n];
+      if (node.kind > GraphData::GRAPH || !validString(node.name) || !validString(node.path)) {
+        _error = "bad node " + std::to_string(n);
+        return false;
+      }
+      // parents first, and only graphs hold nodes
+      if (node.parent != GraphData::c_none && (node.parent >= n || nodes[node.parent].kind != GraphData::GRAPH)) {
+        _error = "bad parent of node " + std::to_string(n);
+        return false;
+      }
+      if (node.first_port > port_count || node.port_count > port_count - node.first_port) {
+        _error = "bad ports of node " + std::to_string(n);
+        return false;
+      }
+      for (uint32_t p = node.first_port; p < node.first_port + node.port_count; ++p) {
+        if (ports[p].node != n) {
+          _error = "bad ports of node " + std::to_string(n);
+          return false;
+        }
+      }
+    }
+
+    for (uint32_t p = 0; p < port_count; ++p) {
+      const GraphData::Port& port = ports[p];
+      if (port.node >= node_count || port.type >= IOType::COUNT || !validString(port.name) || !validString(port.text)) {
+        _error = "bad port " + std::to_string(p);
+        return false;
+      }
+    }
+
+    for (uint32_t e = 0; e < edge_count; ++e) {
+      const GraphData::Edge& edge = edges[e];
+      if (edge.output >= port_count || edge.input >= port_count
+        || !(ports[edge.output].flags & GraphData::OUTPUT) || (ports[edge.input].flags & GraphData::OUTPUT)) {
+        _error = "bad edge " + std::to_string(e);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  //-------------------------------------------------------
+
+  std::vector<std::string> GraphView::nodepaths() const {
+    std::vector<std::string> paths;
+    std::unordered_set<std::string_view> seen;
+    for (uint32_t n = 0; n < node_count; ++n) {
+      if (nodes[n].kind == GraphData::NODE && seen.insert(string(nodes[n].path)).second) {
+        paths.emplace_back(string(nodes[n].path));
+      }
+    }
+    return paths;
+  }
+
+  //-------------------------------------------------------
+
+  std::shared_ptr<ProcessingGraph> GraphView::instantiate() const {
+    GraphLoader loader(*this);
+    loader.finish();
+    return loader.graph();
+  }
+}
@@ -0,0 +1,167 @@
+/** @file */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace chill {
+
+  class ProcessingGraph;
+  class GraphView;
+
+  /**
+   *  GraphData class.
+   *  Flat description of a saved graph: a string table and arrays of nodes,
+   *  ports (inputs and outputs) and edges, referring to each other by index.
+   *  The records are plain data so that the binary graph files can be mapped
+   *  in memory and read in place, see GraphBinary.
+   *  Nodes are stored parents first, the ports of a node are contiguous.
+   **/
+  class GraphData
+  {
+  public:
+    /** No node, no string */
+    static const uint32_t c_none = 0xFFFFFFFFu;
+
+    enum Kind : uint8_t {
+      PROCESSOR, // plain Processor, as the group inputs and outputs
+      NODE,      // LuaProcessor, loaded from its node file
+      GRAPH      // ProcessingGraph, holding other nodes
+    };
+
+    enum PortFlags : uint8_t {
+      OUTPUT    = 1 << 0,
+      EMITABLE  = 1 << 1, // outputs only
+      DATA_ONLY = 1 << 2, // inputs only
+      ALT       = 1 << 3
+    };
+
+    struct Node {
+      uint32_t name;
+      uint32_t path;        // node file of a NODE, relative to the nodes folder
+      uint32_t parent;      // graph holding the node, c_none for the main graph
+      uint32_t first_port;
+      uint32_t port_count;
+      float    x, y;        // relative to the barycenter of the parent graph
+      uint8_t  kind;
+      uint8_t  color[3];
+    };
+
+    /** An input or an output, with the tweak value of the inputs */
+    struct Port {
+      uint32_t node;
+      uint32_t name;
+      uint32_t text;        // value of the PATH and STRING inputs
+      uint8_t  type;        // IOType::IOType
+      uint8_t  flags;       // PortFlags
+      uint8_t  padding[2];
+      int32_t  integer[4];  // value, min, max, step of the BOOLEAN, INTEGER and LIST inputs
+      float    real[7];     // value[4], min, max, step of the REAL and VEC inputs
+    };
+
+    struct Edge {
+      uint32_t output;      // port index
+      uint32_t input;       // port index
+    };
+
+    static_assert(std::is_trivially_copyable<Node>::value && sizeof(Node) == 32, "GraphData::Node layout");
+    static_assert(std::is_trivially_copyable<Port>::value && sizeof(Port) == 60, "GraphData::Port layout");
+    static_assert(std::is_trivially_copyable<Edge>::value && sizeof(Edge) == 8,  "GraphData::Edge layout");
+
+    //-------------------------------------------------------
+
+    /** Index of the main graph in nodes */
+    uint32_t root = c_none;
+
+    std::vector<Node> nodes;
+    std::vector<Port> ports;
+    std::vector<Edge> edges;
+
+    /** String i is string_bytes[string_offsets[i], string_offsets[i + 1]) */
+    std::vector<uint32_t> string_offsets = { 0 };
+    std::string           string_bytes;
+
+    //-------------------------------------------------------
+
+    /**
+     *  Add a string to the table, once.
+     *  @param _text The string.
+     *  @return Its index.
+     **/
+    uint32_t intern(std::string_view _text);
+
+    /** A node with no port, its ports have to be added right after */
+    Node& addNode(Kind _kind, std::string_view _name, uint32_t _parent);
+
+    /** A port of the last node added */
+    Port& addPort(std::string_view _name, uint8_t _type, uint8_t _flags);
+
+    GraphView view() const;
+
+    /**
+     *  Describe a graph and all the graphs it holds.
+     *  @param _graph The main graph.
+     *  @return The description.
+     **/
+    static GraphData capture(ProcessingGraph& _graph);
+
+  private:
+    std::unordered_map<std::string, uint32_t> m_strings;
+  };
+
+  //-------------------------------------------------------
+
+  /**
+   *  GraphView class.
+   *  Read-only access to a graph description, owned by a GraphData or mapped
+   *  from a binary graph file.
+   **/
+  class GraphView
+  {
+  public:
+    uint32_t               root           = GraphData::c_none;
+    const GraphData::Node* nodes          = nullptr;
+    uint32_t               node_count     = 0;
+    const GraphData::Port* ports          = nullptr;
+    uint32_t               port_count     = 0;
+    const GraphData::Edge* edges          = nullptr;
+    uint32_t               edge_count     = 0;
+    const uint32_t*        string_offsets = nullptr;  // string_count + 1 offsets
+    uint32_t               string_count   = 0;
+    const char*            string_bytes   = nullptr;
+    uint32_t               string_size    = 0;
+
+    std::string_view string(uint32_t _index) const {
+      if (_index >= string_count) {
+        return std::string_view();
+      }
+      return std::string_view(string_bytes + string_offsets[_index], string_offsets[_index + 1] - string_offsets[_index]);
+    }
+
+    /**
+     *  Check that every index is in range, so that a corrupted file cannot
+     *  make instantiate() read out of the arrays.
+     *  @param _error What is wrong, if anything.
+     *  @return true if the view is consistent.
+     **/
+    bool validate(std::string& _error) const;
+
+    /**
+     *  List the node files the graph uses, each one once.
+     *  @return The distinct node paths, in order of first use.
+     **/
+    std::vector<std::string> nodepaths() const;
+
+    /**
+     *  Create the processors, their inputs and outputs and the links, all at
+     *  once. See GraphLoader to create them a few at a time.
+     *  @return The main graph, nullptr if the view has none.
+     **/
+    std::shared_ptr<ProcessingGraph> instantiate() const;
+  };
+}
@@ -0,0 +1,618 @@
+#include "GraphExporter.h"
+
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <unordered_set>
+
+#include <LibSL/LibSL.h>
+
+#include "IOs.h"
+#include "LuaProcessor.h"
+#include "NodeLibrary.h"
+#include "OutputSlots.h"
+#include "ProcessingGraph.h"
+#include "ScalarEvaluator.h"
+
+namespace chill {
+
+  struct GraphExporter::Context {
+    const ScalarEvaluator*                   folding = nullptr;
+    bool                                     deduplicate = false;
+    std::unordered_map<Processor*, uint64_t> hashes;
+    std::unordered_map<uint64_t, Processor*> first;
+    bool                                     memo = false;
+    bool                                     keeps_state = false;
+    std::unordered_map<Processor*, uint64_t> keys;
+    OutputSlots*                             slots = nullptr;
+    ExportOptions::UiTweaks                  ui_tweaks = ExportOptions::UI_NONE;
+    std::unordered_map<Processor*, bool>     ui_dependent;
+    std::unordered_map<Processor*, int>      tweak_numbers;
+    OutputSlots                              own_slots;
+    ExportStats                              stats;
+  };
+
+  thread_local GraphExporter::Context* GraphExporter::s_current = nullptr;
+
+  namespace {
+    uint64_t fnv(const std::string& _text, uint64_t _hash = 14695981039346656037ull) {
+      for (unsigned char c : _text) {
+        _hash = (_hash ^ c) * 1099511628211ull;
+      }
+      return _hash;
+    }
+
+    uint64_t combine(uint64_t _hash, uint64_t _value) {
+      return (_hash ^ (_value + 0x9E3779B97F4A7C15ull + (_hash << 6) + (_hash >> 2))) * 1099511628211ull;
+    }
+
+    size_t countNodes(ProcessingGraph& _graph) {
+      size_t count = 0;
+      for (std::shared_ptr<Processor> processor : *_graph.processors()) {
+        ProcessingGraph* inner = dynamic_cast<ProcessingGraph*>(processor.get());
+        count += 1 + (inner ? countNodes(*inner) : 0);
+      }
+      return count;
+    }
+
+    /** Number the nodes whose name repeats, in graph order, so that their IceSL tweaks differ */
+    void numberNames(ProcessingGraph& _graph, std::unordered_map<std::string, std::vector<Processor*>>& _names) {
+      for (std::shared_ptr<Processor> processor : *_graph.processors()) {
+        _names[processor->name()].push_back(processor.get());
+        ProcessingGraph* inner = dynamic_cast<ProcessingGraph*>(processor.get());
+        if (inner) {
+          numberNames(*inner, _names);
+        }
+      }
+    }
+
+    /** The slots of the outputs of a graph, numbered at export */
+    uint64_t layoutOf(ProcessingGraph& _graph, const OutputSlots& _slots, uint64_t _hash = 14695981039346656037ull) {
+      for (std::shared_ptr<ProcessorOutput> output : _graph.outputs()) {
+        _hash = combine(combine(_hash, static_cast<uint64_t>(output->getUniqueID())), static_cast<uint64_t>(_slots.slot(*output)));
+      }
+      for (std::shared_ptr<Processor> processor : *_graph.processors()) {
+        ProcessingGraph* inner = dynamic_cast<ProcessingGraph*>(processor.get());
+        if (inner) {
+          _hash = layoutOf(*inner, _slots, _hash);
+          continue;
+        }
+        for (std::shared_ptr<ProcessorOutput> output : processor->outputs()) {
+          _hash = combine(combine(_hash, static_cast<uint64_t>(output->getUniqueID())), static_cast<uint64_t>(_slots.slot(*output)));
+        }
+      }
+      return _hash;
+    }
+
+    uint64_t hashOf(Processor& _processor, std::unordered_map<Processor*, uint64_t>& _hashes, const ExportOptions& _options) {
+      auto known = _hashes.find(&_processor);
+      if (known != _hashes.end()) {
+        return known->second;
+      }
+      LuaProcessor* node = dynamic_cast<LuaProcessor*>(&_processor);
+      // shared by nothing else, also breaks the cycles
+      uint64_t hash = combine(fnv("unique"), static_cast<uint64_t>(_processor.getUniqueID()));
+      _hashes[&_processor] = hash;
+      if (!node || node->isEmiter() || node->getState() == DISABLED) {
+        return hash;
+      }
+
+      hash = fnv(node->nodepath());
+      for (std::shared_ptr<ProcessorInput> input : node->inputs()) {
+        hash = fnv(input->name(), combine(hash, 1));
+        if (input->m_link) {
+          hash = combine(hash, hashOf(*input->m_link->owner(), _hashes, _options));
+          hash = fnv(input->m_link->name(), hash);
+        } else if (GraphExporter::isUiTweak(*input, _options)) {
+          // each node has its own tweak in IceSL
+          hash = combine(combine(hash, 2), static_cast<uint64_t>(_processor.getUniqueID()));
+        } else {
+          hash = fnv(input->getLuaValue(), hash);
+        }
+      }
+      _hashes[&_processor] = hash;
+      return hash;
+    }
+  }
+
+  //-------------------------------------------------------
+
+  ExportStats GraphExporter::write(ProcessingGraph& _graph, LuaWriter& _writer, const ExportOptions& _options) {
+    // TODO: CLEAN THIS !!!
+
+    _writer <<
+      "enable_variable_cache = " << (_options.keepsState() ? "true" : "false") << "\n"
+      "\n"
+      "local _G0 = {}       --swap environnement(swap variables between scripts)\n"
+      "local _Gcurrent = {} --environment local to the script : _Gc includes _G0\n"
+      "local __dirty = {}   --table of all dirty nodes\n"
+      "__input = {}         --table of all input values\n"
+      "\n"
+      "setmetatable(_G0, { __index = _G })\n"
+      "\n"
+      "function setNodeId(id)\n"
+      "  setfenv(1, _G0)\n"
+      "  __currentNodeId = id\n"
+      "  setfenv(1, _Gcurrent)\n"
+      "end\n"
+      "\n"
+      "function setColor(...) end\n"
+      "\n";
+
+    Context context;
+    if (_options.slots) {
+      context.slots = _options.output_slots ? _options.output_slots : &context.own_slots;
+      context.slots->assign(_graph);
+      // the outputs IceSL kept are of another numbering: all the nodes run again
+      uint64_t epoch = _options.output_slots ? _options.output_slots->epoch() : layoutOf(_graph, *context.slots);
+      char text[17];
+      std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(epoch));
+      _writer <<
+        "if __slots_epoch ~= '" << text << "' then\n"
+        "  __slots = {}\n"
+        "  __slots_epoch = '" << text << "'\n"
+        "  first_exec = nil\n"
+        "end\n"
+        "local __slots = __slots  --outputs by slot, kept between the runs\n"
+        "local __value = {}       --input values of the current node by name\n"
+        "local __id = {}          --input nodes of the current node by name\n"
+        "local __outslot = {}     --output slots of the current node by name\n"
+        "setmetatable(_Gcurrent, { __index = _G0 })\n"
+        "\n"
+        "function clearEnv()\n"
+        "  for key in pairs(_Gcurrent) do\n"
+        "    _Gcurrent[key] = nil\n"
+        "  end\n"
+        "  for key in pairs(__outslot) do\n"
+        "    __outslot[key] = nil\n"
+        "  end\n"
+        "end\n"
+        "\n"
+        "function data(name, type, ...)\n"
+        "  return __value[name]\n"
+        "end\n"
+        "\n"
+        "function input(name, type, ...)\n"
+        "  return __value[name]\n"
+        "end\n"
+        "\n"
+        "function getNodeId(name)\n"
+        "  return __id[name]\n"
+        "end\n"
+        "function output(name, type, val)\n"
+        "  local slot = __outslot[name]\n"
+        "  if slot and (first_exec or __dirty[_G0.__currentNodeId]) then\n"
+        "    __slots[slot] = val\n"
+        "  end\n"
+        "end\n"
+        "\n";
+    } else {
+      _writer <<
+        "function data(name, type, ...)\n"
+        "  return __input[name][1]\n"
+        "end\n"
+        "\n"
+        "function input(name, type, ...)\n"
+        "  return __input[name][1]\n"
+        "end\n"
+        "\n"
+        "function getNodeId(name)\n"
+        "  return __input[name][2]\n"
+        "end\n"
+        "function output(name, type, val)\n"
+        "  setfenv(1, _G0)\n"
+        "  if (isDirty({ __currentNodeId })) then\n"
+        "    _G[name..__currentNodeId] = val\n"
+        "  end\n"
+        "  setfenv(1, _Gcurrent)\n"
+        "end\n"
+        "\n";
+    }
+
+    _writer <<
+      "function setDirty(node)\n"
+      "  __dirty[node] = true\n"
+      "end\n"
+      "\n"
+      "function isDirty(nodes)\n"
+      "  if first_exec then\n"
+      "    return true\n"
+      "  end\n"
+      "    \n"
+      "  if #nodes == 0 then\n"
+      "    return false\n"
+      "  else\n"
+      "    local node = table.remove(nodes, 1)\n"
+      "    if node == NIL then node = nil end\n"
+      "    return __dirty[node] or isDirty(nodes)\n"
+      "  end\n"
+      "end\n"
+      "\n"
+      "if first_exec == nil then\n"
+      "  first_exec = true\n"
+      "else\n"
+      "  first_exec = false\n"
+      "end\n"
+      "\n"
+      "emit(Void)\n";
+
+    if (_options.keepsState()) {
+      // the outputs of the previous run are kept: only the nodes that changed run again
+      _writer <<
+        "\n"
+        "__versions = __versions or {}\n"
+        "\n"
+        "function changed(node, version)\n"
+        "  if __versions[node] ~= version then\n"
+        "    __versions[node] = version\n"
+        "    setDirty(node)\n"
+        "  end\n"
+        "end\n";
+    }
+
+    if (_options.memo_entries > 0) {
+      // kept between the runs of the script, the least recently used outputs go first
+      _writer <<
+        "\n"
+        "__memo = __memo or { size = 0, tick = 0, entries = {} }\n"
+        "__memo.limit = " << _options.memo_entries << "\n"
+        "\n"
+        "function memoRestore(key, " << (context.slots ? "slots" : "id, names") << ")\n"
+        "  local entry = __memo.entries[key]\n"
+        "  if entry == nil then\n"
+        "    return false\n"
+        "  end\n"
+        "  __memo.tick = __memo.tick + 1\n"
+        "  entry.used = __memo.tick\n"
+        << (context.slots ?
+        "  for i, slot in ipairs(slots) do\n"
+        "    __slots[slot] = entry.values[i]\n"
+        "  end\n"
+        :
+        "  for i, name in ipairs(names) do\n"
+        "    _G[name..id] = entry.values[i]\n"
+        "  end\n") <<
+        "  return true\n"
+        "end\n"
+        "\n"
+        "function memoStore(key, " << (context.slots ? "slots" : "id, names") << ")\n"
+        "  local values = {}\n"
+        << (context.slots ?
+        "  for i, slot in ipairs(slots) do\n"
+        "    values[i] = __slots[slot]\n"
+        "  end\n"
+        :
+        "  for i, name in ipairs(names) do\n"
+        "    values[i] = _G[name..id]\n"
+        "  end\n") <<
+        "  if __memo.entries[key] == nil then\n"
+        "    __memo.size = __memo.size + 1\n"
+        "  end\n"
+        "  __memo.tick = __memo.tick + 1\n"
+        "  __memo.entries[key] = { values = values, used = __memo.tick }\n"
+        "  while __memo.size > __memo.limit do\n"
+        "    local oldest, used = nil, math.huge\n"
+        "    for k, entry in pairs(__memo.entries) do\n"
+        "      if entry.used < used then\n"
+        "        oldest, used = k, entry.used\n"
+        "      end\n"
+        "    end\n"
+        "    __memo.entries[oldest] = nil\n"
+        "    __memo.size = __memo.size - 1\n"
+        "  end\n"
+        "end\n";
+    }
+    if (_options.ui_tweaks != ExportOptions::UI_NONE) {
+      // a tweak moved in IceSL makes its node dirty
+      _writer <<
+        "\n"
+        "__tweaks = __tweaks or {}\n"
+        "\n"
+        "function uiTweak(label, value)\n"
+        "  local key = _G0.__currentNodeId .. '/' .. label\n"
+        "  if __tweaks[key] ~= value then\n"
+        "    __tweaks[key] = value\n"
+        "    setDirty(_G0.__currentNodeId)\n"
+        "  end\n"
+        "  return value\n"
+        "end\n";
+    }
+    _writer << "------------------------------------------------------\n";
+
+    context.stats.nodes = countNodes(_graph);
+    ScalarEvaluator evaluator;
+    if (_options.fold_constants) {
+      if (_options.evaluator) {
+        context.folding = _options.evaluator;
+      } else {
+        evaluator.update(_graph);
+        context.folding = &evaluator;
+      }
+    }
+    if (_options.deduplicate) {
+      context.deduplicate = true;
+      hash(_graph, context.hashes, _options);
+      std::unordered_set<uint64_t> distinct;
+      for (const auto& hashed : context.hashes) {
+        distinct.insert(hashed.second);
+      }
+      context.stats.distinct = distinct.size();
+    }
+
+    context.memo        = _options.memo_entries > 0;
+    context.keeps_state = _options.keepsState();
+    context.ui_tweaks   = _options.ui_tweaks;
+    if (_options.ui_tweaks != ExportOptions::UI_NONE) {
+      std::unordered_map<std::string, std::vector<Processor*>> names;
+      numberNames(_graph, names);
+      for (const auto& name : names) {
+        for (size_t i = 0; name.second.size() > 1 && i < name.second.size(); i++) {
+          context.tweak_numbers[name.second[i]] = static_cast<int>(i + 1);
+        }
+      }
+    }
+
+    Context* previous = s_current;
+    s_current = &context;
+    _graph.iceSL(_writer);
+    s_current = previous;
+    return context.stats;
+  }
+
+  //-------------------------------------------------------
+
+  const NodeSandbox::Values* GraphExporter::constants(Processor& _processor) {
+    if (!s_current || !s_current->folding) {
+      return nullptr;
+    }
+    // IceSL may change the values it was computed from
+    if (dependsOnUi(_processor)) {
+      return nullptr;
+    }
+    const NodeSandbox::Values* values = s_current->folding->constants(_processor);
+    if (values) {
+      s_current->stats.folded++;
+    }
+    return values;
+  }
+
+  //-------------------------------------------------------
+
+  Processor* GraphExporter::duplicateOf(Processor& _processor) {
+    if (!s_current || !s_current->deduplicate) {
+      return nullptr;
+    }
+    auto hashed = s_current->hashes.find(&_processor);
+    if (hashed == s_current->hashes.end()) {
+      return nullptr;
+    }
+    auto first = s_current->first.emplace(hashed->second, &_processor);
+    if (first.second || first.first->second == &_processor) {
+      return nullptr;
+    }
+    s_current->stats.deduplicated++;
+    if (s_current->memo) {
+      // computes the same outputs
+      auto key = s_current->keys.find(first.first->second);
+      if (key != s_current->keys.end()) {
+        s_current->keys[&_processor] = key->second;
+      }
+    }
+    return first.first->second;
+  }
+
+  //-------------------------------------------------------
+
+  int GraphExporter::slot(ProcessorOutput& _output) {
+    return hasSlots() ? s_current->slots->slot(_output) : 0;
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphExporter::hasSlots() {
+    return s_current && s_current->slots;
+  }
+
+  //-------------------------------------------------------
+
+  void GraphExporter::writeEnvironment(LuaWriter& _writer) {
+    if (hasSlots()) {
+      _writer << "clearEnv()\nsetfenv(1, _Gcurrent)\n";
+      return;
+    }
+    _writer <<
+      "_Gcurrent = {} -- clear _Gcurrent\n"
+      "setmetatable(_Gcurrent, { __index = _G0 }) --copy index from _G0\n"
+      "setfenv(1, _Gcurrent)    --set it\n";
+  }
+
+  //-------------------------------------------------------
+
+  std::string GraphExporter::contentKey(Processor& _processor, const std::string& _code) {
+    if (!s_current || !s_current->memo || dependsOnUi(_processor)) {
+      return std::string();
+    }
+    // a disabled node outputs Void
+    uint64_t key = combine(fnv(_code), static_cast<uint64_t>(_processor.getState()));
+    for (std::shared_ptr<ProcessorInput> input : _processor.inputs()) {
+      key = fnv(input->name(), combine(key, 1));
+      if (input->m_link) {
+        auto upstream = s_current->keys.find(input->m_link->owner());
+        if (upstream == s_current->keys.end()) {
+          return std::string();
+        }
+        key = fnv(input->m_link->name(), combine(key, upstream->second));
+      } else {
+        key = fnv(input->getLuaValue(), key);
+      }
+    }
+    s_current->keys[&_processor] = key;
+    s_current->stats.memoized++;
+
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(key));
+    return text;
+  }
+
+  //-------------------------------------------------------
+
+  void GraphExporter::writeChanges(LuaWriter& _writer, Processor& _processor, const std::string& _code, Processor* _group) {
+    if (!s_current || !s_current->keeps_state) {
+      return;
+    }
+    ExportOptions options;
+    options.ui_tweaks = s_current->ui_tweaks;
+    // the tweaks set in IceSL make their node dirty themselves, see uiTweak
+    uint64_t version = combine(fnv(_code), static_cast<uint64_t>(_processor.getState()));
+    for (Processor* processor : { &_processor, _group }) {
+      if (!processor) {
+        continue;
+      }
+      for (std::shared_ptr<ProcessorInput> input : processor->inputs()) {
+        version = fnv(input->name(), combine(version, 1));
+        if (input->m_link) {
+          version = combine(version, static_cast<uint64_t>(input->m_link->owner()->getUniqueID()));
+          version = fnv(input->m_link->name(), version);
+        } else if (!isUiTweak(*input, options)) {
+          version = fnv(input->getLuaValue(), version);
+        }
+      }
+    }
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(version));
+    _writer << "changed(__currentNodeId, '" << text << "')\n";
+  }
+
+  //-------------------------------------------------------
+
+  void GraphExporter::writeTweak(LuaWriter& _writer, ProcessorInput& _input) {
+    ExportOptions options;
+    options.ui_tweaks = s_current ? s_current->ui_tweaks : ExportOptions::UI_NONE;
+    if (!isUiTweak(_input, options)) {
+      _input.luaValue(_writer);
+      return;
+    }
+    std::string label = tweakLabel(_input);
+    _writer << "uiTweak(";
+    _writer.quoted(label) << ", ";
+    _input.uiTweak(_writer, label);
+    _writer << ")";
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphExporter::isUiTweak(ProcessorInput& _input, const ExportOptions& _options) {
+    if (_options.ui_tweaks == ExportOptions::UI_NONE || _input.m_link || !_input.hasUiTweak()) {
+      return false;
+    }
+    return _options.ui_tweaks == ExportOptions::UI_ALL || (_input.owner() && _input.owner()->m_selected);
+  }
+
+  //-------------------------------------------------------
+
+  std::string GraphExporter::tweakLabel(ProcessorInput& _input) {
+    if (!_input.owner()) {
+      return _input.name();
+    }
+    std::string node = _input.owner()->name();
+    if (s_current) {
+      auto number = s_current->tweak_numbers.find(_input.owner());
+      if (number != s_current->tweak_numbers.end()) {
+        node += " (" + std::to_string(number->second) + ")";
+      }
+    }
+    return node + "/" + _input.name();
+  }
+
+  //-------------------------------------------------------
+
+  uint64_t GraphExporter::structure(ProcessingGraph& _graph, const ExportOptions& _options) {
+    uint64_t hash = combine(fnv(_graph.name()), static_cast<uint64_t>(_options.ui_tweaks));
+    // the files of the nodes, read once
+    std::unordered_map<std::string, uint64_t> files;
+    std::function<void(ProcessingGraph&)> visit = [&](ProcessingGraph& _inner) {
+      for (std::shared_ptr<Processor> processor : *_inner.processors()) {
+        hash = fnv(processor->name(), combine(hash, static_cast<uint64_t>(processor->getUniqueID())));
+        hash = combine(hash, static_cast<uint64_t>(processor->getState()));
+        LuaProcessor* node = dynamic_cast<LuaProcessor*>(processor.get());
+        if (node) {
+          auto file = files.find(node->nodepath());
+          if (file == files.end()) {
+            file = files.emplace(node->nodepath(), fnv(*NodeLibrary::Instance().source(node->nodepath()))).first;
+          }
+          hash = combine(hash, file->second);
+        }
+        for (std::shared_ptr<ProcessorInput> input : processor->inputs()) {
+          hash = fnv(input->name(), combine(hash, 1));
+          if (input->m_link) {
+            hash = combine(hash, static_cast<uint64_t>(input->m_link->owner()->getUniqueID()));
+            hash = fnv(input->m_link->name(), hash);
+          } else if (isUiTweak(*input, _options)) {
+            // the label follows from the names and ids hashed above
+            hash = combine(hash, 2);
+          } else {
+            hash = fnv(input->getLuaValue(), hash);
+          }
+        }
+        for (std::shared_ptr<ProcessorOutput> output : processor->outputs()) {
+          hash = fnv(output->name(), combine(hash, 3));
+        }
+        ProcessingGraph* group = dynamic_cast<ProcessingGraph*>(processor.get());
+        if (group) {
+          visit(*group);
+        }
+      }
+    };
+    visit(_graph);
+    return hash;
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphExporter::dependsOnUi(Processor& _processor) {
+    if (!s_current || s_current->ui_tweaks == ExportOptions::UI_NONE) {
+      return false;
+    }
+    auto known = s_current->ui_dependent.find(&_processor);
+    if (known != s_current->ui_dependent.end()) {
+      return known->second;
+    }
+    // also breaks the cycles
+    s_current->ui_dependent[&_processor] = false;
+    ExportOptions options;
+    options.ui_tweaks = s_current->ui_tweaks;
+    bool depends = false;
+    for (std::shared_ptr<ProcessorInput> input : _processor.inputs()) {
+      if (input->m_link ? dependsOnUi(*input->m_link->owner()) : isUiTweak(*input, options)) {
+        depends = true;
+        break;
+      }
+    }
+    s_current->ui_dependent[&_processor] = depends;
+    return depends;
+  }
+
+  //-------------------------------------------------------
+
+  void GraphExporter::hash(ProcessingGraph& _graph, std::unordered_map<Processor*, uint64_t>& _hashes, const ExportOptions& _options) {
+    for (std::shared_ptr<Processor> processor : *_graph.processors()) {
+      ProcessingGraph* inner = dynamic_cast<ProcessingGraph*>(processor.get());
+      if (inner) {
+        hash(*inner, _hashes, _options);
+      }
+      hashOf(*processor, _hashes, _options);
+    }
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphExporter::save(ProcessingGraph& _graph, const fs::path& _filename, const ExportOptions& _options) {
+    LuaWriter writer;
+    write(_graph, writer, _options);
+    if (!writer.save(_filename)) {
+      std::cerr << Console::red << "Cannot write " << _filename.string() << Console::gray << std::endl;
+      return false;
+    }
+    return true;
+  }
+}
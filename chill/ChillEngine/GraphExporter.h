@@ -0,0 +1,212 @@
+/** @file */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+#include "LuaWriter.h"
+#include "NodeSandbox.h"
+
+namespace chill {
+
+#ifdef WIN32
+namespace fs = std::experimental::filesystem;
+#else
+namespace fs = std::filesystem;
+#endif
+
+  class OutputSlots;
+  class Processor;
+  class ProcessingGraph;
+  class ProcessorInput;
+  class ProcessorOutput;
+  class ScalarEvaluator;
+
+  /** How the script of a graph is written */
+  struct ExportOptions {
+    /** Write the values of the nodes that only compute constants instead of their code, see ScalarEvaluator::constants */
+    bool             fold_constants = false;
+    /** Evaluator already updated on the graph, to reuse its values; nullptr to evaluate the graph at export */
+    ScalarEvaluator* evaluator      = nullptr;
+    /** Write the code of identical nodes once, the others take its outputs, see GraphExporter::hash */
+    bool             deduplicate    = false;
+    /**
+     *  Outputs IceSL keeps between the runs of the script, under a key computed from the
+     *  code and the input values of the node: a node whose key was seen recently takes the
+     *  outputs back instead of running, see GraphExporter::contentKey. 0 to keep none.
+     **/
+    size_t           memo_entries   = 0;
+    /**
+     *  Pass the values through one array holding the outputs, indexed by slot, instead of
+     *  globals named after the nodes and tables built for each node; the environment of
+     *  the nodes is one table, cleared between them.
+     **/
+    bool             slots          = false;
+    /** Slots kept from the previous exports, see OutputSlots; nullptr to number the outputs at export */
+    OutputSlots*     output_slots   = nullptr;
+
+    /** The tweaks set in IceSL, see ProcessorInput::uiTweak */
+    enum UiTweaks {
+      UI_NONE,     // the values are written in the script
+      UI_SELECTED, // the tweaks of the selected nodes
+      UI_ALL       // all the tweaks that have an IceSL tweak
+    };
+    /**
+     *  Unlinked tweaks written as IceSL tweaks, set in IceSL without an export: the script
+     *  only changes with the structure of the graph, see GraphExporter::structure.
+     **/
+    UiTweaks         ui_tweaks      = UI_NONE;
+
+    /**
+     *  Whether IceSL keeps the globals of the script between its runs (its variable cache),
+     *  which the memo, the slots and the tweaks set in IceSL rely on. A node then only runs
+     *  again once dirty, see GraphExporter::writeChanges.
+     **/
+    bool keepsState() const {
+      return memo_entries > 0 || slots || ui_tweaks != UI_NONE;
+    }
+  };
+
+  /** What an export did */
+  struct ExportStats {
+    /** Nodes of the graph and of the graphs it contains */
+    size_t nodes        = 0;
+    /** Nodes written as their values */
+    size_t folded       = 0;
+    /** Nodes taking the outputs of an identical node written before */
+    size_t deduplicated = 0;
+    /** Different hashes among the nodes, when deduplicating */
+    size_t distinct     = 0;
+    /** Nodes whose outputs IceSL may take from its memo */
+    size_t memoized     = 0;
+  };
+
+  /**
+   *  GraphExporter class.
+   *  Writes the IceSL script of a graph: a prelude that tracks the dirty nodes
+   *  and passes the values between them, then the code of each node, see
+   *  Processor::iceSL. Needs no window, used by the editor and the tools alike.
+   **/
+  class GraphExporter
+  {
+  public:
+    /**
+     *  Write the script of a graph.
+     *  @param _graph The main graph.
+     *  @param _writer Where to write the script.
+     *  @param _options How to write it.
+     *  @return What the export did.
+     **/
+    static ExportStats write(ProcessingGraph& _graph, LuaWriter& _writer, const ExportOptions& _options = ExportOptions());
+
+    /**
+     *  Write the script of a graph to a file.
+     *  @param _graph The main graph.
+     *  @param _filename The .lua file.
+     *  @param _options How to write it.
+     *  @return false if the file cannot be written.
+     **/
+    static bool save(ProcessingGraph& _graph, const fs::path& _filename, const ExportOptions& _options = ExportOptions());
+
+    /**
+     *  Get the values a node is replaced with in the script being written, for Processor::iceSL.
+     *  @param _processor The node.
+     *  @return Its outputs as Lua expressions, nullptr if its code is written.
+     **/
+    static const NodeSandbox::Values* constants(Processor& _processor);
+
+    /**
+     *  Get the node written before with the same hash in the script being written, for Processor::iceSL.
+     *  The first node of a hash is remembered, the next ones get it.
+     *  @param _processor The node.
+     *  @return The node whose outputs it takes, nullptr if its code is written.
+     **/
+    static Processor* duplicateOf(Processor& _processor);
+
+    /**
+     *  Get the content key of a node in the script being written, for Processor::iceSL.
+     *  The key covers the code written for the node and the values of its tweaks or the
+     *  keys of the nodes it is linked to, written before: equal keys, equal outputs.
+     *  @param _processor The node.
+     *  @param _code The code written for it.
+     *  @return The key, empty if the outputs are not memoized or a linked node has no key.
+     **/
+    static std::string contentKey(Processor& _processor, const std::string& _code);
+
+    /**
+     *  Write the check that makes a node dirty when it changed since the last run of the
+     *  script, for Processor::iceSL: its code, its state, the values of its tweaks and its
+     *  links. Only when IceSL keeps the globals, see ExportOptions::keepsState.
+     *  @param _processor The node.
+     *  @param _code The code written for it.
+     *  @param _group The group whose tweaks and links the node also reads, for group inputs and outputs.
+     **/
+    static void writeChanges(LuaWriter& _writer, Processor& _processor, const std::string& _code, Processor* _group = nullptr);
+
+    /**
+     *  Get the slot of an output in the script being written, for Processor::iceSL.
+     *  @param _output The output.
+     *  @return The slot, 0 if the script is not written with slots.
+     **/
+    static int slot(ProcessorOutput& _output);
+
+    /** Whether the script being written passes the values through slots, for Processor::iceSL */
+    static bool hasSlots();
+
+    /**
+     *  Write the switch to the environment of a node, for Processor::iceSL.
+     *  @param _writer The writer of the script.
+     **/
+    static void writeEnvironment(LuaWriter& _writer);
+
+    /**
+     *  Write the value of an unlinked input in the script being written, for Processor::iceSL:
+     *  the IceSL tweak setting it, or the value.
+     *  @param _writer The writer of the script.
+     *  @param _input The input.
+     **/
+    static void writeTweak(LuaWriter& _writer, ProcessorInput& _input);
+
+    /**
+     *  Whether an input is written as an IceSL tweak, see ExportOptions::ui_tweaks.
+     *  @param _input The input.
+     *  @param _options How the script is written.
+     **/
+    static bool isUiTweak(ProcessorInput& _input, const ExportOptions& _options);
+
+    /** The name of an IceSL tweak: node/input, the node numbered "node (2)" when several have its name */
+    static std::string tweakLabel(ProcessorInput& _input);
+
+    /**
+     *  Hash what the script of a graph depends on, but the values set in IceSL: the nodes,
+     *  their files, links and states, the values of the tweaks not set in IceSL. The script
+     *  needs no export while the hash stays the same.
+     *  @param _graph The graph.
+     *  @param _options How the script is written.
+     *  @return The hash.
+     **/
+    static uint64_t structure(ProcessingGraph& _graph, const ExportOptions& _options);
+
+    /**
+     *  Compute the structural hashes of the nodes of a graph, and of the graphs it contains:
+     *  the hash of a node covers its file, its tweak values and the hashes of the outputs it is
+     *  linked to, so that two nodes computing the same thing from the same values share it.
+     *  Disabled nodes, nodes emitting by themselves and groups get a hash of their own.
+     *  @param _graph The graph.
+     *  @param _hashes Receives the hash of each node.
+     *  @param _options How the script is written: a tweak set in IceSL counts by its name.
+     **/
+    static void hash(ProcessingGraph& _graph, std::unordered_map<Processor*, uint64_t>& _hashes, const ExportOptions& _options = ExportOptions());
+
+  private:
+    struct Context;
+
+    // whether the outputs of a node depend on a tweak set in IceSL
+    static bool dependsOnUi(Processor& _processor);
+
+    // the export being written on this thread
+    static thread_local Context* s_current;
+  };
+}
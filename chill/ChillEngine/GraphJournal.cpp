@@ -0,0 +1,541 @@
+#include "GraphJournal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <LibSL/LibSL.h>
+
+#include "IOs.h"
+#include "ProcessingGraph.h"
+
+#ifdef WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace chill {
+
+  namespace {
+    /** First line of the snapshots and journals, followed by the generation */
+    const char   c_header[] = "-- chill journal ";
+    /** Closes each complete edit, a journal is cut after the last one */
+    const char   c_end[]    = "-- end\n";
+
+    // the journal is synced at most this often
+    const std::chrono::milliseconds c_batch(250);
+    // below this size, the journal is never compacted
+    const size_t c_min_journal = 64 * 1024;
+
+    uint64_t fnv1a(const char* _data, size_t _size) {
+      uint64_t hash = 14695981039346656037ULL;
+      for (size_t i = 0; i < _size; ++i) {
+        hash ^= static_cast<unsigned char>(_data[i]);
+        hash *= 1099511628211ULL;
+      }
+      return hash;
+    }
+
+    uint32_t generation(std::string_view _text) {
+      size_t length = sizeof(c_header) - 1;
+      if (_text.compare(0, length, c_header) != 0) {
+        return 0;
+      }
+      uint32_t generation = 0;
+      for (size_t i = length; i < _text.size() && _text[i] >= '0' && _text[i] <= '9'; ++i) {
+        generation = generation * 10 + static_cast<uint32_t>(_text[i] - '0');
+      }
+      return generation;
+    }
+
+    fs::path journalPath(const fs::path& _filename) {
+      fs::path path = _filename;
+      path += ".journal";
+      return path;
+    }
+
+    fs::path nextPath(const fs::path& _filename) {
+      fs::path path = _filename;
+      path += ".journal.next";
+      return path;
+    }
+
+    std::string readFile(const fs::path& _filename) {
+      std::ifstream file(_filename, std::ios::binary);
+      std::ostringstream content;
+      content << file.rdbuf();
+      return content.str();
+    }
+
+    /** The complete edits of a journal of this generation, empty if there is none */
+    std::string edits(const fs::path& _journal, uint32_t _generation) {
+      std::string journal = readFile(_journal);
+      if (journal.empty() || generation(journal) != _generation) {
+        return std::string();
+      }
+      // a crash may leave half an edit at the end, and a header alone holds no edit
+      size_t end = journal.rfind(c_end);
+      if (end == std::string::npos || end == journal.find(c_end)) {
+        return std::string();
+      }
+      journal.resize(end + sizeof(c_end) - 1);
+      return journal;
+    }
+
+    //-------------------------------------------------------
+
+    int openFile(const fs::path& _filename, bool _append) {
+      int flags = O_WRONLY | O_CREAT | (_append ? O_APPEND : O_TRUNC);
+#ifdef WIN32
+      return _wopen(_filename.wstring().c_str(), flags | O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+      return ::open(_filename.c_str(), flags, 0644);
+#endif
+    }
+
+    bool writeFile(int _file, const char* _data, size_t _size) {
+      while (_size > 0) {
+#ifdef WIN32
+        int written = _write(_file, _data, static_cast<unsigned int>(std::min<size_t>(_size, 1 << 30)));
+#else
+        ssize_t written = ::write(_file, _data, _size);
+#endif
+        if (written <= 0) {
+          return false;
+        }
+        _data += written;
+        _size -= static_cast<size_t>(written);
+      }
+      return true;
+    }
+
+    bool syncFile(int _file) {
+#ifdef WIN32
+      return _commit(_file) == 0;
+#else
+      return fsync(_file) == 0;
+#endif
+    }
+
+    void closeFile(int _file) {
+#ifdef WIN32
+      _close(_file);
+#else
+      ::close(_file);
+#endif
+    }
+
+    /** A link, by the ids of its ports and of their processors */
+    struct Link {
+      int64_t output;
+      int64_t input;
+      int64_t from;
+      int64_t to;
+    };
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphJournal::setAside(const fs::path& _filename, fs::path& _aside) {
+    _aside.clear();
+    uint32_t expected = generation(readFile(_filename));
+    for (const fs::path& path : { journalPath(_filename), nextPath(_filename) }) {
+      if (edits(path, expected).empty()) {
+        continue;
+      }
+      fs::path aside = _filename;
+      aside += ".journal." + std::to_string(std::time(nullptr)) + ".unrecovered";
+      std::error_code error;
+      fs::rename(path, aside, error);
+      if (error) {
+        return false;
+      }
+      _aside = aside;
+      // the other one would be taken for the journal of the next snapshot
+      fs::remove(journalPath(_filename), error);
+      fs::remove(nextPath(_filename), error);
+      return true;
+    }
+    return true;
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphJournal::replaceFile(const fs::path& _filename, const std::string& _content) {
+    fs::path temp = _filename;
+    temp += ".tmp";
+    int file = openFile(temp, false);
+    if (file < 0) {
+      return false;
+    }
+    bool written = writeFile(file, _content.data(), _content.size()) && syncFile(file);
+    closeFile(file);
+    std::error_code error;
+    if (written) {
+      fs::rename(temp, _filename, error);
+    }
+    if (!written || error) {
+      fs::remove(temp, error);
+      return false;
+    }
+    return true;
+  }
+
+  //-------------------------------------------------------
+
+  GraphJournal::~GraphJournal() {
+    if (m_writer.joinable()) {
+      m_writer.join();
+    }
+    sync();
+    if (m_journal >= 0) {
+      closeFile(m_journal);
+    }
+    if (m_next >= 0) {
+      closeFile(m_next);
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void GraphJournal::open(const fs::path& _filename, ProcessingGraph& _graph, bool _saved) {
+    if (m_writer.joinable()) {
+      finishSnapshot();
+    }
+    if (m_journal >= 0) {
+      sync();
+      closeFile(m_journal);
+      m_journal = -1;
+    }
+    m_filename = _filename;
+
+    std::string snapshot = readFile(_filename);
+    m_generation    = generation(snapshot);
+    m_snapshot_size = snapshot.size();
+    m_synced        = std::chrono::steady_clock::now();
+
+    if (!_saved) {
+      // the file names the nodes by the addresses of the session that wrote it, the edits
+      // of this one could not refer to them: the graph, with its journal if it had one, is
+      // replaced by a new snapshot
+      compact(_graph);
+      finishSnapshot();
+      return;
+    }
+
+    reset(_graph);
+    LuaWriter journal;
+    header(journal, _graph, m_generation, true);
+    m_journal = openFile(journalPath(_filename), false);
+    if (m_journal < 0 || !writeFile(m_journal, journal.data(), journal.size()) || !syncFile(m_journal)) {
+      std::cerr << Console::red << "Cannot write the journal of " << _filename.string() << Console::gray << std::endl;
+    }
+    m_journal_size = journal.size();
+  }
+
+  //-------------------------------------------------------
+
+  void GraphJournal::close(ProcessingGraph& _graph) {
+    if (!isOpen()) {
+      return;
+    }
+    // the file is left complete, without a journal
+    if (m_journal_size > m_header_size) {
+      compact(_graph);
+    }
+    if (m_writer.joinable()) {
+      finishSnapshot();
+    }
+    sync();
+    closeFile(m_journal);
+    m_journal = -1;
+    if (!m_write_failed) {
+      std::error_code error;
+      fs::remove(journalPath(m_filename), error);
+    }
+    m_entries.clear();
+    m_links.clear();
+  }
+
+  //-------------------------------------------------------
+
+  void GraphJournal::header(LuaWriter& _writer, ProcessingGraph& _graph, uint32_t _generation, bool _origins) {
+    _writer << c_header << _generation << "\n";
+    // the positions in the snapshot are from the barycenter of each graph, see ProcessingGraph::save
+    if (_origins) {
+      std::vector<ProcessingGraph*> graphs(1, &_graph);
+      while (!graphs.empty()) {
+        ProcessingGraph* graph = graphs.back();
+        graphs.pop_back();
+        if (!graph->processors()->empty()) {
+          Vec2 origin = graph->getBarycenter();
+          _writer << "origin(p_" << graph->getUniqueID() << ", " << origin.x << ", " << origin.y << ")\n";
+        }
+        for (std::shared_ptr<Processor> processor : *graph->processors()) {
+          if (ProcessingGraph* inner = dynamic_cast<ProcessingGraph*>(processor.get())) {
+            graphs.push_back(inner);
+          }
+        }
+      }
+    }
+    _writer << c_end;
+    m_header_size = _writer.size();
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphJournal::diff(ProcessingGraph& _graph, LuaWriter* _edits) {
+    for (auto& entry : m_entries) {
+      entry.second.seen = false;
+    }
+
+    int64_t root = _graph.getUniqueID();
+    auto found = m_entries.find(root);
+    if (found == m_entries.end()) {
+      // another main graph, as after an undo
+      if (_edits) return false;
+      found = m_entries.emplace(root, Entry()).first;
+    }
+    found->second.seen = true;
+
+    std::set<int64_t>     redefined;
+    std::vector<Link>     links;
+    std::vector<ProcessingGraph*> graphs(1, &_graph);
+    while (!graphs.empty()) {
+      ProcessingGraph* graph = graphs.back();
+      int64_t          id    = graph->getUniqueID();
+      graphs.pop_back();
+
+      for (std::shared_ptr<Processor> processor : *graph->processors()) {
+        int64_t          processor_id = processor->getUniqueID();
+        ProcessingGraph* inner        = dynamic_cast<ProcessingGraph*>(processor.get());
+        uint64_t         hash;
+        m_chunk.clear();
+        if (inner) {
+          m_chunk << inner->name();
+        } else {
+          processor->save(m_chunk);
+        }
+        hash = fnv1a(m_chunk.data(), m_chunk.size());
+
+        Entry& entry = m_entries[processor_id];
+        if (entry.seen || (entry.hash != 0 && entry.parent != id)) {
+          // moved to another graph
+          if (_edits) return false;
+        }
+        if (_edits && entry.hash != hash) {
+          // new and renamed graphs are only written by the snapshots
+          if (inner) return false;
+          _edits->append(m_chunk.data(), m_chunk.size());
+          if (entry.hash == 0) {
+            *_edits << "p_" << id << ":add(p_" << processor_id << ")\n";
+          } else {
+            redefined.insert(processor_id);
+          }
+        }
+        entry.hash   = hash;
+        entry.parent = id;
+        entry.seen   = true;
+
+        for (std::shared_ptr<ProcessorInput> input : processor->inputs()) {
+          if (input->m_link) {
+            links.push_back({ input->m_link->getUniqueID(), input->getUniqueID(), input->m_link->owner()->getUniqueID(), processor_id });
+          }
+        }
+        if (inner) {
+          graphs.push_back(inner);
+        }
+      }
+    }
+
+    for (auto entry = m_entries.begin(); entry != m_entries.end();) {
+      if (entry->second.seen) {
+        ++entry;
+        continue;
+      }
+      if (_edits) {
+        *_edits << "remove(p_" << entry->first << ")\n";
+      }
+      entry = m_entries.erase(entry);
+    }
+
+    Links current;
+    for (const Link& link : links) {
+      std::pair<int64_t, int64_t> ports(link.output, link.input);
+      current.insert(ports);
+      // the links of a redefined processor went with its previous definition
+      if (_edits && (m_links.count(ports) == 0 || redefined.count(link.from) || redefined.count(link.to))) {
+        *_edits << "connect( o_" << link.output << ", i_" << link.input << ")\n";
+      }
+    }
+    if (_edits) {
+      for (const auto& ports : m_links) {
+        if (current.count(ports) == 0) {
+          *_edits << "disconnect( o_" << ports.first << ", i_" << ports.second << ")\n";
+        }
+      }
+    }
+    m_links.swap(current);
+    return true;
+  }
+
+  //-------------------------------------------------------
+
+  void GraphJournal::reset(ProcessingGraph& _graph) {
+    m_entries.clear();
+    m_links.clear();
+    diff(_graph, nullptr);
+  }
+
+  //-------------------------------------------------------
+
+  void GraphJournal::record(ProcessingGraph& _graph) {
+    if (!isOpen()) {
+      return;
+    }
+    LuaWriter edits;
+    if (!diff(_graph, &edits)) {
+      compact(_graph);
+      return;
+    }
+    if (edits.size() == 0) {
+      return;
+    }
+    edits << c_end;
+    append(edits);
+
+    if (m_journal_size > std::max(c_min_journal, m_snapshot_size)) {
+      compact(_graph);
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void GraphJournal::append(const LuaWriter& _writer) {
+    m_pending.append(_writer.data(), _writer.size());
+    if (m_next >= 0) {
+      m_pending_next.append(_writer.data(), _writer.size());
+    }
+    m_journal_size += _writer.size();
+    m_bytes        += _writer.size();
+    if (std::chrono::steady_clock::now() - m_synced >= c_batch) {
+      sync();
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void GraphJournal::sync() {
+    bool written = true;
+    if (m_journal >= 0 && !m_pending.empty()) {
+      written = writeFile(m_journal, m_pending.data(), m_pending.size()) && syncFile(m_journal);
+    }
+    if (m_next >= 0 && !m_pending_next.empty()) {
+      written = writeFile(m_next, m_pending_next.data(), m_pending_next.size()) && syncFile(m_next) && written;
+    }
+    if (!written) {
+      std::cerr << Console::red << "Cannot write the journal of " << m_filename.string() << Console::gray << std::endl;
+    }
+    m_pending.clear();
+    m_pending_next.clear();
+    m_synced = std::chrono::steady_clock::now();
+  }
+
+  //-------------------------------------------------------
+
+  void GraphJournal::poll() {
+    if (!m_pending.empty() && std::chrono::steady_clock::now() - m_synced >= c_batch) {
+      sync();
+    }
+    if (m_writer.joinable() && m_written) {
+      finishSnapshot();
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void GraphJournal::compact(ProcessingGraph& _graph) {
+    // one snapshot at a time
+    if (m_writer.joinable()) {
+      finishSnapshot();
+    }
+    sync();
+
+    m_next_generation = m_generation + 1;
+    LuaWriter snapshot;
+    snapshot << c_header << m_next_generation << "\n";
+    _graph.save(snapshot);
+
+    // until the snapshot is written, the edits go to both journals
+    LuaWriter journal;
+    header(journal, _graph, m_next_generation, true);
+    m_next = openFile(nextPath(m_filename), false);
+    if (m_next < 0 || !writeFile(m_next, journal.data(), journal.size()) || !syncFile(m_next)) {
+      std::cerr << Console::red << "Cannot write the journal of " << m_filename.string() << Console::gray << std::endl;
+    }
+
+    reset(_graph);
+    m_journal_size  = journal.size();
+    m_snapshot_size = snapshot.size();
+    m_snapshots++;
+
+    m_written      = false;
+    m_write_failed = false;
+    m_writer = std::thread([this, content = snapshot.str()]() {
+      m_write_failed = !replaceFile(m_filename, content);
+      m_written      = true;
+    });
+  }
+
+  //-------------------------------------------------------
+
+  void GraphJournal::finishSnapshot() {
+    m_writer.join();
+    sync();
+    if (m_write_failed) {
+      std::cerr << Console::red << "Cannot write the graph " << m_filename.string() << ", keeping its journal" << Console::gray << std::endl;
+      if (m_next >= 0) {
+        closeFile(m_next);
+      }
+      m_next = -1;
+      std::error_code error;
+      fs::remove(nextPath(m_filename), error);
+      return;
+    }
+
+    // the new journal replaces the previous one
+    if (m_journal >= 0) {
+      closeFile(m_journal);
+    }
+    if (m_next >= 0) {
+      closeFile(m_next);
+    }
+    m_next = -1;
+    std::error_code error;
+    fs::rename(nextPath(m_filename), journalPath(m_filename), error);
+    m_journal    = openFile(journalPath(m_filename), true);
+    m_generation = m_next_generation;
+  }
+
+  //-------------------------------------------------------
+
+  std::string GraphJournal::recover(const fs::path& _filename, std::string_view _snapshot) {
+    uint32_t expected = generation(_snapshot);
+    // while a snapshot is written, its journal is the next one
+    for (const fs::path& path : { journalPath(_filename), nextPath(_filename) }) {
+      std::string journal = edits(path, expected);
+      if (!journal.empty()) {
+        return journal;
+      }
+    }
+    return std::string();
+  }
+}
@@ -0,0 +1,179 @@
+/** @file */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "LuaWriter.h"
+
+namespace chill {
+
+#ifdef WIN32
+namespace fs = std::experimental::filesystem;
+#else
+namespace fs = std::filesystem;
+#endif
+
+  class ProcessingGraph;
+
+  /**
+   *  GraphJournal class.
+   *  Automatic saving of a .graph file, as a snapshot and a journal of the edits.
+   *  Each edit appends to <file>.journal the Lua statements of the processors
+   *  and links that changed, the file itself is only rewritten when the journal
+   *  grows larger than it. The journal is synced to the disk in small batches,
+   *  the snapshot is written aside then renamed, in the background.
+   *  Snapshots and journals carry a generation number, so that after a crash
+   *  the graph is the snapshot followed by its journal, see recover().
+   *  Not thread safe, all the calls are from the editor.
+   **/
+  class GraphJournal
+  {
+  public:
+    GraphJournal() = default;
+    GraphJournal(const GraphJournal&) = delete;
+    GraphJournal& operator=(const GraphJournal&) = delete;
+    ~GraphJournal();
+
+    /**
+     *  Start saving a graph to its file.
+     *  @param _filename The .graph file.
+     *  @param _graph The main graph.
+     *  @param _saved true if the graph was just written to the file by ProcessingGraph::save,
+     *                false if it was just loaded from the file (with its journal, if any):
+     *                the file is then written again, as the journal names the nodes as they
+     *                are in memory.
+     **/
+    void open(const fs::path& _filename, ProcessingGraph& _graph, bool _saved);
+
+    /**
+     *  Stop saving the graph. The file is left complete: the journal is compacted
+     *  into it if it holds any edit, then removed.
+     *  @param _graph The main graph.
+     **/
+    void close(ProcessingGraph& _graph);
+
+    bool isOpen() const {
+      return m_journal >= 0;
+    }
+
+    /**
+     *  Append the edits made to the graph since the last call.
+     *  @param _graph The main graph.
+     **/
+    void record(ProcessingGraph& _graph);
+
+    /**
+     *  Write the whole graph to the file and start a new journal.
+     *  @param _graph The main graph.
+     **/
+    void compact(ProcessingGraph& _graph);
+
+    /**
+     *  Sync the last edits once the batch is old enough, and switch to the new
+     *  journal once the snapshot is written. Called at each frame.
+     **/
+    void poll();
+
+    /** Bytes appended to the journals */
+    size_t bytes() const {
+      return m_bytes;
+    }
+
+    /** Snapshots written */
+    int snapshots() const {
+      return m_snapshots;
+    }
+
+    /**
+     *  Get the journal that goes with a graph file.
+     *  @param _filename The .graph file.
+     *  @param _snapshot The content of the file.
+     *  @return The complete edits of the journal, to parse after the snapshot, empty if there is none.
+     **/
+    static std::string recover(const fs::path& _filename, std::string_view _snapshot);
+
+    /**
+     *  Move the journal of a graph file aside, when the file is loaded without it: the next
+     *  snapshot would replace the edits it holds.
+     *  @param _filename The .graph file.
+     *  @param _aside Receives where the journal went, empty if the file has no journal holding edits.
+     *  @return false if the journal holds edits and cannot be moved.
+     **/
+    static bool setAside(const fs::path& _filename, fs::path& _aside);
+
+    /**
+     *  Replace a file atomically: write the content aside, sync it to the disk, then rename it,
+     *  so that a crash leaves the old file or the new one, never a part of it.
+     *  @param _filename The file.
+     *  @param _content The new content.
+     *  @return false if the file cannot be written, it is unchanged.
+     **/
+    static bool replaceFile(const fs::path& _filename, const std::string& _content);
+
+  private:
+    struct Entry {
+      uint64_t hash   = 0;
+      int64_t  parent = 0;
+      bool     seen   = false;
+    };
+
+    /** Links, by the ids of their output and input */
+    typedef std::set<std::pair<int64_t, int64_t>> Links;
+
+    /**
+     *  Compare the graph with the entries and links, and update them.
+     *  @param _edits Where to write the statements, nullptr to only update.
+     *  @return false if an edit cannot be journaled (new or renamed graph, processor
+     *          moved to another graph, other main graph), a snapshot is then needed.
+     **/
+    bool diff(ProcessingGraph& _graph, LuaWriter* _edits);
+
+    /** Entries and links of the graph as it is */
+    void reset(ProcessingGraph& _graph);
+
+    /** Start of a journal: its generation and, after a snapshot, the origins of the graphs */
+    void header(LuaWriter& _writer, ProcessingGraph& _graph, uint32_t _generation, bool _origins);
+
+    /** Append to the journals, synced by poll() */
+    void append(const LuaWriter& _writer);
+
+    void sync();
+
+    /** Wait for the snapshot and switch to its journal */
+    void finishSnapshot();
+
+    fs::path m_filename;
+    uint32_t m_generation = 0;
+    int      m_journal    = -1;
+
+    // while a snapshot is written: the journal of the next generation
+    std::thread       m_writer;
+    std::atomic<bool> m_written{ false };
+    bool              m_write_failed    = false;
+    int               m_next            = -1;
+    uint32_t          m_next_generation = 0;
+
+    std::string m_pending;
+    std::string m_pending_next;
+    std::chrono::steady_clock::time_point m_synced;
+
+    std::unordered_map<int64_t, Entry> m_entries;
+    Links                              m_links;
+    LuaWriter                          m_chunk;
+
+    size_t m_snapshot_size = 0;
+    size_t m_journal_size  = 0;
+    size_t m_header_size   = 0;
+    size_t m_bytes         = 0;
+    int    m_snapshots     = 0;
+  };
+}
@@ -0,0 +1,242 @@
+#include "GraphLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+
+#include "GraphJournal.h"
+#include "GraphParser.h"
+#include "IOs.h"
+#include "LuaProcessor.h"
+#include "NodeLibrary.h"
+#include "ProcessingGraph.h"
+#include "Style.h"
+
+namespace chill {
+
+  namespace {
+    const Style c_style;
+
+    // nodes created between two looks at the clock
+    const size_t c_batch = 16;
+  }
+
+  //-------------------------------------------------------
+
+  GraphLoader::GraphLoader(const GraphView& _view) {
+    m_view = _view;
+    prepare();
+  }
+
+  //-------------------------------------------------------
+
+  std::unique_ptr<GraphLoader> GraphLoader::open(const fs::path& _filename, std::string& _error) {
+    std::unique_ptr<GraphLoader> loader(new GraphLoader());
+    if (GraphBinary::recognize(_filename)) {
+      if (!loader->m_binary.open(_filename)) {
+        _error = "corrupted binary graph";
+        return nullptr;
+      }
+      loader->m_view = loader->m_binary.view();
+    } else {
+      std::ifstream file(_filename, std::ios::binary);
+      if (!file.is_open()) {
+        _error = "cannot read the file";
+        return nullptr;
+      }
+      std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+      // edits saved after the file, not yet compacted into it
+      text += GraphJournal::recover(_filename, text);
+      if (!GraphParser::parse(text, loader->m_data, _error)) {
+        // its nodes will find their signatures already parsed
+        NodeLibrary::Instance().refresh(GraphParser::nodepaths(text));
+        return nullptr;
+      }
+      loader->m_view = loader->m_data.view();
+    }
+    loader->prepare();
+    if (!loader->m_graph) {
+      _error = "no main graph";
+      return nullptr;
+    }
+    return loader;
+  }
+
+  //-------------------------------------------------------
+
+  void GraphLoader::prepare() {
+    const GraphView& view = m_view;
+    if (view.root >= view.node_count) {
+      return;
+    }
+
+    // the node files are read and parsed once each, in parallel, before any node is created
+    NodeLibrary& library = NodeLibrary::Instance();
+    library.refresh(view.nodepaths());
+    for (uint32_t n = 0; n < view.node_count; ++n) {
+      std::string_view path = view.string(view.nodes[n].path);
+      if (view.nodes[n].kind == GraphData::NODE && m_signatures.find(path) == m_signatures.end()) {
+        m_signatures[path] = library.signature(std::string(path));
+      }
+    }
+
+    m_processors.resize(view.node_count);
+    m_inputs.resize(view.port_count);
+    m_outputs.resize(view.port_count);
+
+    std::vector<std::vector<uint32_t>> children(view.node_count);
+    for (uint32_t n = 0; n < view.node_count; ++n) {
+      if (view.nodes[n].parent != GraphData::c_none) {
+        children[view.nodes[n].parent].push_back(n);
+      }
+    }
+
+    for (uint32_t n : children[view.root]) {
+      const GraphData::Node& node = view.nodes[n];
+      m_bounds.m_Mins[0] = std::min(m_bounds.m_Mins[0], node.x);
+      m_bounds.m_Mins[1] = std::min(m_bounds.m_Mins[1], node.y);
+      m_bounds.m_Maxs[0] = std::max(m_bounds.m_Maxs[0], node.x + c_style.processor_width);
+      m_bounds.m_Maxs[1] = std::max(m_bounds.m_Maxs[1], node.y + c_style.processor_width);
+    }
+
+    // the view opens on the center of the graph, the nodes there come first
+    std::vector<uint32_t> top = children[view.root];
+    float center_x = (m_bounds.m_Mins[0] + m_bounds.m_Maxs[0]) / 2.0F;
+    float center_y = (m_bounds.m_Mins[1] + m_bounds.m_Maxs[1]) / 2.0F;
+    auto distance = [&](uint32_t _n) {
+      float dx = view.nodes[_n].x - center_x;
+      float dy = view.nodes[_n].y - center_y;
+      return dx * dx + dy * dy;
+    };
+    std::stable_sort(top.begin(), top.end(), [&](uint32_t _a, uint32_t _b) {
+      return distance(_a) < distance(_b);
+    });
+
+    // then a nested graph with all its content, parents first
+    std::vector<uint32_t> pending;
+    for (uint32_t n : top) {
+      pending.push_back(n);
+      while (!pending.empty()) {
+        uint32_t next = pending.back();
+        pending.pop_back();
+        m_order.push_back(next);
+        pending.insert(pending.end(), children[next].rbegin(), children[next].rend());
+      }
+    }
+
+    m_first_link.assign(view.node_count + 1, 0);
+    for (uint32_t e = 0; e < view.edge_count; ++e) {
+      uint32_t from = view.ports[view.edges[e].output].node;
+      uint32_t to   = view.ports[view.edges[e].input].node;
+      m_first_link[from + 1]++;
+      if (to != from) {
+        m_first_link[to + 1]++;
+      }
+    }
+    for (uint32_t n = 0; n < view.node_count; ++n) {
+      m_first_link[n + 1] += m_first_link[n];
+    }
+    m_links.resize(m_first_link[view.node_count]);
+    std::vector<uint32_t> fill(m_first_link.begin(), m_first_link.end() - 1);
+    for (uint32_t e = 0; e < view.edge_count; ++e) {
+      uint32_t from = view.ports[view.edges[e].output].node;
+      uint32_t to   = view.ports[view.edges[e].input].node;
+      m_links[fill[from]++] = e;
+      if (to != from) {
+        m_links[fill[to]++] = e;
+      }
+    }
+
+    create(view.root);
+    m_graph = std::static_pointer_cast<ProcessingGraph>(m_processors[view.root]);
+  }
+
+  //-------------------------------------------------------
+
+  void GraphLoader::create(uint32_t _node) {
+    const GraphView&       view = m_view;
+    const GraphData::Node& node = view.nodes[_node];
+    std::string name(view.string(node.name));
+
+    std::shared_ptr<Processor> processor;
+    switch (node.kind) {
+    case GraphData::GRAPH:
+      processor = std::shared_ptr<Processor>(new ProcessingGraph(name));
+      break;
+    case GraphData::NODE:
+      // creates the inputs and outputs declared by the node file
+      processor = std::shared_ptr<Processor>(new LuaProcessor(std::string(view.string(node.path)), *m_signatures[view.string(node.path)]));
+      processor->setName(name);
+      break;
+    default:
+      processor = std::shared_ptr<Processor>(new Processor(name));
+      break;
+    }
+    processor->setPosition(Vec2(node.x, node.y));
+    processor->setColor(Color(node.color[0], node.color[1], node.color[2]));
+
+    for (uint32_t p = node.first_port; p < node.first_port + node.port_count; ++p) {
+      const GraphData::Port& port = view.ports[p];
+      std::string    port_name(view.string(port.name));
+      IOType::IOType type = static_cast<IOType::IOType>(port.type);
+
+      if (port.flags & GraphData::OUTPUT) {
+        std::shared_ptr<ProcessorOutput> output = processor->output(port_name);
+        if (!output || output->type() != type) {
+          output = processor->addOutput(ProcessorOutput::create(port_name, type, false));
+        }
+        output->setEmitable((port.flags & GraphData::EMITABLE) != 0);
+        m_outputs[p] = output;
+      } else {
+        // keep the input declared by the node file, with its choices and filters
+        std::shared_ptr<ProcessorInput> input = processor->input(port_name);
+        if (!input || input->type() != type) {
+          input = processor->addInput(ProcessorInput::create(port_name, type));
+        }
+        input->load(port, view.string(port.text));
+        if (port.flags & GraphData::DATA_ONLY) {
+          input->m_isDataOnly = true;
+        }
+        m_inputs[p] = input;
+      }
+    }
+
+    if (node.parent != GraphData::c_none) {
+      std::static_pointer_cast<ProcessingGraph>(m_processors[node.parent])->addProcessor(processor);
+    }
+    m_processors[_node] = processor;
+
+    // links whose other end already exists
+    for (uint32_t l = m_first_link[_node]; l < m_first_link[_node + 1]; ++l) {
+      const GraphData::Edge& edge = view.edges[m_links[l]];
+      if (m_outputs[edge.output] && m_inputs[edge.input]) {
+        Processor::connect(m_outputs[edge.output], m_inputs[edge.input]);
+      }
+    }
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphLoader::step(double _budget) {
+    auto start = std::chrono::steady_clock::now();
+    while (!done()) {
+      size_t end = std::min(m_order.size(), m_next + c_batch);
+      for (; m_next < end; ++m_next) {
+        create(m_order[m_next]);
+      }
+      if (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= _budget) {
+        break;
+      }
+    }
+    return done();
+  }
+
+  //-------------------------------------------------------
+
+  void GraphLoader::finish() {
+    while (!done()) {
+      create(m_order[m_next++]);
+    }
+  }
+}
@@ -0,0 +1,130 @@
+/** @file */
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <LibSL/LibSL.h>
+
+#include "GraphBinary.h"
+#include "GraphData.h"
+#include "NodeSignature.h"
+
+namespace chill {
+
+#ifdef WIN32
+namespace fs = std::experimental::filesystem;
+#else
+namespace fs = std::filesystem;
+#endif
+
+  class Processor;
+  class ProcessorInput;
+  class ProcessorOutput;
+
+  /**
+   *  GraphLoader class.
+   *  Creates the processors of a graph description a few at a time, so that the
+   *  editor keeps drawing while a large graph comes in.
+   *  The node files are parsed first, all at once and in parallel. The main graph
+   *  exists from the start and fills up as step() is called: the nodes closest to
+   *  the center of the graph come first, a nested graph always before its content,
+   *  and each link is made as soon as both its ends exist.
+   **/
+  class GraphLoader
+  {
+  public:
+    /**
+     *  Prepare the loading of a graph description.
+     *  @param _view The description, it must outlive the loader.
+     **/
+    explicit GraphLoader(const GraphView& _view);
+
+    GraphLoader(const GraphLoader&) = delete;
+    GraphLoader& operator=(const GraphLoader&) = delete;
+
+    /**
+     *  Prepare the loading of a graph file, binary or written by ProcessingGraph::save.
+     *  The loader keeps the content of the file.
+     *  @param _filename The file.
+     *  @param _error Why the file cannot be loaded this way.
+     *  @return nullptr if the file cannot be read, or has to be run in Lua (GraphSaver).
+     **/
+    static std::unique_ptr<GraphLoader> open(const fs::path& _filename, std::string& _error);
+
+    /**
+     *  Create the next processors.
+     *  @param _budget The time to spend, in milliseconds. At least one processor is created.
+     *  @return true once the graph is complete.
+     **/
+    bool step(double _budget);
+
+    /** Create all the remaining processors */
+    void finish();
+
+    bool done() const {
+      return m_next >= m_order.size();
+    }
+
+    /** The main graph, complete once done() */
+    std::shared_ptr<ProcessingGraph> graph() const {
+      return m_graph;
+    }
+
+    /** Fraction of the processors created, from 0 to 1 */
+    float progress() const {
+      return m_order.empty() ? 1.0F : static_cast<float>(m_next) / static_cast<float>(m_order.size());
+    }
+
+    size_t created() const {
+      return m_next;
+    }
+
+    size_t total() const {
+      return m_order.size();
+    }
+
+    /**
+     *  Estimate the bounding box of the main graph, from the positions of its
+     *  nodes and the width of a processor, before they are created.
+     **/
+    AASquare bounds() const {
+      return m_bounds;
+    }
+
+  private:
+    GraphLoader() = default;
+
+    /** Parse the node files and choose the creation order */
+    void prepare();
+
+    /** Create a processor with its inputs and outputs, and make its links */
+    void create(uint32_t _node);
+
+    // content of the file, when the loader opened it
+    GraphData   m_data;
+    GraphBinary m_binary;
+
+    GraphView m_view;
+    std::unordered_map<std::string_view, std::shared_ptr<const NodeSignature>> m_signatures;
+
+    std::shared_ptr<ProcessingGraph> m_graph;
+    AASquare                         m_bounds;
+
+    // nodes in creation order, the main graph excluded
+    std::vector<uint32_t> m_order;
+    size_t                m_next = 0;
+
+    // edges touching each node: m_links[m_first_link[n]] to m_links[m_first_link[n + 1]]
+    std::vector<uint32_t> m_first_link;
+    std::vector<uint32_t> m_links;
+
+    std::vector<std::shared_ptr<Processor>>       m_processors;
+    std::vector<std::shared_ptr<ProcessorInput>>  m_inputs;
+    std::vector<std::shared_ptr<ProcessorOutput>> m_outputs;
+  };
+}
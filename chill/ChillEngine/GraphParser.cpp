@@ -0,0 +1,519 @@
+#include "GraphParser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "IOs.h"
+#include "LuaLexer.h"
+#include "Style.h"
+
+namespace chill {
+
+  namespace {
+
+    using namespace lua;
+
+    /** Default colors of the processors */
+    const Style c_style;
+
+    enum ObjectKind { GRAPH, PROCESSOR, NODE, INPUT, OUTPUT };
+
+    /** What a variable of the file holds */
+    struct Object {
+      ObjectKind       kind;
+      std::string      name;
+      std::string      path;
+      std::string      text;      // value of the PATH and STRING inputs
+      float            x = 0.0F, y = 0.0F;
+      Color            color;
+      GraphData::Port  port = {}; // inputs and outputs
+      std::vector<int> ports;     // of a processor, in :add order
+      std::vector<int> children;  // of a graph, in :add order
+      float            origin_x = 0.0F, origin_y = 0.0F; // of a graph, set by origin(...)
+      int              owner = -1;
+      uint32_t         index = GraphData::c_none; // once in the GraphData
+    };
+
+    /** A value of a table field */
+    struct Value {
+      enum { NUMBER, STRING, BOOLEAN, LIST } kind = NUMBER;
+      double              number = 0.0;
+      std::string         text;
+      std::vector<double> list;
+    };
+
+    typedef std::unordered_map<std::string_view, Value> Table;
+
+    class Reader
+    {
+    public:
+      explicit Reader(std::string_view _text) : m_lexer(_text) {
+        m_token = m_lexer.next();
+      }
+
+      bool parse(GraphData& _data, std::string& _error) {
+        while (m_token.kind != END) {
+          if (isSymbol(m_token, ';')) {
+            advance();
+            continue;
+          }
+          if (!statement()) {
+            _error = m_error.empty() ? "unexpected '" + std::string(m_token.text) + "'" : m_error;
+            return false;
+          }
+        }
+        if (m_root < 0) {
+          _error = "no set_graph";
+          return false;
+        }
+        if (!emit(m_root, GraphData::c_none, _data)) {
+          _error = m_error;
+          return false;
+        }
+        _data.root = m_objects[m_root].index;
+
+        for (const auto& connection : m_connections) {
+          uint32_t output = m_objects[connection.first].index;
+          uint32_t input  = m_objects[connection.second].index;
+          // links of processors out of the main graph are dropped, as their processors
+          if (output != GraphData::c_none && input != GraphData::c_none) {
+            _data.edges.push_back({ output, input });
+          }
+        }
+        return true;
+      }
+
+    private:
+      void advance() {
+        m_token = m_lexer.next();
+      }
+
+      bool expect(char _symbol) {
+        if (!isSymbol(m_token, _symbol)) {
+          return false;
+        }
+        advance();
+        return true;
+      }
+
+      bool fail(const std::string& _error) {
+        m_error = _error;
+        return false;
+      }
+
+      /** A variable holding an object, -1 if there is none */
+      int variable(std::string_view _name) const {
+        auto found = m_variables.find(_name);
+        return (found == m_variables.end()) ? -1 : found->second;
+      }
+
+      bool readNumber(double& _number) {
+        bool negative = isSymbol(m_token, '-');
+        if (negative) advance();
+        if (m_token.kind != NUMBER) return false;
+        const char* end = m_token.text.data() + m_token.text.size();
+        auto result = std::from_chars(m_token.text.data(), end, _number);
+        // hexadecimal numbers and the like are left to Lua
+        if (result.ec != std::errc() || result.ptr != end) return false;
+        if (negative) _number = -_number;
+        advance();
+        return true;
+      }
+
+      bool readString(std::string& _text) {
+        if (m_token.kind != STRING) return false;
+        _text = decode(m_token);
+        advance();
+        return true;
+      }
+
+      bool readValue(Value& _value) {
+        if (m_token.kind == STRING) {
+          _value.kind = Value::STRING;
+          return readString(_value.text);
+        }
+        if (m_token.kind == NAME && (m_token.text == "true" || m_token.text == "false")) {
+          _value.kind   = Value::BOOLEAN;
+          _value.number = (m_token.text == "true") ? 1.0 : 0.0;
+          advance();
+          return true;
+        }
+        if (isSymbol(m_token, '{')) {
+          _value.kind = Value::LIST;
+          advance();
+          while (!isSymbol(m_token, '}')) {
+            double number;
+            if (!readNumber(number)) return false;
+            _value.list.push_back(number);
+            if (!expect(',') && !expect(';') && !isSymbol(m_token, '}')) return false;
+          }
+          advance();
+          return true;
+        }
+        _value.kind = Value::NUMBER;
+        return readNumber(_value.number);
+      }
+
+      /** {name = value, ...} */
+      bool readTable(Table& _table) {
+        if (!expect('{')) return false;
+        while (!isSymbol(m_token, '}')) {
+          if (m_token.kind != NAME) return false;
+          std::string_view field = m_token.text;
+          advance();
+          if (!expect('=')) return false;
+          if (!readValue(_table[field])) return false;
+          if (!expect(',') && !expect(';') && !isSymbol(m_token, '}')) return false;
+        }
+        advance();
+        return true;
+      }
+
+      //-------------------------------------------------------
+
+      static const Value* field(const Table& _table, const char* _name) {
+        auto found = _table.find(_name);
+        return (found == _table.end()) ? nullptr : &found->second;
+      }
+
+      static float number(const Table& _table, const char* _name, float _default) {
+        const Value* value = field(_table, _name);
+        return (value && value->kind == Value::NUMBER) ? static_cast<float>(value->number) : _default;
+      }
+
+      static int integer(const Table& _table, const char* _name, int _default) {
+        const Value* value = field(_table, _name);
+        if (!value || value->kind != Value::NUMBER) {
+          return _default;
+        }
+        double clamped = std::min<double>(std::max<double>(value->number, IntInput::min()), IntInput::max());
+        return static_cast<int>(clamped);
+      }
+
+      static bool boolean(const Table& _table, const char* _name) {
+        const Value* value = field(_table, _name);
+        return value && value->kind == Value::BOOLEAN && value->number != 0.0;
+      }
+
+      static std::string text(const Table& _table, const char* _name, const std::string& _default) {
+        const Value* value = field(_table, _name);
+        return (value && value->kind == Value::STRING) ? value->text : _default;
+      }
+
+      /** Processor, Node and Graph tables, as the Lua_Processor constructors read them */
+      static void readProcessor(const Table& _table, Object& _object) {
+        _object.name = text(_table, "name", _object.name);
+        _object.path = text(_table, "path", "");
+        _object.x    = number(_table, "x", 0.0F);
+        _object.y    = number(_table, "y", 0.0F);
+        const Value* color = field(_table, "color");
+        if (color && color->kind == Value::LIST && color->list.size() >= 3) {
+          _object.color = Color(static_cast<int>(color->list[0]), static_cast<int>(color->list[1]), static_cast<int>(color->list[2]));
+        }
+      }
+
+      /** Input({...}), the tweak values as the inputs save them */
+      bool readInput(const Table& _table, Object& _object) {
+        const Value* name = field(_table, "name");
+        const Value* type = field(_table, "type");
+        if (!name || !type || name->kind != Value::STRING || type->kind != Value::STRING) {
+          return fail("input without name or type");
+        }
+        _object.name = name->text;
+
+        GraphData::Port& port = _object.port;
+        port.type  = static_cast<uint8_t>(IOType::FromString(type->text));
+        port.flags = boolean(_table, "alt") ? GraphData::ALT : 0;
+
+        const Value* value = field(_table, "value");
+        switch (port.type) {
+        case IOType::BOOLEAN:
+          port.integer[0] = boolean(_table, "value") ? 1 : 0;
+          break;
+        case IOType::INTEGER:
+        case IOType::LIST:
+          port.integer[0] = integer(_table, "value", 0);
+          port.integer[1] = integer(_table, "min",   IntInput::min());
+          port.integer[2] = integer(_table, "max",   IntInput::max());
+          port.integer[3] = integer(_table, "step",  IntInput::step());
+          break;
+        case IOType::REAL:
+          port.real[0] = number(_table, "value", 0.0F);
+          port.real[4] = number(_table, "min",   RealInput::min());
+          port.real[5] = number(_table, "max",   RealInput::max());
+          port.real[6] = number(_table, "step",  RealInput::step());
+          break;
+        case IOType::VEC3:
+        case IOType::VEC4:
+          if (value && value->kind == Value::LIST) {
+            for (size_t i = 0; i < value->list.size() && i < 4; ++i) {
+              port.real[i] = static_cast<float>(value->list[i]);
+            }
+          }
+          port.real[4] = number(_table, "min",  Vec3Input::min());
+          port.real[5] = number(_table, "max",  Vec3Input::max());
+          port.real[6] = number(_table, "step", Vec3Input::step());
+          break;
+        case IOType::PATH:
+        case IOType::STRING:
+          _object.text = text(_table, "value", "");
+          break;
+        default:
+          break;
+        }
+        return true;
+      }
+
+      /** Output({...}), outputs of shapes are emitable */
+      static void readOutput(const Table& _table, Object& _object) {
+        _object.name = text(_table, "name", "undef");
+        IOType::IOType type = IOType::FromString(text(_table, "type", "UNDEF"));
+        _object.port.type  = static_cast<uint8_t>(type);
+        _object.port.flags = GraphData::OUTPUT | (type == IOType::SHAPE ? GraphData::EMITABLE : 0);
+      }
+
+      //-------------------------------------------------------
+
+      /** var = Constructor(...) */
+      bool assignment(std::string_view _variable) {
+        if (m_token.kind != NAME) return false;
+        std::string_view constructor = m_token.text;
+        advance();
+        if (!expect('(')) return false;
+
+        Object object;
+        Table  table;
+        bool   has_table = isSymbol(m_token, '{');
+        std::string name;
+        if (has_table) {
+          if (!readTable(table)) return false;
+        } else if (m_token.kind == STRING) {
+          readString(name);
+        }
+        if (!expect(')')) return false;
+
+        if (constructor == "Graph") {
+          object.kind  = GRAPH;
+          object.name  = has_table ? "Graph" : (name.empty() ? "graph" : name);
+          object.color = c_style.processor_graph_color;
+          if (has_table) readProcessor(table, object);
+        } else if (constructor == "Processor" || constructor == "Node") {
+          object.kind  = (constructor == "Node") ? NODE : PROCESSOR;
+          object.name  = has_table ? constructor : (name.empty() ? "Processor" : name);
+          object.color = c_style.processor_default_color;
+          if (has_table) readProcessor(table, object);
+        } else if (constructor == "Input") {
+          object.kind = INPUT;
+          if (!readInput(table, object)) return false;
+        } else if (constructor == "Output") {
+          object.kind = OUTPUT;
+          readOutput(table, object);
+        } else {
+          return fail("unknown constructor " + std::string(constructor));
+        }
+
+        int index = static_cast<int>(m_objects.size());
+        int previous = variable(_variable);
+        m_variables[_variable] = index;
+        m_objects.push_back(object);
+
+        // a journal redefines a processor in place, see GraphJournal
+        if (previous >= 0 && m_objects[previous].kind <= NODE && m_objects[index].kind <= NODE && m_objects[previous].owner >= 0) {
+          int owner = m_objects[previous].owner;
+          std::vector<int>& children = m_objects[owner].children;
+          std::replace(children.begin(), children.end(), previous, index);
+          m_objects[previous].owner = -1;
+          attach(index, owner);
+        }
+        return true;
+      }
+
+      /** Set the owner of a processor, its position is then from the origin of the graph */
+      void attach(int _object, int _graph) {
+        Object& object = m_objects[_object];
+        object.owner = _graph;
+        object.x    -= m_objects[_graph].origin_x;
+        object.y    -= m_objects[_graph].origin_y;
+      }
+
+      /** name(var, ...), -1 if the statement does not start that way */
+      int argument() {
+        if (!expect('(') || m_token.kind != NAME) return -1;
+        int object = variable(m_token.text);
+        advance();
+        return object;
+      }
+
+      /** owner:add(object) */
+      bool add(int _owner) {
+        if (m_token.kind != NAME || m_token.text != "add") return false;
+        advance();
+        if (!expect('(') || m_token.kind != NAME) return false;
+        int added = variable(m_token.text);
+        advance();
+        if (!expect(')') || added < 0 || added == _owner) return false;
+
+        Object& owner  = m_objects[_owner];
+        Object& object = m_objects[added];
+        if (owner.kind > NODE || object.owner >= 0) {
+          return fail("bad :add");
+        }
+        if (object.kind == INPUT || object.kind == OUTPUT) {
+          owner.ports.push_back(added);
+          object.owner = _owner;
+        } else if (owner.kind == GRAPH) {
+          owner.children.push_back(added);
+          attach(added, _owner);
+        } else {
+          return fail("bad :add");
+        }
+        return true;
+      }
+
+      bool statement() {
+        if (m_token.kind != NAME) return false;
+        std::string_view name = m_token.text;
+        advance();
+
+        if (isSymbol(m_token, '=')) {
+          advance();
+          return assignment(name);
+        }
+        if (isSymbol(m_token, ':')) {
+          advance();
+          int owner = variable(name);
+          return owner >= 0 && add(owner);
+        }
+        if (name == "connect" || name == "disconnect") {
+          int output = argument();
+          if (output < 0 || !expect(',') || m_token.kind != NAME) return false;
+          int input = variable(m_token.text);
+          advance();
+          if (!expect(')')) return false;
+          if (input < 0 || m_objects[output].kind != OUTPUT || m_objects[input].kind != INPUT) {
+            return fail("bad " + std::string(name));
+          }
+          if (name == "connect") {
+            m_connections.emplace_back(output, input);
+          } else {
+            m_connections.erase(std::remove(m_connections.begin(), m_connections.end(), std::make_pair(output, input)), m_connections.end());
+          }
+          return true;
+        }
+        // the statements below are only written by GraphJournal
+        if (name == "remove") {
+          int object = argument();
+          if (object < 0 || !expect(')')) return false;
+          int owner = m_objects[object].owner;
+          if (m_objects[object].kind > NODE) {
+            return fail("bad remove");
+          }
+          if (owner >= 0) {
+            std::vector<int>& children = m_objects[owner].children;
+            children.erase(std::remove(children.begin(), children.end(), object), children.end());
+            m_objects[object].owner = -1;
+          }
+          return true;
+        }
+        if (name == "origin") {
+          int graph = argument();
+          double x, y;
+          if (graph < 0 || !expect(',') || !readNumber(x) || !expect(',') || !readNumber(y) || !expect(')')) return false;
+          if (m_objects[graph].kind != GRAPH) {
+            return fail("bad origin");
+          }
+          m_objects[graph].origin_x = static_cast<float>(x);
+          m_objects[graph].origin_y = static_cast<float>(y);
+          return true;
+        }
+        if (name == "set_graph") {
+          int graph = argument();
+          if (!expect(')')) return false;
+          if (graph < 0 || m_objects[graph].kind != GRAPH) {
+            return fail("bad set_graph");
+          }
+          m_root = graph;
+          return true;
+        }
+        return fail("unknown statement " + std::string(name));
+      }
+
+      //-------------------------------------------------------
+
+      /** Append a processor, its ports, then the processors it holds */
+      bool emit(int _object, uint32_t _parent, GraphData& _data) {
+        Object& object = m_objects[_object];
+        if (object.index != GraphData::c_none) {
+          return fail("graph nested in itself");
+        }
+        static const GraphData::Kind c_kinds[] = { GraphData::GRAPH, GraphData::PROCESSOR, GraphData::NODE };
+        object.index = static_cast<uint32_t>(_data.nodes.size());
+
+        GraphData::Node& node = _data.addNode(c_kinds[object.kind], object.name, _parent);
+        node.path = object.kind == NODE ? _data.intern(object.path) : GraphData::c_none;
+        node.x    = object.x;
+        node.y    = object.y;
+        node.color[0] = object.color.r;
+        node.color[1] = object.color.g;
+        node.color[2] = object.color.b;
+
+        for (int p : object.ports) {
+          Object& port = m_objects[p];
+          port.index = static_cast<uint32_t>(_data.ports.size());
+          GraphData::Port& added = _data.addPort(port.name, port.port.type, port.port.flags);
+          std::copy(port.port.integer, port.port.integer + 4, added.integer);
+          std::copy(port.port.real, port.port.real + 7, added.real);
+          if (!port.text.empty()) {
+            added.text = _data.intern(port.text);
+          }
+        }
+
+        uint32_t index = object.index;
+        for (int child : m_objects[_object].children) {
+          if (!emit(child, index, _data)) return false;
+        }
+        return true;
+      }
+
+      Lexer                                m_lexer;
+      Token                                m_token;
+      std::string                          m_error;
+      std::vector<Object>                  m_objects;
+      std::unordered_map<std::string_view, int> m_variables;
+      std::vector<std::pair<int, int>>     m_connections;
+      int                                  m_root = -1;
+    };
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphParser::parse(std::string_view _text, GraphData& _data, std::string& _error) {
+    Reader reader(_text);
+    return reader.parse(_data, _error);
+  }
+
+  //-------------------------------------------------------
+
+  std::vector<std::string> GraphParser::nodepaths(std::string_view _text) {
+    std::vector<std::string> paths;
+    std::unordered_set<std::string> seen;
+    lua::Lexer lexer(_text);
+    // any path = "..." field, whatever statement it is in
+    lua::Token previous[2];
+    for (lua::Token token = lexer.next(); token.kind != lua::END; token = lexer.next()) {
+      if (token.kind == lua::STRING && previous[1].kind == lua::SYMBOL && previous[1].text == "="
+        && previous[0].kind == lua::NAME && previous[0].text == "path") {
+        std::string path = lua::decode(token);
+        if (seen.insert(path).second) {
+          paths.push_back(path);
+        }
+      }
+      previous[0] = previous[1];
+      previous[1] = token;
+    }
+    return paths;
+  }
+}
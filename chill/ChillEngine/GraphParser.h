@@ -0,0 +1,43 @@
+/** @file */
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "GraphData.h"
+
+namespace chill {
+
+  /**
+   *  GraphParser class.
+   *  Native reader of the .graph files written by ProcessingGraph::save.
+   *  It knows the statements save() emits, Graph(...), Processor({...}),
+   *  Node({...}), Input({...}), Output({...}), :add(...), connect(...) and
+   *  set_graph(...), and builds a GraphData without running any Lua.
+   *  It also reads the journals appended by GraphJournal, which redefine,
+   *  remove(...) and disconnect(...) processors.
+   *  A file with anything else, hand written or from another tool, is
+   *  rejected and has to go through the Lua VM (GraphSaver).
+   **/
+  class GraphParser
+  {
+  public:
+    /**
+     *  Read a graph file.
+     *  @param _text The content of the file.
+     *  @param _data The graph description, main graph included.
+     *  @param _error Why the file was rejected.
+     *  @return false if the file holds a statement the parser does not know.
+     **/
+    static bool parse(std::string_view _text, GraphData& _data, std::string& _error);
+
+    /**
+     *  List the node files a graph file refers to, without reading it further.
+     *  Used before running a file in Lua, to parse its nodes ahead in parallel.
+     *  @param _text The content of the file.
+     *  @return The distinct node paths.
+     **/
+    static std::vector<std::string> nodepaths(std::string_view _text);
+  };
+}
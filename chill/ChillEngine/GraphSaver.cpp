@@ -3,10 +3,13 @@
 #include <array>
 
 #include "LuaProcessor.h"
-#include "NodeEditor.h"
+#include "ProcessingGraph.h"
 
 namespace chill {
 
+// the saver running a graph file on this thread, see set_graph
+static thread_local GraphSaver* s_running = nullptr;
+
 class Lua_Input {
   protected:
     std::shared_ptr<ProcessorInput> m_Ptr;
@@ -163,8 +166,8 @@ class Lua_Processor {
 
     Lua_Processor(const luabind::object& table) {
       std::string name = "Processor";
-      ImColor color = ui_cyan;
-      ImVec2 pos(0, 0);
+      Color color = ui_cyan;
+      Vec2 pos(0, 0);
 
       if (table.is_valid())
       {
@@ -176,7 +179,7 @@ class Lua_Processor {
           const  luabind::object& rgb = table["color"];
           if (rgb.is_valid()) {
             if (rgb[1] && rgb[2] && rgb[3]) {
-              color = ImColor(luabind::object_cast<int>(rgb[1]), luabind::object_cast<int>(rgb[2]), luabind::object_cast<int>(rgb[3]));
+              color = Color(luabind::object_cast<int>(rgb[1]), luabind::object_cast<int>(rgb[2]), luabind::object_cast<int>(rgb[3]));
             }
           }
         }
@@ -228,8 +231,8 @@ class Lua_Graph : public Lua_Processor {
 
     Lua_Graph(const luabind::object& table) {
       std::string name = "Graph";
-      ImColor color = ui_cyan;
-      ImVec2 pos(0, 0);
+      Color color = ui_cyan;
+      Vec2 pos(0, 0);
 
       if (table.is_valid()) {
         if (table["name"]) name = luabind::object_cast<std::string>(table["name"]);
@@ -240,7 +243,7 @@ class Lua_Graph : public Lua_Processor {
           const luabind::object & rgb = table["color"];
           if (rgb.is_valid()) {
             if (rgb[1] && rgb[2] && rgb[3]) {
-              color = ImColor(luabind::object_cast<int>(rgb[1]), luabind::object_cast<int>(rgb[2]), luabind::object_cast<int>(rgb[3]));
+              color = Color(luabind::object_cast<int>(rgb[1]), luabind::object_cast<int>(rgb[2]), luabind::object_cast<int>(rgb[3]));
             }
           }
         }
@@ -281,8 +284,8 @@ class Lua_Node : public Lua_Processor {
     Lua_Node(const luabind::object& table) {
       std::string name = "Node";
       std::string path = "";
-      ImColor     color = ui_cyan;
-      ImVec2      pos(0, 0);
+      Color       color = ui_cyan;
+      Vec2        pos(0, 0);
 
       if (table.is_valid()) {
         if (table["name"]) name = luabind::object_cast<std::string>(table["name"]);
@@ -294,7 +297,7 @@ class Lua_Node : public Lua_Processor {
           const luabind::object& rgb = table["color"];
           if (rgb.is_valid()) {
             if (rgb[1] && rgb[2] && rgb[3]) {
-              color = ImColor(luabind::object_cast<int>(rgb[1]), luabind::object_cast<int>(rgb[2]), luabind::object_cast<int>(rgb[3]));
+              color = Color(luabind::object_cast<int>(rgb[1]), luabind::object_cast<int>(rgb[2]), luabind::object_cast<int>(rgb[3]));
             }
           }
         }
@@ -319,7 +322,9 @@ static void lua_connect(
 //-------------------------------------------------------
 
 static void setAsMainGraph(Lua_Graph graph) {
-  NodeEditor::Instance()->setMainGraph(std::static_pointer_cast<ProcessingGraph>(graph.ptr()));
+  if (s_running) {
+    s_running->setMainGraph(std::static_pointer_cast<ProcessingGraph>(graph.ptr()));
+  }
 }
 
 //-------------------------------------------------------
@@ -331,7 +336,10 @@ void print(const std::string& string) {
 //-------------------------------------------------------
 
 void GraphSaver::execute(const fs::path* path) {
+  GraphSaver* previous = s_running;
+  s_running = this;
   luaL_dofile(m_LuaState, path->string().c_str());
+  s_running = previous;
 }
 
 //-------------------------------------------------------
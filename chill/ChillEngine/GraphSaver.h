@@ -4,6 +4,7 @@ extern "C" {
 }
 
 #include <filesystem>
+#include <memory>
 #include <string>
 
 #include <LibSL.h>
@@ -19,6 +20,8 @@ namespace fs = std::experimental::filesystem;
 namespace fs = std::filesystem;
 #endif
 
+class ProcessingGraph;
+
 class GraphSaver {
   public:
     GraphSaver() {
@@ -35,8 +38,18 @@ class GraphSaver {
 
     void registerBindings(lua_State*);
 
+    /** The graph the file set as main graph, nullptr if it did not */
+    std::shared_ptr<ProcessingGraph> mainGraph() const {
+      return m_main;
+    }
+
+    void setMainGraph(std::shared_ptr<ProcessingGraph> _graph) {
+      m_main = _graph;
+    }
+
   private:
     lua_State * m_LuaState;
+    std::shared_ptr<ProcessingGraph> m_main;
 }; // class GraphSaver
 
 } // namespace chill
@@ -0,0 +1,360 @@
+#include "GraphSweep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+#include "GraphLoader.h"
+#include "GraphExporter.h"
+#include "IOs.h"
+#include "LuaWriter.h"
+#include "ProcessingGraph.h"
+#include "ScalarEvaluator.h"
+#include "TaskPool.h"
+
+namespace chill {
+
+  namespace {
+    /** Random numbers from a seed and a position, so that any variant can be drawn alone */
+    uint64_t splitmix(uint64_t _x) {
+      _x += 0x9E3779B97F4A7C15ull;
+      _x = (_x ^ (_x >> 30)) * 0xBF58476D1CE4E5B9ull;
+      _x = (_x ^ (_x >> 27)) * 0x94D049BB133111EBull;
+      return _x ^ (_x >> 31);
+    }
+
+    std::string number(double _value, bool _integer) {
+      if (_integer) {
+        return std::to_string(std::llround(_value));
+      }
+      char text[32];
+      std::snprintf(text, sizeof(text), "%.9g", _value);
+      return text;
+    }
+
+    bool toNumber(const std::string& _text, double& _value) {
+      char* end = nullptr;
+      _value = std::strtod(_text.c_str(), &end);
+      return !_text.empty() && end == _text.c_str() + _text.size();
+    }
+
+    /** A graph and its swept tweaks, one per worker */
+    struct Instance {
+      std::shared_ptr<ProcessingGraph>                          graph;
+      std::vector<std::vector<std::shared_ptr<ProcessorInput>>> tweaks;
+      std::vector<std::string>                                  values;
+      LuaWriter                                                 writer;
+      // keeps the constants that do not depend on the swept tweaks
+      ScalarEvaluator                                           evaluator;
+    };
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphSweep::addAxis(const std::string& _spec, std::string& _error) {
+    size_t equal = _spec.find('=');
+    if (equal == std::string::npos || equal == 0) {
+      _error = "expected name=values, got " + _spec;
+      return false;
+    }
+    Axis axis;
+    axis.name = _spec.substr(0, equal);
+    std::string values = _spec.substr(equal + 1);
+
+    // min:max or min:max:count
+    std::vector<std::string> parts;
+    std::stringstream stream(values);
+    std::string part;
+    while (std::getline(stream, part, ':')) {
+      parts.push_back(part);
+    }
+    double min = 0.0;
+    double max = 0.0;
+    double n   = 0.0;
+    if ((parts.size() == 2 || parts.size() == 3) && toNumber(parts[0], min) && toNumber(parts[1], max)) {
+      if (parts.size() == 2) {
+        axis.range = true;
+        axis.min   = min;
+        axis.max   = max;
+      } else if (toNumber(parts[2], n) && n >= 1.0 && n == std::floor(n)) {
+        size_t count = static_cast<size_t>(n);
+        for (size_t i = 0; i < count; ++i) {
+          axis.values.push_back(number(count == 1 ? min : min + (max - min) * static_cast<double>(i) / static_cast<double>(count - 1), false));
+        }
+      } else {
+        _error = "expected min:max:count, got " + values;
+        return false;
+      }
+    } else {
+      // v1;v2;v3, the values may hold commas (vectors)
+      std::stringstream list(values);
+      while (std::getline(list, part, ';')) {
+        axis.values.push_back(part);
+      }
+      if (axis.values.empty()) {
+        _error = "no value for " + axis.name;
+        return false;
+      }
+    }
+    m_axes.push_back(axis);
+    return true;
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphSweep::loadVariants(const fs::path& _filename, std::string& _error) {
+    std::ifstream file(_filename);
+    if (!file.is_open()) {
+      _error = "cannot read " + _filename.string();
+      return false;
+    }
+    m_file_names.clear();
+    m_file_rows.clear();
+
+    std::string line;
+    while (std::getline(file, line)) {
+      std::stringstream stream(line);
+      std::vector<std::string> row;
+      std::string value;
+      while (stream >> value) {
+        row.push_back(value);
+      }
+      if (row.empty()) {
+        continue;
+      }
+      if (m_file_names.empty()) {
+        m_file_names = row;
+      } else if (row.size() != m_file_names.size()) {
+        _error = _filename.string() + ": " + std::to_string(row.size()) + " values instead of " + std::to_string(m_file_names.size()) + " in " + line;
+        return false;
+      } else {
+        m_file_rows.push_back(row);
+      }
+    }
+    if (m_file_names.empty()) {
+      _error = _filename.string() + " lists no tweak";
+      return false;
+    }
+    return true;
+  }
+
+  //-------------------------------------------------------
+
+  void GraphSweep::setRandom(size_t _count, uint64_t _seed) {
+    m_random = _count;
+    m_seed   = _seed;
+  }
+
+  //-------------------------------------------------------
+
+  size_t GraphSweep::count() const {
+    if (!m_file_names.empty()) {
+      return m_file_rows.size();
+    }
+    if (m_random > 0) {
+      return m_random;
+    }
+    size_t count = 1;
+    for (const Axis& axis : m_axes) {
+      count *= axis.values.size();
+    }
+    return count;
+  }
+
+  //-------------------------------------------------------
+
+  std::vector<std::string> GraphSweep::names() const {
+    std::vector<std::string> names = m_file_names;
+    for (const Axis& axis : m_axes) {
+      names.push_back(axis.name);
+    }
+    return names;
+  }
+
+  //-------------------------------------------------------
+
+  void GraphSweep::values(size_t _variant, std::vector<std::string>& _values) const {
+    _values.clear();
+    if (!m_file_names.empty()) {
+      _values = m_file_rows[_variant];
+      for (const Axis& axis : m_axes) {
+        _values.push_back(axis.values.front());
+      }
+      return;
+    }
+
+    if (m_random > 0) {
+      for (size_t a = 0; a < m_axes.size(); ++a) {
+        const Axis& axis = m_axes[a];
+        uint64_t draw = splitmix(m_seed ^ splitmix(_variant * m_axes.size() + a));
+        if (axis.range) {
+          double u = static_cast<double>(draw >> 11) / static_cast<double>(1ull << 53);
+          _values.push_back(number(axis.min + (axis.max - axis.min) * u, axis.integer));
+        } else {
+          _values.push_back(axis.values[draw % axis.values.size()]);
+        }
+      }
+      return;
+    }
+
+    // the last axis changes the fastest
+    _values.resize(m_axes.size());
+    for (size_t a = m_axes.size(); a-- > 0; ) {
+      const Axis& axis = m_axes[a];
+      _values[a] = axis.values[_variant % axis.values.size()];
+      _variant  /= axis.values.size();
+    }
+  }
+
+  //-------------------------------------------------------
+
+  bool GraphSweep::run(const GraphView& _view, const fs::path& _folder, const std::string& _stem, TaskPool& _pool, Stats& _stats, std::string& _error) {
+    auto start = std::chrono::steady_clock::now();
+    _stats = Stats();
+
+    for (const Axis& axis : m_axes) {
+      if (!m_file_names.empty() && (axis.range || axis.values.size() != 1)) {
+        _error = axis.name + " needs a single value besides a list of variants";
+        return false;
+      }
+      if (m_file_names.empty() && m_random == 0 && axis.range) {
+        _error = axis.name + "=min:max needs random draws, or min:max:count";
+        return false;
+      }
+    }
+
+    std::vector<std::string> swept = names();
+    std::vector<std::unique_ptr<Instance>> instances(_pool.workers());
+    auto instantiate = [&](size_t _worker) {
+      std::unique_ptr<Instance> instance(new Instance());
+      GraphLoader loader(_view);
+      loader.finish();
+      instance->graph = loader.graph();
+      if (instance->graph) {
+        for (const std::string& name : swept) {
+          instance->tweaks.push_back(instance->graph->tweaks(name));
+        }
+      }
+      instances[_worker] = std::move(instance);
+    };
+
+    // the first instance tells whether the tweaks exist, and which are integers
+    instantiate(0);
+    Instance& first = *instances[0];
+    if (!first.graph) {
+      _error = "no main graph";
+      return false;
+    }
+    for (size_t n = 0; n < swept.size(); ++n) {
+      if (first.tweaks[n].empty()) {
+        _error = "no tweak " + swept[n];
+        return false;
+      }
+    }
+    size_t offset = m_file_names.size();
+    for (size_t a = 0; a < m_axes.size(); ++a) {
+      m_axes[a].integer = true;
+      for (std::shared_ptr<ProcessorInput> tweak : first.tweaks[offset + a]) {
+        m_axes[a].integer = m_axes[a].integer && (tweak->type() == IOType::INTEGER || tweak->type() == IOType::LIST);
+      }
+      // evenly spaced numbers may fall between two integers
+      if (m_axes[a].integer) {
+        for (std::string& value : m_axes[a].values) {
+          double number_value = 0.0;
+          if (toNumber(value, number_value)) {
+            value = number(number_value, true);
+          }
+        }
+      }
+    }
+
+    std::error_code created;
+    fs::create_directories(_folder, created);
+
+    size_t total = count();
+    size_t width = std::to_string(total > 0 ? total - 1 : 0).size();
+    auto filename = [&](size_t _variant) {
+      std::string index = std::to_string(_variant);
+      return _folder / (_stem + "_" + std::string(width - index.size(), '0') + index + ".lua");
+    };
+
+    std::atomic<size_t> failed(0);
+    std::atomic<size_t> bytes(0);
+    std::atomic<size_t> folded(0);
+    std::atomic<size_t> deduplicated(0);
+    std::mutex          error_mutex;
+    std::string         first_error;
+    auto fail = [&](const std::string& _message) {
+      failed++;
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (first_error.empty()) {
+        first_error = _message;
+      }
+    };
+
+    _pool.run(total, [&](size_t _variant, size_t _worker) {
+      if (!instances[_worker]) {
+        instantiate(_worker);
+      }
+      Instance& instance = *instances[_worker];
+      values(_variant, instance.values);
+      for (size_t n = 0; n < swept.size(); ++n) {
+        for (std::shared_ptr<ProcessorInput> tweak : instance.tweaks[n]) {
+          if (!tweak->setValue(instance.values[n])) {
+            fail("variant " + std::to_string(_variant) + ": '" + instance.values[n] + "' is not a value of " + swept[n]);
+            return;
+          }
+        }
+      }
+      ExportOptions options = m_options;
+      if (options.fold_constants) {
+        instance.evaluator.update(*instance.graph);
+        options.evaluator = &instance.evaluator;
+      }
+      instance.writer.clear();
+      ExportStats exported = GraphExporter::write(*instance.graph, instance.writer, options);
+      folded       += exported.folded;
+      deduplicated += exported.deduplicated;
+      fs::path script = filename(_variant);
+      if (!instance.writer.save(script)) {
+        fail("cannot write " + script.string());
+        return;
+      }
+      bytes += instance.writer.size();
+    });
+
+    // the list of the variants, readable by loadVariants
+    std::ofstream list(_folder / (_stem + ".variants"));
+    for (size_t n = 0; n < swept.size(); ++n) {
+      list << (n > 0 ? " " : "") << swept[n];
+    }
+    list << "\n";
+    std::vector<std::string> row;
+    for (size_t v = 0; v < total; ++v) {
+      values(v, row);
+      for (size_t n = 0; n < row.size(); ++n) {
+        list << (n > 0 ? " " : "") << row[n];
+      }
+      list << "\n";
+    }
+
+    _stats.variants     = total;
+    _stats.failed       = failed;
+    _stats.bytes        = bytes;
+    _stats.instances    = static_cast<size_t>(std::count_if(instances.begin(), instances.end(), [](const std::unique_ptr<Instance>& _i) { return _i != nullptr; }));
+    _stats.folded       = folded;
+    _stats.deduplicated = deduplicated;
+    _stats.ms           = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!first_error.empty()) {
+      _error = first_error;
+      return false;
+    }
+    return true;
+  }
+}
@@ -0,0 +1,126 @@
+/** @file */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "GraphData.h"
+#include "GraphExporter.h"
+
+namespace chill {
+
+#ifdef WIN32
+namespace fs = std::experimental::filesystem;
+#else
+namespace fs = std::filesystem;
+#endif
+
+  class TaskPool;
+
+  /**
+   *  GraphSweep class.
+   *  Variants of a graph that differ by the values of some tweaks, exported as
+   *  one IceSL script each. The values come from a grid over the swept tweaks,
+   *  from random draws, or from a file listing the variants.
+   *  Each worker of the pool instantiates the graph once and reuses it for all
+   *  its variants, only the swept tweaks change between two exports; the node
+   *  signatures and sources are shared through NodeLibrary.
+   **/
+  class GraphSweep
+  {
+  public:
+    struct Stats {
+      size_t variants     = 0;
+      size_t failed       = 0;
+      size_t bytes        = 0;
+      size_t instances    = 0;
+      // nodes folded and deduplicated, over all the variants
+      size_t folded       = 0;
+      size_t deduplicated = 0;
+      double ms           = 0.0;
+    };
+
+    /**
+     *  Add a swept tweak.
+     *  @param _spec "name=v1;v2;v3" for a list of values, "name=min:max:count" for evenly
+     *               spaced numbers, "name=min:max" for numbers drawn at random, see setRandom().
+     *               The name is the one of ProcessingGraph::tweaks().
+     *  @param _error Why the specification is wrong.
+     *  @return false if it is wrong.
+     **/
+    bool addAxis(const std::string& _spec, std::string& _error);
+
+    /**
+     *  Read the variants from a file: the tweak names on the first line, then
+     *  one variant per line, the values separated by spaces or tabs.
+     *  The axes added besides must then have a single value, set in every variant.
+     *  @param _filename The file.
+     *  @param _error Why the file cannot be used.
+     *  @return false if it cannot be used.
+     **/
+    bool loadVariants(const fs::path& _filename, std::string& _error);
+
+    /**
+     *  Draw variants at random instead of going through the whole grid.
+     *  @param _count The number of variants.
+     *  @param _seed The seed, the same seed draws the same variants.
+     **/
+    void setRandom(size_t _count, uint64_t _seed);
+
+    /** How the scripts are written */
+    void setOptions(const ExportOptions& _options) {
+      m_options = _options;
+    }
+
+    /** The number of variants */
+    size_t count() const;
+
+    /** The swept tweaks, in the order of the values */
+    std::vector<std::string> names() const;
+
+    /**
+     *  Get the values of a variant.
+     *  @param _variant The variant, in [0, count()).
+     *  @param _values Receives one value per name.
+     **/
+    void values(size_t _variant, std::vector<std::string>& _values) const;
+
+    /**
+     *  Export all the variants of a graph, to <folder>/<stem>_<variant>.lua, and
+     *  list them in <folder>/<stem>.variants, in the format of loadVariants().
+     *  @param _view The graph description, see GraphData::capture.
+     *  @param _folder The folder of the scripts, created if needed.
+     *  @param _stem The start of the file names.
+     *  @param _pool The workers.
+     *  @param _stats Receives the figures of the sweep.
+     *  @param _error Why the sweep did not start, or the first variant that failed.
+     *  @return false if the sweep cannot run or a variant failed.
+     **/
+    bool run(const GraphView& _view, const fs::path& _folder, const std::string& _stem, TaskPool& _pool, Stats& _stats, std::string& _error);
+
+  private:
+    struct Axis {
+      std::string              name;
+      std::vector<std::string> values;
+      // "min:max", drawn at random
+      bool                     range   = false;
+      double                   min     = 0.0;
+      double                   max     = 0.0;
+      // all its tweaks are integers, the numbers are rounded
+      bool                     integer = false;
+    };
+
+    std::vector<Axis> m_axes;
+
+    size_t   m_random = 0;
+    uint64_t m_seed   = 0;
+
+    ExportOptions m_options;
+
+    // from loadVariants
+    std::vector<std::string>              m_file_names;
+    std::vector<std::vector<std::string>> m_file_rows;
+  };
+}
@@ -0,0 +1,56 @@
+#include "HeadlessUI.h"
+
+#include <cstdint>
+
+namespace chill {
+
+  HeadlessUI::HeadlessUI(const ImVec2& _size) {
+    m_previous = ImGui::GetCurrentContext();
+    m_context  = ImGui::CreateContext();
+    ImGui::SetCurrentContext(m_context);
+
+    ImGuiIO& io    = ImGui::GetIO();
+    io.DisplaySize = _size;
+    io.IniFilename = nullptr;
+
+    // the atlas has to be built before the first frame, the texture is never uploaded
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    io.Fonts->TexID = reinterpret_cast<ImTextureID>(static_cast<intptr_t>(1));
+  }
+
+  //-------------------------------------------------------
+
+  HeadlessUI::~HeadlessUI() {
+    ImGui::DestroyContext(m_context);
+    ImGui::SetCurrentContext(m_previous);
+  }
+
+  //-------------------------------------------------------
+
+  void HeadlessUI::newFrame(float _delta_time) {
+    ImGui::SetCurrentContext(m_context);
+    ImGui::GetIO().DeltaTime = _delta_time > 0.0F ? _delta_time : 1.0F / 60.0F;
+    ImGui::NewFrame();
+  }
+
+  //-------------------------------------------------------
+
+  HeadlessUI::DrawStats HeadlessUI::render() {
+    ImGui::Render();
+
+    DrawStats stats;
+    ImDrawData* data = ImGui::GetDrawData();
+    if (!data) {
+      return stats;
+    }
+    stats.lists    = data->CmdListsCount;
+    stats.vertices = data->TotalVtxCount;
+    stats.indices  = data->TotalIdxCount;
+    for (int i = 0; i < data->CmdListsCount; ++i) {
+      stats.commands += data->CmdLists[i]->CmdBuffer.Size;
+    }
+    return stats;
+  }
+}
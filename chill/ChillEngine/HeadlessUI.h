@@ -0,0 +1,54 @@
+/** @file */
+#pragma once
+
+#include "imgui/imgui.h"
+
+namespace chill {
+
+  /**
+   *  HeadlessUI class.
+   *  Runs ImGui frames without any window or GL backend: the draw data is
+   *  generated but never rendered. Used by the benchmarks and the replays.
+   **/
+  class HeadlessUI
+  {
+  public:
+    /** Size of the draw data generated by a frame */
+    struct DrawStats {
+      int lists    = 0;
+      int commands = 0;
+      int vertices = 0;
+      int indices  = 0;
+    };
+
+    /**
+     *  Create an ImGui context and build its font atlas.
+     *  @param _size The display size.
+     **/
+    HeadlessUI(const ImVec2& _size);
+
+    /**
+     *  Destroy the ImGui context.
+     **/
+    ~HeadlessUI();
+
+    HeadlessUI(const HeadlessUI&) = delete;
+    HeadlessUI& operator=(const HeadlessUI&) = delete;
+
+    /**
+     *  Start a frame.
+     *  @param _delta_time The time since the previous frame, in seconds.
+     **/
+    void newFrame(float _delta_time = 1.0F / 60.0F);
+
+    /**
+     *  End the frame and generate its draw data.
+     *  @return The size of the draw data.
+     **/
+    DrawStats render();
+
+  private:
+    ImGuiContext* m_context  = nullptr;
+    ImGuiContext* m_previous = nullptr;
+  };
+}
@@ -1,59 +1,116 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
-#include <sstream>
-
-// Search and remove whitespace from both ends of the string
-static std::string TrimEnumString(const std::string &_s)
-{
-  std::string::const_iterator it = _s.begin();
-  while (it != _s.end() && isspace(*it)) { it++; }
-  std::string::const_reverse_iterator rit = _s.rbegin();
-  while (rit.base() != it && isspace(*rit)) { rit++; }
-  return std::string(it, rit.base());
-}
 
-static void SplitEnumArgs(const char* _szArgs, std::string _Array[], int _nMax)
-{
-  std::stringstream ss(_szArgs);
-  std::string strSub;
-  int nIdx = 0;
-  while (ss.good() && (nIdx < _nMax)) {
-    getline(ss, strSub, ',');
-    _Array[nIdx] = TrimEnumString(strSub);
-    nIdx++;
-  }
-};
-// This will to define an enum that is wrapped in a namespace of the same name along with ToString(), FromString(), and COUNT
-#define DECLARE_ENUM(ename, ...) \
-    namespace ename { \
-        enum ename { __VA_ARGS__, COUNT }; \
-        static std::string _Strings[COUNT]; \
-        static const char* ToString(ename e) { \
-            if (_Strings[0].empty()) { SplitEnumArgs(#__VA_ARGS__, _Strings, COUNT); } \
-            return _Strings[e].c_str(); \
-        } \
-        static ename FromString(const std::string& strEnum) { \
-            if (_Strings[0].empty()) { SplitEnumArgs(#__VA_ARGS__, _Strings, COUNT); } \
-            for (int i = 0; i < COUNT; i++) { if (_Strings[i] == strEnum) { return static_cast<ename>(i); } } \
-            return static_cast<ename>(0); \
-        } \
+/**
+ *  Registry of the IO types, the only place where a type is declared.
+ *  X(type, input class, output class, red, green, blue, converts to)
+ *  - the classes are the prefixes of the ProcessorInput and ProcessorOutput
+ *    implementations in IOs.h (Bool -> BoolInput, BoolOutput),
+ *  - the color is the one of the sockets and pipes,
+ *  - converts to lists the input types an output of this type may be linked to,
+ *    besides its own type and UNDEF.
+ *  The order gives the values of the enum.
+ **/
+#define CHILL_IO_TYPES(X)                                              \
+  X(UNDEF,    Undef,    Undef,    255, 255, 255, 0)                    \
+  X(BOOLEAN,  Bool,     Bool,     146, 0,   0,   0)                    \
+  X(IMPLICIT, Implicit, Implicit, 255, 255, 255, 0)                    \
+  X(INTEGER,  Int,      Int,      182, 109, 255, 0)                    \
+  X(LIST,     List,     Undef,    182, 109, 255, 0)                    \
+  X(PATH,     Path,     Path,     109, 182, 255, 0)                    \
+  X(REAL,     Real,     Real,     182, 109, 255, 0)                    \
+  X(STRING,   String,   String,   109, 182, 255, bit(PATH))            \
+  X(SHAPE,    Shape,    Shape,    36,  255, 36,  0)                    \
+  X(FIELD,    Undef,    Undef,    255, 255, 255, 0)                    \
+  X(VEC3,     Vec3,     Vec3,     219, 209, 0,   bit(REAL))            \
+  X(VEC4,     Vec4,     Vec4,     255, 255, 109, bit(VEC3) | bit(REAL))
+
+namespace IOType {
+
+#define CHILL_IO_ENUM(type, input, output, r, g, b, converts) type,
+  enum IOType { CHILL_IO_TYPES(CHILL_IO_ENUM) COUNT };
+#undef CHILL_IO_ENUM
+
+  constexpr uint32_t bit(IOType _type) {
+    return 1u << _type;
+  }
+
+  /** What the registry knows about a type */
+  struct Traits {
+    const char* name;
+    uint8_t     r, g, b;
+    uint32_t    converts;
+  };
+
+#define CHILL_IO_TRAITS(type, input, output, r, g, b, converts) { #type, r, g, b, converts },
+  constexpr Traits c_traits[COUNT] = { CHILL_IO_TYPES(CHILL_IO_TRAITS) };
+#undef CHILL_IO_TRAITS
+
+  constexpr const Traits& traits(IOType _type) {
+    return c_traits[_type];
+  }
+
+  inline const char* ToString(IOType _type) {
+    return (_type >= 0 && _type < COUNT) ? c_traits[_type].name : c_traits[UNDEF].name;
+  }
+
+  //-------------------------------------------------------
+
+  // Name lookup: open addressing over a table twice as large as needed,
+  // filled at compile time. A name is found in one or two probes.
+
+  constexpr uint32_t hashName(const char* _name, size_t _size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < _size; ++i) {
+      hash = (hash ^ static_cast<unsigned char>(_name[i])) * 16777619u;
     }
+    return hash;
+  }
 
-DECLARE_ENUM(IOType, UNDEF, BOOLEAN, IMPLICIT, INTEGER, LIST, PATH, REAL, STRING, SHAPE, FIELD, VEC3, VEC4)
+  constexpr size_t nameLength(const char* _name) {
+    size_t size = 0;
+    while (_name[size] != '\0') size++;
+    return size;
+  }
 
-namespace IOType {
-  static bool isCompatible(IOType _typeOutput, IOType _typeInput) {
-    if (_typeOutput == _typeInput)
-      return true;
-    if (_typeOutput == IOType::UNDEF || _typeInput == IOType::UNDEF)
-      return true;
-    if (_typeOutput == IOType::VEC4 && (_typeInput == IOType::VEC3 || _typeInput == IOType::REAL))
-      return true;
-    if (_typeOutput == IOType::VEC3 && _typeInput == IOType::REAL)
-      return true;
-    if (_typeOutput == IOType::STRING && _typeInput == IOType::PATH)
-      return true;
-    return false;
+  constexpr size_t c_buckets = 32;
+  static_assert(c_buckets >= 2 * COUNT, "too many IO types for the name table");
+
+  constexpr std::array<int8_t, c_buckets> buildNameTable() {
+    std::array<int8_t, c_buckets> table = {};
+    for (size_t b = 0; b < c_buckets; ++b) table[b] = -1;
+    for (int t = 0; t < COUNT; ++t) {
+      size_t b = hashName(c_traits[t].name, nameLength(c_traits[t].name)) % c_buckets;
+      while (table[b] >= 0) b = (b + 1) % c_buckets;
+      table[b] = static_cast<int8_t>(t);
+    }
+    return table;
+  }
+
+  constexpr std::array<int8_t, c_buckets> c_names = buildNameTable();
+
+  /**
+   *  Get a type from its name.
+   *  @param _name The name, as in the node files ("REAL", "SHAPE", ...).
+   *  @return The type, UNDEF if the name is unknown.
+   **/
+  inline IOType FromString(const std::string& _name) {
+    for (size_t b = hashName(_name.data(), _name.size()) % c_buckets; c_names[b] >= 0; b = (b + 1) % c_buckets) {
+      if (_name == c_traits[c_names[b]].name) {
+        return static_cast<IOType>(c_names[b]);
+      }
+    }
+    return UNDEF;
+  }
+
+  //-------------------------------------------------------
+
+  constexpr bool isCompatible(IOType _typeOutput, IOType _typeInput) {
+    return _typeOutput == _typeInput
+      || _typeOutput == UNDEF || _typeInput == UNDEF
+      || (c_traits[_typeOutput].converts & bit(_typeInput)) != 0;
   }
 }
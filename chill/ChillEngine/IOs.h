@@ -3,19 +3,18 @@
 
 #include <regex>
 
-#include "imgui/imgui.h"
+#include "CoreTypes.h"
 
 #include "UI.h"
 #include "IOTypes.h"
+#include "LuaWriter.h"
+#include "GraphData.h"
 
-// COLOR BLIND FRIENDLY PALETTE
-static ImColor color_undef (255, 255, 255);
-static ImColor color_bool  (146, 0  , 0  );
-static ImColor color_number(182, 109, 255);
-static ImColor color_string(109, 182, 255);
-static ImColor color_shape (36 , 255, 36 );
-static ImColor color_vec4  (255, 255, 109);
-static ImColor color_vec3  (219, 209, 0  );
+// COLOR BLIND FRIENDLY PALETTE, see CHILL_IO_TYPES
+inline chill::Color typeColor(IOType::IOType _type) {
+  const IOType::Traits& traits = IOType::traits(_type);
+  return chill::Color(traits.r, traits.g, traits.b);
+}
 
 // -----------------------------------------------------
 
@@ -68,13 +67,13 @@ class IO : public UI {
 
     //-------------------------------------------------------
 
-    inline ImU32 color() {
+    inline Color color() {
       return m_color;
     }
 
     //-------------------------------------------------------
 
-    void setColor(ImU32 color) {
+    void setColor(Color color) {
       m_color = color;
     }
 
@@ -88,7 +87,7 @@ class IO : public UI {
     /** Expected data type. */
     IOType::IOType m_type;
     /** Display color. */
-    ImU32          m_color;
+    Color          m_color;
 }; // class IO
 
 //-------------------------------------------------------
@@ -123,15 +122,9 @@ class ProcessorOutput : public IO {
 
     //-------------------------------------------------------
 
-    bool draw();
-
-    //-------------------------------------------------------
-
-    virtual void save(std::ofstream& _stream) {
-      _stream << "o_" << getUniqueID() << " = Output({" <<
-                 "name = '" << name() << "', " <<
-                 "type = '" << IOType::ToString(type()) << "'" <<
-                 "})" << std::endl;
+    virtual void save(LuaWriter& _writer) {
+      _writer << "o_" << getUniqueID() << " = Output({name = ";
+      _writer.quoted(name()) << ", type = '" << IOType::ToString(type()) << "'})\n";
     }
 
     //-------------------------------------------------------
@@ -140,6 +133,8 @@ class ProcessorOutput : public IO {
     std::vector<std::shared_ptr<ProcessorInput>> m_links;
     /** contains emitable data */
     bool m_emitable = false;
+    /** value computed in Chill and shown next to the socket, empty if unknown, see ScalarEvaluator */
+    std::string m_value;
 }; // class ProcessorOutput
 
 //-------------------------------------------------------
@@ -163,24 +158,79 @@ class ProcessorInput : public IO {
 
     //-------------------------------------------------------
 
-    bool draw();
+    virtual void save(LuaWriter& _writer) {
+      saveBegin(_writer);
+      saveEnd(_writer);
+    }
 
     //-------------------------------------------------------
 
-    virtual bool drawTweak() = 0;
+    /**
+     *  Write the current value as a Lua expression, as used by the IceSL export.
+     *  @param _writer The writer.
+     **/
+    virtual void luaValue(LuaWriter& _writer) {
+      _writer << '0';
+    }
+
+    /**
+     *  Get the current value as a Lua expression.
+     *  @return The expression.
+     **/
+    std::string getLuaValue();
+
+    /** Whether the value can be set in IceSL instead, see uiTweak */
+    virtual bool hasUiTweak() {
+      return false;
+    }
+
+    /**
+     *  Write the call declaring an IceSL tweak that starts at the current value, as used by
+     *  the IceSL export when the value is set in IceSL. Without one, writes the value.
+     *  @param _writer The writer.
+     *  @param _label The name of the tweak in IceSL.
+     **/
+    virtual void uiTweak(LuaWriter& _writer, const std::string&) {
+      luaValue(_writer);
+    }
+
+    /**
+     *  Write the current value to a port of a graph description.
+     *  @param _port The port, its type and name are already set.
+     *  @param _text Receives the value of the text inputs.
+     **/
+    virtual void store(GraphData::Port&, std::string&) {}
+
+    /**
+     *  Restore the value written by store().
+     *  @param _port The port.
+     *  @param _text The text value.
+     **/
+    virtual void load(const GraphData::Port&, std::string_view) {}
+
+    /**
+     *  Set the value from text, as given on a command line: a number, true or false,
+     *  comma separated numbers for the vectors, or the text itself. The value is
+     *  clamped to the range of the input.
+     *  @param _text The value.
+     *  @return false if the text is not a value of this type.
+     **/
+    bool setValue(std::string_view _text);
 
     //-------------------------------------------------------
 
-    virtual void save(std::ofstream& _stream) {
-      _stream << "i_" << getUniqueID() << " = Input({" <<
-                 "name = '" << name() << "', " <<
-                 "type = '" << IOType::ToString(type()) << "'" <<
-                 "})" << std::endl;
+  protected:
+    /** Start an "i_<id> = Input({name = ..., type = ..." line, the fields of the input follow */
+    void saveBegin(LuaWriter& _writer) {
+      _writer << "i_" << getUniqueID() << " = Input({name = ";
+      _writer.quoted(name()) << ", type = '" << IOType::ToString(type()) << "'";
     }
 
-    //-------------------------------------------------------
+    void saveEnd(LuaWriter& _writer) {
+      _writer << "})\n";
+    }
 
-    virtual std::string getLuaValue();
+  public:
 
     //-------------------------------------------------------
 
@@ -200,7 +250,7 @@ class UndefInput : public ProcessorInput
   public:
     UndefInput() {
       setType(IOType::UNDEF);
-      setColor(color_undef);
+      setColor(typeColor(type()));
     }
 
     //-------------------------------------------------------
@@ -218,10 +268,6 @@ class UndefInput : public ProcessorInput
     // For compatibility (shouldn't be called)
     template <typename ...>
     UndefInput(...) : UndefInput() {}
-
-    //-------------------------------------------------------
-
-    bool drawTweak();
 };
 
 //-------------------------------------------------------
@@ -240,7 +286,7 @@ class UndefOutput : public ProcessorOutput
 
     UndefOutput() {
       setType(IOType::UNDEF);
-      setColor(color_undef);
+      setColor(typeColor(type()));
     }
 };
 
@@ -252,7 +298,7 @@ class ImplicitInput : public ProcessorInput
 public:
   ImplicitInput() {
     setType(IOType::IMPLICIT);
-    setColor(color_undef);
+    setColor(typeColor(type()));
   }
 
   //-------------------------------------------------------
@@ -274,10 +320,6 @@ public:
   // For compatibility (shouldn't be called)
   template <typename ...>
   ImplicitInput(...) : ImplicitInput() {}
-
-  //-------------------------------------------------------
-
-  bool drawTweak();
 };
 
 //-------------------------------------------------------
@@ -296,7 +338,7 @@ public:
 
   ImplicitOutput() {
     setType(IOType::IMPLICIT);
-    setColor(color_undef);
+    setColor(typeColor(type()));
   }
 };
 
@@ -308,7 +350,7 @@ class BoolInput : public ProcessorInput
   public:
     BoolInput() {
       setType (IOType::BOOLEAN);
-      setColor(color_bool);
+      setColor(typeColor(type()));
     }
 
     //-------------------------------------------------------
@@ -339,18 +381,35 @@ class BoolInput : public ProcessorInput
       return input;
     }
 
-    bool drawTweak();
+    void save(LuaWriter& _writer) {
+      saveBegin(_writer);
+      _writer << ", value = ";
+      _writer.boolean(m_value);
+      saveEnd(_writer);
+    }
+
+    void luaValue(LuaWriter& _writer) {
+      _writer.boolean(m_value);
+    }
 
-    void save(std::ofstream& _stream) {
-      _stream << "i_" << getUniqueID() << " = Input({" <<
-                 "name = '" << name() << "', " <<
-                 "type = '" << IOType::ToString(type()) << "', " <<
-                 "value = " << (m_value ? "true" : "false") <<
-                 "})" << std::endl;
+    bool hasUiTweak() {
+      return true;
     }
 
-    std::string getLuaValue() {
-      return (m_value ? "true" : "false");
+    void uiTweak(LuaWriter& _writer, const std::string& _label) {
+      _writer << "ui_bool(";
+      _writer.quoted(_label) << ", ";
+      _writer.boolean(m_value) << ")";
+    }
+
+    //-------------------------------------------------------
+
+    void store(GraphData::Port& _port, std::string&) {
+      _port.integer[0] = m_value ? 1 : 0;
+    }
+
+    void load(const GraphData::Port& _port, std::string_view) {
+      m_value = _port.integer[0] != 0;
     }
 
     bool m_value;
@@ -364,7 +423,7 @@ class BoolOutput : public ProcessorOutput {
     BoolOutput()
     {
       setType (IOType::BOOLEAN);
-      setColor(color_bool);
+      setColor(typeColor(type()));
     }
 
     //-------------------------------------------------------
@@ -384,7 +443,7 @@ class IntInput : public ProcessorInput {
   public:
     IntInput() {
       setType(IOType::INTEGER);
-      setColor(color_number);
+      setColor(typeColor(type()));
     }
 
     //-------------------------------------------------------
@@ -444,26 +503,50 @@ class IntInput : public ProcessorInput {
 
     //-------------------------------------------------------
 
-    bool drawTweak();
+    void save(LuaWriter& _writer) {
+      saveBegin(_writer);
+      _writer << ", value = " << m_value;
+      if (m_min != min()) _writer << ", min = " << m_min;
+      if (m_max != max()) _writer << ", max = " << m_max;
+      if (m_alt)          _writer << ", alt = true";
+      _writer << ", step = " << m_step;
+      saveEnd(_writer);
+    }
 
     //-------------------------------------------------------
 
-    void save(std::ofstream& _stream) {
-      _stream << "i_" << getUniqueID() << " = Input({" <<
-                 "name = '" << name() << "'" <<
-                 ", type = '" << IOType::ToString(type()) << "'" <<
-                 ", value = " << m_value <<
-                 (m_min != min() ? ", min = " + std::to_string(m_min) : "") <<
-                 (m_max != max() ? ", max = " + std::to_string(m_max) : "") <<
-                 (m_alt ? ", alt = true" : "") <<
-                 ", step = " + std::to_string(m_step) <<
-                 "})" << std::endl;
+    void luaValue(LuaWriter& _writer) {
+      _writer << m_value;
+    }
+
+    bool hasUiTweak() {
+      return true;
+    }
+
+    void uiTweak(LuaWriter& _writer, const std::string& _label) {
+      // an unbounded slider is of no use: a hundred steps around the value
+      int64_t low  = m_min != min() ? m_min : int64_t(m_value) - 100 * m_step;
+      int64_t high = m_max != max() ? m_max : int64_t(m_value) + 100 * m_step;
+      _writer << "ui_number(";
+      _writer.quoted(_label) << ", " << m_value << ", " << low << ", " << high << ")";
     }
 
     //-------------------------------------------------------
 
-    inline std::string getLuaValue() {
-      return std::to_string(m_value);
+    void store(GraphData::Port& _port, std::string&) {
+      _port.integer[0] = m_value;
+      _port.integer[1] = m_min;
+      _port.integer[2] = m_max;
+      _port.integer[3] = m_step;
+      if (m_alt) _port.flags |= GraphData::ALT;
+    }
+
+    void load(const GraphData::Port& _port, std::string_view) {
+      m_min   = _port.integer[1];
+      m_max   = _port.integer[2];
+      m_step  = _port.integer[3];
+      m_alt   = (_port.flags & GraphData::ALT) != 0;
+      m_value = std::min(m_max, std::max(m_min, static_cast<int>(_port.integer[0])));
     }
 
     //-------------------------------------------------------
@@ -488,7 +571,7 @@ class IntOutput : public ProcessorOutput
   public:
     IntOutput() {
       setType (IOType::INTEGER);
-      setColor(color_number);
+      setColor(typeColor(type()));
     }
 
     //-------------------------------------------------------
@@ -508,7 +591,7 @@ class ListInput : public ProcessorInput {
   public:
     ListInput() {
       setType(IOType::INTEGER);
-      setColor(color_number);
+      setColor(typeColor(type()));
     }
 
     //-------------------------------------------------------
@@ -558,20 +641,25 @@ class ListInput : public ProcessorInput {
 
     //-------------------------------------------------------
 
-    bool drawTweak();
+    void save(LuaWriter& _writer) {
+      saveBegin(_writer);
+      _writer << ", value = " << m_value;
+      saveEnd(_writer);
+    }
+
+    void luaValue(LuaWriter& _writer) {
+      _writer << m_value;
+    }
 
     //-------------------------------------------------------
 
-    void save(std::ofstream& _stream) {
-      _stream << "i_" << getUniqueID() << " = Input({" <<
-                 "name = '" << name() << "'" <<
-                 ", type = '" << IOType::ToString(type()) << "'" <<
-                 ", value = " << m_value <<
-                 "})" << std::endl;
+    void store(GraphData::Port& _port, std::string&) {
+      _port.integer[0] = m_value;
     }
 
-    std::string getLuaValue() {
-      return std::to_string(m_value);
+    // the choices come from the node file, only the selection is saved
+    void load(const GraphData::Port& _port, std::string_view) {
+      m_value = std::min(m_max, std::max(m_min, static_cast<int>(_port.integer[0])));
     }
 
     //-------------------------------------------------------
@@ -597,7 +685,7 @@ class PathInput : public ProcessorInput {
 
     PathInput() {
       setType(IOType::STRING);
-      setColor(color_string);
+      setColor(typeColor(type()));
     }
 
     //-------------------------------------------------------
@@ -663,26 +751,30 @@ class PathInput : public ProcessorInput {
 
     //-------------------------------------------------------
 
-    bool drawTweak();
+    void save(LuaWriter& _writer) {
+      saveBegin(_writer);
+      _writer << ", value = ";
+      _writer.quoted(m_value);
+      if (m_alt) _writer << ", alt = true";
+      saveEnd(_writer);
+    }
 
     //-------------------------------------------------------
 
-    void save(std::ofstream& _stream) {
-      _stream << "i_" << getUniqueID() << " = Input({" <<
-                 "name = '" << name() << "', " <<
-                 "type = '" << IOType::ToString(type()) << "', " <<
-                 "value = '" << m_value << "'" <<
-                 (m_alt ? ", alt = true" : "") <<
-                 "})" << std::endl;
+    void luaValue(LuaWriter& _writer) {
+      _writer.quoted(m_value);
     }
 
     //-------------------------------------------------------
 
-    std::string getLuaValue() {
-      std::regex escaped_chars("([\\[\\]\\{\\}\\\"\\\'])");
-      std::string escaped;
-      regex_replace(std::back_inserter(escaped), m_value.begin(), m_value.end(), escaped_chars, "\\$1");
-      return "'" + escaped + "'";
+    void store(GraphData::Port& _port, std::string& _text) {
+      _text = m_value;
+      if (m_alt) _port.flags |= GraphData::ALT;
+    }
+
+    void load(const GraphData::Port& _port, std::string_view _text) {
+      m_value = std::string(_text);
+      m_alt   = (_port.flags & GraphData::ALT) != 0;
     }
 
     //-------------------------------------------------------
@@ -698,7 +790,7 @@ class PathOutput : public ProcessorOutput {
   public:
     PathOutput() {
       setType(IOType::STRING);
-      setColor(color_string);
+      setColor(typeColor(type()));
     }
 
     // -----------------------------------------------------
@@ -718,7 +810,7 @@ class RealInput : public ProcessorInput {
   public:
     RealInput() {
       setType (IOType::REAL);
-      setColor(color_number);
+      setColor(typeColor(type()));
     }
 
     // -----------------------------------------------------
@@ -779,26 +871,50 @@ class RealInput : public ProcessorInput {
 
     // -----------------------------------------------------
 
-    bool drawTweak();
+    void save(LuaWriter& _writer) {
+      saveBegin(_writer);
+      _writer << ", value = " << m_value;
+      if (m_min != min())   _writer << ", min = " << m_min;
+      if (m_max != max())   _writer << ", max = " << m_max;
+      if (m_alt)            _writer << ", alt = true";
+      if (m_step != step()) _writer << ", step = " << m_step;
+      saveEnd(_writer);
+    }
 
     // -----------------------------------------------------
 
-    void save(std::ofstream& _stream) {
-      _stream << "i_" << getUniqueID() << " = Input({" <<
-                 "name = '" << name() << "'" <<
-                 ", type = '" << IOType::ToString(type()) << "'" <<
-                 ", value = " << m_value <<
-                 (m_min != min() ? ", min = " + std::to_string(m_min) : "") <<
-                 (m_max != max() ? ", max = " + std::to_string(m_max) : "") <<
-                 (m_alt ? ", alt = true" : "") <<
-                 (m_step != step() ? ", step = " + std::to_string(m_step) : "") <<
-                 "})" << std::endl;
+    void luaValue(LuaWriter& _writer) {
+      _writer << m_value;
+    }
+
+    bool hasUiTweak() {
+      return true;
+    }
+
+    void uiTweak(LuaWriter& _writer, const std::string& _label) {
+      // an unbounded slider is of no use: a hundred steps around the value
+      float low  = m_min != min() ? m_min : m_value - 100.0f * m_step;
+      float high = m_max != max() ? m_max : m_value + 100.0f * m_step;
+      _writer << "ui_scalar(";
+      _writer.quoted(_label) << ", " << m_value << ", " << low << ", " << high << ")";
     }
 
     // -----------------------------------------------------
 
-    std::string getLuaValue() {
-      return std::to_string(m_value);
+    void store(GraphData::Port& _port, std::string&) {
+      _port.real[0] = m_value;
+      _port.real[4] = m_min;
+      _port.real[5] = m_max;
+      _port.real[6] = m_step;
+      if (m_alt) _port.flags |= GraphData::ALT;
+    }
+
+    void load(const GraphData::Port& _port, std::string_view) {
+      m_min   = _port.real[4];
+      m_max   = _port.real[5];
+      m_step  = _port.real[6];
+      m_alt   = (_port.flags & GraphData::ALT) != 0;
+      m_value = std::min(m_max, std::max(m_min, _port.real[0]));
     }
 
     // -----------------------------------------------------
@@ -824,7 +940,7 @@ class RealOutput : public ProcessorOutput
   public:
     RealOutput() {
       setType (IOType::REAL);
-      setColor(color_number);
+      setColor(typeColor(type()));
     }
 
     // -----------------------------------------------------
@@ -845,7 +961,7 @@ class StringInput : public ProcessorInput
   public:
     StringInput() {
       setType (IOType::STRING);
-      setColor(color_string);
+      setColor(typeColor(type()));
     }
 
     // -----------------------------------------------------
@@ -894,26 +1010,30 @@ class StringInput : public ProcessorInput
 
     // -----------------------------------------------------
 
-    bool drawTweak();
+    void save(LuaWriter& _writer) {
+      saveBegin(_writer);
+      _writer << ", value = ";
+      _writer.quoted(m_value);
+      if (m_alt) _writer << ", alt = true";
+      saveEnd(_writer);
+    }
 
     // -----------------------------------------------------
 
-    void save(std::ofstream& _stream) {
-      _stream << "i_" << getUniqueID() << " = Input({" <<
-                 "name = '" << name() << "', " <<
-                 "type = '" << IOType::ToString(type()) << "', " <<
-                 "value = '" << m_value << "'" <<
-                 (m_alt ? ", alt = true" : "") <<
-                 "})" << std::endl;
+    void luaValue(LuaWriter& _writer) {
+      _writer.quoted(m_value);
     }
 
     // -----------------------------------------------------
 
-    std::string getLuaValue() {
-      std::regex escaped_chars("([\\[\\]\\{\\}\\\"\\\'])");
-      std::string escaped;
-      regex_replace(std::back_inserter(escaped), m_value.begin(), m_value.end(), escaped_chars, "\\$1");
-      return "'" + escaped + "'";
+    void store(GraphData::Port& _port, std::string& _text) {
+      _text = m_value;
+      if (m_alt) _port.flags |= GraphData::ALT;
+    }
+
+    void load(const GraphData::Port& _port, std::string_view _text) {
+      m_value = std::string(_text);
+      m_alt   = (_port.flags & GraphData::ALT) != 0;
     }
 
     // -----------------------------------------------------
@@ -929,7 +1049,7 @@ class StringOutput : public ProcessorOutput
   public:
     StringOutput() {
       setType (IOType::STRING);
-      setColor(color_string);
+      setColor(typeColor(type()));
     }
 
     // -----------------------------------------------------
@@ -949,7 +1069,7 @@ class ShapeInput : public ProcessorInput {
   public:
     ShapeInput() {
       setType(IOType::SHAPE);
-      setColor(color_shape);
+      setColor(typeColor(type()));
     }
 
     // -----------------------------------------------------
@@ -966,10 +1086,6 @@ class ShapeInput : public ProcessorInput {
 
     // -----------------------------------------------------
 
-    bool drawTweak();
-
-    // -----------------------------------------------------
-
     std::shared_ptr<ProcessorInput> clone() {
       std::shared_ptr<ProcessorInput> input = std::shared_ptr<ProcessorInput>(new ShapeInput());
       input->setName (name());
@@ -980,17 +1096,15 @@ class ShapeInput : public ProcessorInput {
 
     // -----------------------------------------------------
 
-    void save(std::ofstream& _stream) {
-      _stream << "i_" << getUniqueID() << " = Input({" <<
-                 "name = '" << name() << "'" <<
-                 ", type = '" << IOType::ToString(type()) << "'" <<
-                 "})" << std::endl;
+    void save(LuaWriter& _writer) {
+      saveBegin(_writer);
+      saveEnd(_writer);
     }
 
     // -----------------------------------------------------
 
-    std::string getLuaValue() {
-      return "Void";
+    void luaValue(LuaWriter& _writer) {
+      _writer << "Void";
     }
 };
 
@@ -1000,7 +1114,7 @@ class ShapeOutput : public ProcessorOutput {
   public:
     ShapeOutput() {
       setType (IOType::SHAPE);
-      setColor(color_shape);
+      setColor(typeColor(type()));
     }
 
     // -----------------------------------------------------
@@ -1020,7 +1134,7 @@ class Vec4Input : public ProcessorInput {
   public:
     Vec4Input() {
       setType (IOType::VEC4);
-      setColor(color_vec4);
+      setColor(typeColor(type()));
     }
 
     // -----------------------------------------------------
@@ -1090,31 +1204,43 @@ class Vec4Input : public ProcessorInput {
 
     // -----------------------------------------------------
 
-    bool drawTweak();
+    void save(LuaWriter& _writer) {
+      saveBegin(_writer);
+      _writer << ", value = ";
+      luaValue(_writer);
+      if (m_min != min())   _writer << ", min = " << m_min;
+      if (m_max != max())   _writer << ", max = " << m_max;
+      if (m_alt)            _writer << ", alt = true";
+      if (m_step != step()) _writer << ", step = " << m_step;
+      saveEnd(_writer);
+    }
 
     // -----------------------------------------------------
 
-    void save(std::ofstream& _stream) {
-      _stream << "i_" << getUniqueID() << " = Input({" <<
-                 "name = '" << name() << "'" <<
-                 ", type = '" << IOType::ToString(type()) << "'" <<
-                 ", value = {" << m_value[0] << ", " << m_value[1] << ", " << m_value[2] << ", " << m_value[3] << "}" <<
-                 (m_min != min() ? ", min = " + std::to_string(m_min) : "") <<
-                 (m_max != max() ? ", max = " + std::to_string(m_max) : "") <<
-                 (m_alt ? ", alt = true" : "") <<
-                 (m_step != step() ? ", step = " + std::to_string(m_step) : "") <<
-                 "})" << std::endl;
+    void luaValue(LuaWriter& _writer) {
+      _writer << '{' << m_value[0] << ", " << m_value[1] << ", " << m_value[2] << ", " << m_value[3] << '}';
     }
 
     // -----------------------------------------------------
 
-    std::string getLuaValue() {
-      std::string s = "{"
-          + std::to_string(m_value[0]) + ", "
-          + std::to_string(m_value[1]) + ", "
-          + std::to_string(m_value[2]) + ", "
-          + std::to_string(m_value[3]) + "}";
-      return s;
+    void store(GraphData::Port& _port, std::string&) {
+      for (int i = 0; i < 4; ++i) {
+        _port.real[i] = m_value[i];
+      }
+      _port.real[4] = m_min;
+      _port.real[5] = m_max;
+      _port.real[6] = m_step;
+      if (m_alt) _port.flags |= GraphData::ALT;
+    }
+
+    void load(const GraphData::Port& _port, std::string_view) {
+      m_min  = _port.real[4];
+      m_max  = _port.real[5];
+      m_step = _port.real[6];
+      m_alt  = (_port.flags & GraphData::ALT) != 0;
+      for (int i = 0; i < 4; ++i) {
+        m_value[i] = std::min(m_max, std::max(m_min, _port.real[i]));
+      }
     }
 
     // -----------------------------------------------------
@@ -1139,7 +1265,7 @@ class Vec4Output : public ProcessorOutput
   public:
     Vec4Output() {
       setType (IOType::VEC4);
-      setColor(color_vec4);
+      setColor(typeColor(type()));
     }
 
     // -----------------------------------------------------
@@ -1160,7 +1286,7 @@ class Vec3Input : public ProcessorInput
   public:
     Vec3Input() {
       setType (IOType::VEC3);
-      setColor(color_vec3);
+      setColor(typeColor(type()));
     }
 
     // -----------------------------------------------------
@@ -1224,29 +1350,39 @@ class Vec3Input : public ProcessorInput
 
     // -----------------------------------------------------
 
-    bool drawTweak();
+    void save(LuaWriter& _writer) {
+      saveBegin(_writer);
+      _writer << ", value = {" << m_value[0] << "," << m_value[1] << "," << m_value[2] << '}';
+      if (m_min != min())   _writer << ", min = " << m_min;
+      if (m_max != max())   _writer << ", max = " << m_max;
+      if (m_step != step()) _writer << ", step = " << m_step;
+      saveEnd(_writer);
+    }
 
     // -----------------------------------------------------
 
-    void save(std::ofstream& _stream) {
-      _stream << "i_" << getUniqueID() << " = Input({" <<
-                 "name = '" << name() << "'" <<
-                 ", type = '" << IOType::ToString(type()) << "'" <<
-                 ", value = {" << m_value[0] << "," << m_value[1] << "," << m_value[2] << "}" <<
-                 (m_min != min() ? ", min = " + std::to_string(m_min) : "") <<
-                 (m_max != max() ? ", max = " + std::to_string(m_max) : "") <<
-                 (m_step != step() ? ", step = " + std::to_string(m_step) : "") <<
-                 "})" << std::endl;
+    void luaValue(LuaWriter& _writer) {
+      _writer << "v(" << m_value[0] << ", " << m_value[1] << ", " << m_value[2] << ')';
     }
 
     // -----------------------------------------------------
 
-    std::string getLuaValue() {
-      std::string s = "v("
-          + std::to_string(m_value[0]) + ", "
-          + std::to_string(m_value[1]) + ", "
-          + std::to_string(m_value[2]) + ")";
-      return s;
+    void store(GraphData::Port& _port, std::string&) {
+      for (int i = 0; i < 3; ++i) {
+        _port.real[i] = m_value[i];
+      }
+      _port.real[4] = m_min;
+      _port.real[5] = m_max;
+      _port.real[6] = m_step;
+    }
+
+    void load(const GraphData::Port& _port, std::string_view) {
+      m_min  = _port.real[4];
+      m_max  = _port.real[5];
+      m_step = _port.real[6];
+      for (int i = 0; i < 3; ++i) {
+        m_value[i] = std::min(m_max, std::max(m_min, _port.real[i]));
+      }
     }
 
     // -----------------------------------------------------
@@ -1268,7 +1404,7 @@ class Vec3Output : public ProcessorOutput
   public:
     Vec3Output() {
       setType (IOType::VEC3);
-      setColor(color_vec3);
+      setColor(typeColor(type()));
     }
 
     // -----------------------------------------------------
@@ -1287,37 +1423,12 @@ template <typename ... Args>
 std::shared_ptr<ProcessorInput> ProcessorInput::create(const std::string& _name, IOType::IOType _type, Args&& ... _args) {
   std::shared_ptr<ProcessorInput> input;
   switch (_type) {
-  case IOType::BOOLEAN:
-    input = std::shared_ptr<ProcessorInput>(new BoolInput(_args...));
-    break;
-  case IOType::INTEGER:
-    input = std::shared_ptr<ProcessorInput>(new IntInput(_args...));
-    break;
-  case IOType::IMPLICIT:
-    input = std::shared_ptr<ProcessorInput>(new ImplicitInput(_args...));
-    break;
-  case IOType::LIST:
-    input = std::shared_ptr<ProcessorInput>(new ListInput(_args...));
-    break;
-  case IOType::PATH:
-    input = std::shared_ptr<ProcessorInput>(new PathInput(_args...));
-    break;
-  case IOType::REAL:
-    input = std::shared_ptr<ProcessorInput>(new RealInput(_args...));
-    break;
-  case IOType::SHAPE:
-    input = std::shared_ptr<ProcessorInput>(new ShapeInput(_args...));
-    break;
-  case IOType::STRING:
-    input = std::shared_ptr<ProcessorInput>(new StringInput(_args...));
-    break;
-  case IOType::VEC3:
-    input = std::shared_ptr<ProcessorInput>(new Vec3Input(_args...));
-    break;
-  case IOType::VEC4:
-    input = std::shared_ptr<ProcessorInput>(new Vec4Input(_args...));
+#define CHILL_IO_CREATE_INPUT(type, in, out, r, g, b, converts) \
+  case IOType::type: \
+    input = std::shared_ptr<ProcessorInput>(new in##Input(_args...)); \
     break;
-  case IOType::UNDEF:
+  CHILL_IO_TYPES(CHILL_IO_CREATE_INPUT)
+#undef CHILL_IO_CREATE_INPUT
   default:
     input = std::shared_ptr<ProcessorInput>(new UndefInput());
     break;
@@ -0,0 +1,36 @@
+/** @file */
+#pragma once
+
+#include "imgui/imgui.h"
+#define IMGUI_DEFINE_MATH_OPERATORS true
+#include "imgui/imgui_internal.h"
+
+#include "CoreTypes.h"
+
+/**
+ *  The conversions between the value types of the graph model, see CoreTypes.h,
+ *  and those of ImGui: the editor converts as it draws, the model needs no ImGui.
+ **/
+
+namespace chill {
+
+  inline ImVec2 toImGui(const Vec2& _v) {
+    return ImVec2(_v.x, _v.y);
+  }
+
+  inline ImU32 toImGui(const Color& _c) {
+    return IM_COL32(_c.r, _c.g, _c.b, _c.a);
+  }
+
+  inline Vec2 toVec2(const ImVec2& _v) {
+    return Vec2(_v.x, _v.y);
+  }
+
+  /** From the float colors of the ImGui color widgets and drag and drop payloads */
+  inline Color toColor(const ImVec4& _c) {
+    auto channel = [](float _v) {
+      return static_cast<int>(ImSaturate(_v) * 255.0f + 0.5f);
+    };
+    return Color(channel(_c.x), channel(_c.y), channel(_c.z), channel(_c.w));
+  }
+}
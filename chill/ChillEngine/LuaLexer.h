@@ -0,0 +1,210 @@
+/** @file */
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+namespace chill {
+  namespace lua {
+
+    enum TokenKind { END, NAME, STRING, NUMBER, SYMBOL };
+
+    /** A token, viewing the program text */
+    struct Token {
+      TokenKind        kind = END;
+      std::string_view text;
+    };
+
+    /**
+     *  Minimal Lua lexer: names, strings, numbers and one character symbols.
+     *  Comments and long brackets are skipped the way Lua does, so that a
+     *  declaration in a comment or a string is never picked up.
+     **/
+    class Lexer
+    {
+    public:
+      explicit Lexer(std::string_view _program) : m_text(_program) {}
+
+      Token next() {
+        skipBlanks();
+        Token token;
+        if (m_at >= m_text.size()) {
+          return token;
+        }
+
+        size_t start = m_at;
+        char   c     = m_text[m_at];
+        if (isNameStart(c)) {
+          while (m_at < m_text.size() && isNameChar(m_text[m_at])) m_at++;
+          token.kind = NAME;
+        } else if (isDigit(c) || (c == '.' && m_at + 1 < m_text.size() && isDigit(m_text[m_at + 1]))) {
+          skipNumber();
+          token.kind = NUMBER;
+        } else if (c == '"' || c == '\'') {
+          skipShortString(c);
+          token.kind = STRING;
+        } else if (c == '[' && longBracketLevel(m_at) >= 0) {
+          skipLongBracket();
+          token.kind = STRING;
+        } else {
+          m_at++;
+          token.kind = SYMBOL;
+        }
+        token.text = m_text.substr(start, m_at - start);
+        return token;
+      }
+
+      /** Position in the program, used to view the raw text of a parameter */
+      size_t position() const {
+        return m_at;
+      }
+
+      std::string_view text(size_t _from, size_t _to) const {
+        return m_text.substr(_from, _to - _from);
+      }
+
+    private:
+      static bool isDigit(char _c) {
+        return _c >= '0' && _c <= '9';
+      }
+
+      static bool isNameStart(char _c) {
+        return (_c >= 'a' && _c <= 'z') || (_c >= 'A' && _c <= 'Z') || _c == '_';
+      }
+
+      static bool isNameChar(char _c) {
+        return isNameStart(_c) || isDigit(_c);
+      }
+
+      /** Level of the long bracket [==[ at _at, -1 if there is none */
+      int longBracketLevel(size_t _at) const {
+        size_t i = _at + 1;
+        while (i < m_text.size() && m_text[i] == '=') i++;
+        if (i < m_text.size() && m_text[i] == '[') {
+          return static_cast<int>(i - _at - 1);
+        }
+        return -1;
+      }
+
+      void skipLongBracket() {
+        int level = longBracketLevel(m_at);
+        m_at += level + 2;
+        std::string closing = "]" + std::string(level, '=') + "]";
+        size_t end = m_text.find(closing, m_at);
+        m_at = (end == std::string_view::npos) ? m_text.size() : end + closing.size();
+      }
+
+      void skipShortString(char _quote) {
+        m_at++;
+        while (m_at < m_text.size() && m_text[m_at] != _quote && m_text[m_at] != '\n') {
+          m_at += (m_text[m_at] == '\\') ? 2 : 1;
+        }
+        m_at = std::min(m_at + 1, m_text.size());
+      }
+
+      void skipNumber() {
+        if (m_text.compare(m_at, 2, "0x") == 0 || m_text.compare(m_at, 2, "0X") == 0) {
+          m_at += 2;
+        }
+        while (m_at < m_text.size()) {
+          char c = m_text[m_at];
+          if ((c == 'e' || c == 'E' || c == 'p' || c == 'P') && m_at + 1 < m_text.size()
+            && (m_text[m_at + 1] == '+' || m_text[m_at + 1] == '-')) {
+            m_at += 2;
+          } else if (isNameChar(c) || c == '.') {
+            m_at++;
+          } else {
+            break;
+          }
+        }
+      }
+
+      void skipBlanks() {
+        while (m_at < m_text.size()) {
+          char c = m_text[m_at];
+          if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v') {
+            m_at++;
+          } else if (c == '-' && m_at + 1 < m_text.size() && m_text[m_at + 1] == '-') {
+            m_at += 2;
+            if (m_at < m_text.size() && m_text[m_at] == '[' && longBracketLevel(m_at) >= 0) {
+              skipLongBracket();
+            } else {
+              size_t end = m_text.find('\n', m_at);
+              m_at = (end == std::string_view::npos) ? m_text.size() : end;
+            }
+          } else {
+            break;
+          }
+        }
+      }
+
+      std::string_view m_text;
+      size_t           m_at = 0;
+    };
+
+    //-------------------------------------------------------
+
+    inline bool isSymbol(const Token& _token, char _c) {
+      return _token.kind == SYMBOL && _token.text[0] == _c;
+    }
+
+    /** Content of a string token, without the quotes or brackets */
+    inline std::string_view unquote(const Token& _token) {
+      std::string_view text = _token.text;
+      if (text[0] == '[') {
+        size_t open = text.find('[', 1) + 1;
+        size_t size = text.size() - 2 * open;
+        return (text.size() >= 2 * open) ? text.substr(open, size) : std::string_view();
+      }
+      return (text.size() >= 2) ? text.substr(1, text.size() - 2) : std::string_view();
+    }
+
+    /**
+     *  Value of a string token, with the escape sequences of Lua 5.1 decoded.
+     *  Long brackets are raw, less the first newline.
+     **/
+    inline std::string decode(const Token& _token) {
+      std::string_view text = unquote(_token);
+      if (_token.text[0] == '[') {
+        if (!text.empty() && text[0] == '\r') text.remove_prefix(1);
+        if (!text.empty() && text[0] == '\n') text.remove_prefix(1);
+        return std::string(text);
+      }
+
+      std::string value;
+      value.reserve(text.size());
+      for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c != '\\' || i + 1 == text.size()) {
+          value += c;
+          continue;
+        }
+        c = text[++i];
+        switch (c) {
+        case 'a': value += '\a'; break;
+        case 'b': value += '\b'; break;
+        case 'f': value += '\f'; break;
+        case 'n': value += '\n'; break;
+        case 'r': value += '\r'; break;
+        case 't': value += '\t'; break;
+        case 'v': value += '\v'; break;
+        default:
+          if (c >= '0' && c <= '9') {
+            int code = 0;
+            for (int digits = 0; digits < 3 && i < text.size() && text[i] >= '0' && text[i] <= '9'; ++digits, ++i) {
+              code = code * 10 + (text[i] - '0');
+            }
+            --i;
+            value += static_cast<char>(code);
+          } else {
+            // \\, \', \", an escaped newline, or any other character as is
+            value += c;
+          }
+          break;
+        }
+      }
+      return value;
+    }
+  }
+}
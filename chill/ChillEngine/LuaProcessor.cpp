@@ -1,20 +1,10 @@
 #include "LuaProcessor.h"
 
 #include <LibSL/LibSL.h>
-#include <regex>
+#include <algorithm>
 
-#include "NodeEditor.h"
-
-const std::string REGEX_WSPACES = "\\s*";
-const std::string REGEX_COMMENT = "(--\\[\\[[\\s\\S]*?\\]\\]--|--[^\\n]*)";
-const std::string REGEX_STRING  = "[\\\"\\\']([\\S\\s]*?)[\\\"\\\']";
-const std::string REGEX_INT     = "(-?\\d+)";
-const std::string REGEX_SCALAR  = "(-?(?:\\d*[.]\\d+|\\d+[.]\\d*)(?:[Ee][+-]?\\d+)?)";
-const std::string REGEX_NUMBER  = "(?:" + REGEX_SCALAR + "|" + REGEX_INT + ")";
-const std::string REGEX_BOOL    = "(true|false)";
-const std::string REGEX_NAMED   = "^(?:\\s)*([a-zA-Z_][\\w_]*)\\s*=\\s*";
-const std::string REGEX_TABLE   = "\\{(?:(,?\\s*(?:" + REGEX_NAMED + "|)(?:" + REGEX_STRING + "|" + REGEX_NUMBER + "|" + REGEX_BOOL + ")\\s*?)*)\\}";
-const std::string REGEX_PARAM   = "(?:" + REGEX_STRING + "|" + REGEX_NUMBER + "|" + REGEX_BOOL + "|" + REGEX_TABLE + ")";
+#include "GraphExporter.h"
+#include "NodeLibrary.h"
 
 namespace chill {
   LuaProcessor::LuaProcessor(LuaProcessor &_processor) {
@@ -22,7 +12,6 @@ namespace chill {
     setName(_processor.name());
     setOwner(_processor.owner());
     setColor(_processor.color());
-    m_program = loadFileIntoString((NodeEditor::NodesFolder() + m_nodepath).c_str());
 
     for (auto input : _processor.inputs()) {
       addInput(input->clone());
@@ -34,183 +23,240 @@ namespace chill {
   }
 
   LuaProcessor::LuaProcessor(const std::string &_path) {
-    std::regex e("\\\\");
-    m_nodepath = regex_replace(_path, e, "/$2");
-    m_program  = loadFileIntoString((NodeEditor::NodesFolder() + m_nodepath).c_str());
+    m_nodepath = _path;
+    std::replace(m_nodepath.begin(), m_nodepath.end(), '\\', '/');
 
     setName(removeExtensionFromFileName(extractFileName(m_nodepath)));
     Parse();
   }
 
-  void LuaProcessor::save(std::ofstream& _stream) {
-    ImVec4 rgba = ImGui::ColorConvertU32ToFloat4(color());
-    _stream << "p_" << getUniqueID() << " = Node({" <<
-      "name = '" << name() << "'" <<
+  LuaProcessor::LuaProcessor(const std::string &_path, const NodeSignature& _signature) {
+    m_nodepath = _path;
+    std::replace(m_nodepath.begin(), m_nodepath.end(), '\\', '/');
+
+    setName(removeExtensionFromFileName(extractFileName(m_nodepath)));
+    apply(_signature);
+  }
+
+  void LuaProcessor::save(LuaWriter& _writer) {
+    _writer << "p_" << getUniqueID() << " = Node({name = ";
+    _writer.quoted(name()) <<
       ", x = " << getPosition().x <<
       ", y = " << getPosition().y <<
-      ", color = {" << int(rgba.x * 255) << ", " << int(rgba.y * 255) << ", " << int(rgba.z * 255) << "}" <<
-      ", path = '" << m_nodepath << "'" <<
-      "})" << std::endl;
+      ", color = {" << int(color().r) << ", " << int(color().g) << ", " << int(color().b) << "}" <<
+      ", path = ";
+    _writer.quoted(m_nodepath) << "})\n";
 
     /* Saving I/Os is not usefull in general case*/
     // Save inputs
     for (std::shared_ptr<ProcessorInput> input : inputs()) {
-      input->save(_stream);
-      _stream << "p_" << getUniqueID() << ":add(i_" << input->getUniqueID() << ")" << std::endl;
+      input->save(_writer);
+      _writer << "p_" << getUniqueID() << ":add(i_" << input->getUniqueID() << ")\n";
     }
     // Save outputs
     for (std::shared_ptr<ProcessorOutput> output : outputs()) {
-      output->save(_stream);
-      _stream << "p_" << getUniqueID() << ":add(o_" << output->getUniqueID() << ")" << std::endl;
+      output->save(_writer);
+      _writer << "p_" << getUniqueID() << ":add(o_" << output->getUniqueID() << ")\n";
     }
   }
 
-  void LuaProcessor::iceSL(std::ofstream& _stream) {
+  void LuaProcessor::iceSL(LuaWriter& _writer) {
     //write the current Id of the node
 
-    std::string code = "--[[ " + name() + " ]]--\n";
-    code += "setfenv(1, _G0)  --go back to global initialization\n";
-    code += "__currentNodeId = " + std::to_string(getUniqueID()) + "\n";
+    _writer << "--[[ " << name() << " ]]--\n";
+    _writer << "setfenv(1, _G0)  --go back to global initialization\n";
+    _writer << "__currentNodeId = " << getUniqueID() << "\n";
 
     if (isDirty() || isEmiter()) {
-      code += "setDirty(__currentNodeId)\n";
+      _writer << "setDirty(__currentNodeId)\n";
+    }
+    std::shared_ptr<const std::string> source = NodeLibrary::Instance().source(m_nodepath);
+    GraphExporter::writeChanges(_writer, *this, *source);
+
+    // only computes constants, known at export: its values instead of its code
+    const NodeSandbox::Values* constants = GraphExporter::constants(*this);
+    if (constants) {
+      std::string values;
+      for (const auto& constant : *constants) {
+        values += constant.first + "=" + constant.second + "\n";
+      }
+      GraphExporter::contentKey(*this, values);
+      _writer << "if (isDirty({__currentNodeId";
+      for (auto input : inputs()) {
+        if (input->m_link) {
+          _writer << ", " << input->m_link->owner()->getUniqueID();
+        }
+      }
+      _writer << "})) then\nsetDirty(__currentNodeId)\n";
+      for (const auto& constant : *constants) {
+        std::shared_ptr<ProcessorOutput> folded = output(constant.first);
+        if (!folded) {
+          continue;
+        }
+        writeOutput(_writer, *folded, "__currentNodeId");
+        _writer << " = " << constant.second << "\n";
+      }
+      _writer << "end --vb\n";
+      return;
     }
 
+    // computes the same as a node written before: its outputs
+    Processor* original = GraphExporter::duplicateOf(*this);
+    if (original) {
+      std::string original_id = std::to_string(original->getUniqueID());
+      _writer << "if (isDirty({__currentNodeId, " << original_id;
+      for (auto input : inputs()) {
+        if (input->m_link) {
+          _writer << ", " << input->m_link->owner()->getUniqueID();
+        }
+      }
+      _writer << "})) then\nsetDirty(__currentNodeId)\n";
+      for (auto output : outputs()) {
+        writeOutput(_writer, *output, "__currentNodeId");
+        _writer << " = ";
+        writeOutput(_writer, *original->output(output->name()), original_id);
+        _writer << "\n";
+      }
+      if (getState() == EMITING) {
+        for (auto output : outputs()) {
+          if (output->isEmitable()) {
+            _writer << "emit( ";
+            writeOutput(_writer, *output, "__currentNodeId");
+            _writer << ")\n";
+          }
+        }
+      }
+      _writer << "end --vb\n";
+      return;
+    }
+
+    bool slots = GraphExporter::hasSlots();
     for (auto input : inputs()) {
       // tweak
       if (!input->m_link) {
-        code += "__input[\"" + std::string(input->name()) + "\"] = {" + input->getLuaValue() + ", 0}\n";
+        if (slots) {
+          _writer << "__value[\"" << input->name() << "\"] = ";
+          GraphExporter::writeTweak(_writer, *input);
+          _writer << "\n__id[\"" << input->name() << "\"] = 0\n";
+          continue;
+        }
+        _writer << "__input[\"" << input->name() << "\"] = {";
+        GraphExporter::writeTweak(_writer, *input);
+        _writer << ", 0}\n";
       }
       // input
       else {
-        std::string s2 = std::to_string(input->m_link->owner()->getUniqueID());
-        code += "__input[\"" + std::string(input->name()) + "\"] = {" + input->m_link->name() + s2 + "," + s2 + "}\n";
+        int64_t id = input->m_link->owner()->getUniqueID();
+        if (slots) {
+          _writer << "__value[\"" << input->name() << "\"] = __slots[" << GraphExporter::slot(*input->m_link) << "]\n";
+          _writer << "__id[\"" << input->name() << "\"] = " << id << "\n";
+          continue;
+        }
+        _writer << "__input[\"" << input->name() << "\"] = {" << input->m_link->name() << id << "," << id << "}\n";
       }
     }
 
-    //TODO: CLEAN THIS !!!!
-    code += "\
-_Gcurrent = {} -- clear _Gcurrent\n\
-setmetatable(_Gcurrent, { __index = _G0 }) --copy index from _G0\n\
-setfenv(1, _Gcurrent)    --set it\n\
-";
+    GraphExporter::writeEnvironment(_writer);
 
-    code += "if (isDirty({__currentNodeId";
+    _writer << "if (isDirty({__currentNodeId";
 
     for (auto input : inputs()) {
       if (input->m_link) {
-        std::string s2 = std::to_string(input->m_link->owner()->getUniqueID());
-        code += ", " + s2;
+        _writer << ", " << input->m_link->owner()->getUniqueID();
       }
     }
 
-    code += "})) then\n\
+    _writer << "})) then\n\
 setDirty(__currentNodeId)\n";
 
+    if (slots) {
+      for (auto output : outputs()) {
+        _writer << "__outslot[\"" << output->name() << "\"] = " << GraphExporter::slot(*output) << "\n";
+      }
+    }
+
+    // outputs computed by a previous run of the script, on the same code and values
+    std::string key = GraphExporter::contentKey(*this, *source);
+    if (!key.empty()) {
+      _writer << "if not memoRestore(";
+      memoArguments(_writer, key);
+      _writer << ") then\n";
+    }
 
-    code += loadFileIntoString((NodeEditor::NodesFolder() + m_nodepath).c_str());
+    _writer << *source;
+
+    if (!key.empty()) {
+      _writer << "\nmemoStore(";
+      memoArguments(_writer, key);
+      _writer << ")\nend\n";
+    }
 
     if (getState() == EMITING) {
       for (auto output : outputs()) {
         if (output->isEmitable()) {
-          code += "emit( _G['"+ std::string(output->name()) +"'..__currentNodeId])" + "\n";
+          _writer << "emit( ";
+          writeOutput(_writer, *output, "__currentNodeId");
+          _writer << ")\n";
         }
       }
     }
     if (getState() == DISABLED) {
       for (auto output : outputs()) {
         if (output->isEmitable()) {
-          code += "_G['" + std::string(output->name()) + "'..__currentNodeId] = Void" + "\n";
+          writeOutput(_writer, *output, "__currentNodeId");
+          _writer << " = Void\n";
         }
       }
     }
 
-    code += "\nend --vb";
-
-    _stream << code << std::endl;
+    _writer << "\nend --vb\n";
   }
 
-
-
-  void LuaProcessor::ParseInput() {
-    std::string toParse = m_program;
-    std::string uncommented;
-    std::regex nocomment(REGEX_COMMENT);
-    regex_replace(std::back_inserter(uncommented), toParse.begin(), toParse.end(), nocomment, "$2");
-
-    try {
-      std::string outcome = uncommented;
-      std::regex input_regex("(input|data)" + REGEX_WSPACES + "\\(" + REGEX_WSPACES + REGEX_STRING + REGEX_WSPACES
-        + "," + REGEX_WSPACES + REGEX_STRING + REGEX_WSPACES
-        + "(?:," + REGEX_WSPACES + "((?:,?" + REGEX_WSPACES + REGEX_PARAM + REGEX_WSPACES + ")*?)|)\\)");
-      std::smatch sm;
-      while (regex_search(outcome, sm, input_regex)) {
-        std::smatch parameters;
-        std::regex param_regex("^,?" + REGEX_WSPACES + "?(" + REGEX_PARAM  + ")" + REGEX_WSPACES + "?");
-        std::string outcome2 = sm[4].str();
-
-        std::vector<std::string> params;
-        while (!outcome2.empty() && regex_search(outcome2, parameters, param_regex)) {
-          params.push_back(parameters[1]);
-          outcome2 = parameters.suffix().str();
-        }
-        auto input = addInput(sm[2], IOType::FromString(sm[3]), params);
-        
-        if (sm[1] == "data")
-          input->m_isDataOnly = true;
-        outcome = sm.suffix().str();
-      }
-    }
-    catch (const std::regex_error& e) {
-      std::cout << "ParseInput: regex_error caught: " << e.what() << '\n';
+  void LuaProcessor::writeOutput(LuaWriter& _writer, ProcessorOutput& _output, const std::string& _node) {
+    int slot = GraphExporter::slot(_output);
+    if (slot > 0) {
+      _writer << "__slots[" << slot << "]";
+    } else {
+      _writer << "_G['" << _output.name() << "'.." << _node << "]";
     }
   }
 
-  void LuaProcessor::ParseOutput() {
-    std::string toParse = m_program;
-    std::string uncommented;
-    std::regex nocomment(REGEX_COMMENT);
-    regex_replace(std::back_inserter(uncommented), toParse.begin(), toParse.end(), nocomment, "$2");
-
-    try {
-      std::string outcome = uncommented;
-      std::regex outputEx("output" + REGEX_WSPACES + "\\(" + REGEX_WSPACES + REGEX_STRING + REGEX_WSPACES
-        + "," + REGEX_WSPACES + REGEX_STRING + REGEX_WSPACES
-        + "(," + REGEX_WSPACES + ".*" + REGEX_WSPACES + ")*?\\)");
-      std::smatch sm;
-      while (regex_search(outcome, sm, outputEx)) {
-        addOutput(sm[1], IOType::FromString(sm[2]), IOType::FromString(sm[2]) == IOType::SHAPE);
-        outcome = sm.suffix().str();
+  void LuaProcessor::memoArguments(LuaWriter& _writer, const std::string& _key) {
+    bool slots = GraphExporter::hasSlots();
+    _writer << "'" << _key << "', " << (slots ? "{" : "__currentNodeId, {");
+    bool first = true;
+    for (auto output : outputs()) {
+      _writer << (first ? "" : ", ");
+      if (slots) {
+        _writer << GraphExporter::slot(*output);
+      } else {
+        _writer.quoted(output->name());
       }
+      first = false;
     }
-    catch (const std::regex_error& e) {
-      std::cout << "ParseOutput: regex_error caught: " << e.what() << '\n';
-    }
+    _writer << "}";
   }
 
-  void LuaProcessor::ParseOptional() {
-    std::string toParse = m_program;
-    std::string uncommented;
-    std::regex nocomment(REGEX_COMMENT);
-    regex_replace(std::back_inserter(uncommented), toParse.begin(), toParse.end(), nocomment, "$2");
-
-    try {
-      std::string outcome = uncommented;
-      std::regex outputEx("emit" + REGEX_WSPACES + "\\(.*\\)");
-      std::regex color("setColor" + REGEX_WSPACES + "\\(\\s*" + REGEX_NUMBER + "\\s*,\\s*" + REGEX_NUMBER + "\\s*,\\s*" + REGEX_NUMBER + "\\s*\\)");
-      std::smatch sm;
-      if (regex_search(outcome, sm, outputEx)) {
-        setEmiter();
-      }
-      if (regex_search(outcome, sm, color)) {
-        setColor(ImColor(
-          atoi(sm[2].str().c_str()),
-          atoi(sm[4].str().c_str()),
-          atoi(sm[6].str().c_str())));
-      }
+  void LuaProcessor::Parse() {
+    apply(*NodeLibrary::Instance().signature(m_nodepath));
+  }
+
+  void LuaProcessor::apply(const NodeSignature& _signature) {
+    for (const NodeSignature::Input& declared : _signature.inputs) {
+      std::vector<std::string> params = declared.params;
+      auto input = addInput(declared.name, IOType::FromString(declared.type), params);
+      if (declared.data_only)
+        input->m_isDataOnly = true;
+    }
+    for (const NodeSignature::Output& declared : _signature.outputs) {
+      IOType::IOType type = IOType::FromString(declared.type);
+      addOutput(declared.name, type, type == IOType::SHAPE);
+    }
+    if (_signature.emit) {
+      setEmiter();
     }
-    catch (const std::regex_error& e) {
-      std::cout << "regex_error caught: " << e.what() << '\n';
+    if (_signature.has_color) {
+      setColor(Color(_signature.color[0], _signature.color[1], _signature.color[2]));
     }
   }
 
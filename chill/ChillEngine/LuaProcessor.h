@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Processor.h"
+#include "NodeSignature.h"
 
 namespace chill
 {
@@ -11,43 +12,49 @@ namespace chill
   {
   private:
     std::string m_nodepath;
-    std::string m_program;
     bool        m_program_edited = false;
 
     std::tuple<int, int> m_icesl_export_linenumbers;
 
     LuaProcessor(LuaProcessor &_processor);
+
+    // the key and output names or slots given to memoRestore and memoStore in the script
+    void memoArguments(LuaWriter& _writer, const std::string& _key);
+    // where an output is kept in the script: its slot, or a global named after the node
+    void writeOutput(LuaWriter& _writer, ProcessorOutput& _output, const std::string& _node);
   public:
     LuaProcessor(const std::string &_path);
 
+    /**
+    *  Create a node from the signature of its file, already parsed.
+    *  @param _path The node path, relative to the nodes folder.
+    *  @param _signature The signature, shared by the nodes of the same file.
+    */
+    LuaProcessor(const std::string &_path, const NodeSignature& _signature);
+
     std::shared_ptr<SelectableUI> clone() override {
       return std::shared_ptr<SelectableUI>(new LuaProcessor(*this));
     }
 
-    void save(std::ofstream& _stream) override;
-    void iceSL(std::ofstream& stream) override;
-
-    void ParseInput();
-    void ParseOutput();
-    void ParseOptional();
-
-    void Parse() {
-      ParseInput();
-      ParseOutput();
-      ParseOptional();
-
-      /*if (outputs().empty()) {
-        // No input nor output, should be an old node or object
-        if (inputs().empty()) {
-          // TODO: transform emit into shape output
-        }
-        // No output, should be an emitter
-        else {
-          m_emit = true;
-        }
-      }*/
+    void save(LuaWriter& _writer) override;
+    void iceSL(LuaWriter& _writer) override;
+
+    /** Path of the node file, relative to the nodes folder */
+    const std::string& nodepath() const {
+      return m_nodepath;
     }
 
+    /**
+    *  Create the inputs, outputs and color declared by the node file.
+    *  The declarations come from the node index, the file is parsed only when it changed.
+    */
+    void Parse();
+
+    /**
+    *  Create the inputs, outputs and color of a node signature.
+    *  @param _signature The signature.
+    */
+    void apply(const NodeSignature& _signature);
 
     /**
     *  Add a new input to the processor.
@@ -0,0 +1,127 @@
+#include "LuaWriter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+namespace chill {
+
+  const size_t LuaWriter::c_initial_capacity = 64 * 1024;
+
+  namespace {
+    /** Escape sequence of each byte in a Lua string, empty if written as is */
+    struct EscapeTable {
+      char text[256][5];
+
+      EscapeTable() {
+        for (int c = 0; c < 256; ++c) {
+          text[c][0] = '\0';
+          if (c < 32 || c == 127) {
+            std::snprintf(text[c], sizeof(text[c]), "\\%03d", c);
+          }
+        }
+        const char* named[][2] = {
+          { "\n", "\\n" }, { "\r", "\\r" }, { "\t", "\\t" }, { "\\", "\\\\" },
+          { "'", "\\'" }, { "\"", "\\\"" }
+        };
+        for (const auto& escape : named) {
+          std::snprintf(text[static_cast<unsigned char>(escape[0][0])], sizeof(text[0]), "%s", escape[1]);
+        }
+      }
+    };
+
+    const EscapeTable c_escapes;
+
+    // non finite values have no literal in Lua
+    bool nonFinite(double _value, LuaWriter& _writer) {
+      if (std::isnan(_value)) {
+        _writer << "(0/0)";
+      } else if (std::isinf(_value)) {
+        _writer << (_value > 0 ? "math.huge" : "-math.huge");
+      } else {
+        return false;
+      }
+      return true;
+    }
+  }
+
+  //-------------------------------------------------------
+
+  LuaWriter::LuaWriter() {
+    grow(c_initial_capacity);
+    m_reallocations = 0;
+  }
+
+  //-------------------------------------------------------
+
+  void LuaWriter::grow(size_t _needed) {
+    size_t capacity = std::max<size_t>(m_capacity * 2, 256);
+    while (capacity < _needed) capacity *= 2;
+
+    std::unique_ptr<char[]> data(new char[capacity]);
+    if (m_size > 0) {
+      std::memcpy(data.get(), m_data.get(), m_size);
+    }
+    m_data     = std::move(data);
+    m_capacity = capacity;
+    m_reallocations++;
+  }
+
+  //-------------------------------------------------------
+
+  LuaWriter& LuaWriter::integer(long long _value) {
+    char* at = reserve(24);
+    m_size = std::to_chars(at, at + 24, _value).ptr - m_data.get();
+    return *this;
+  }
+
+  //-------------------------------------------------------
+
+  LuaWriter& LuaWriter::operator<<(float _value) {
+    if (nonFinite(_value, *this)) return *this;
+    char* at = reserve(32);
+    m_size = std::to_chars(at, at + 32, _value).ptr - m_data.get();
+    return *this;
+  }
+
+  //-------------------------------------------------------
+
+  LuaWriter& LuaWriter::operator<<(double _value) {
+    if (nonFinite(_value, *this)) return *this;
+    char* at = reserve(32);
+    m_size = std::to_chars(at, at + 32, _value).ptr - m_data.get();
+    return *this;
+  }
+
+  //-------------------------------------------------------
+
+  LuaWriter& LuaWriter::quoted(const std::string& _text) {
+    // worst case: every byte written as \ddd
+    char* at = reserve(_text.size() * 4 + 2);
+    char* out = at;
+    *out++ = '\'';
+    for (char c : _text) {
+      const char* escape = c_escapes.text[static_cast<unsigned char>(c)];
+      if (escape[0] == '\0') {
+        *out++ = c;
+      } else {
+        while (*escape) *out++ = *escape++;
+      }
+    }
+    *out++ = '\'';
+    m_size += out - at;
+    return *this;
+  }
+
+  //-------------------------------------------------------
+
+  bool LuaWriter::save(const fs::path& _filename) const {
+    std::FILE* file = std::fopen(_filename.string().c_str(), "wb");
+    if (!file) {
+      return false;
+    }
+    bool written = std::fwrite(m_data.get(), 1, m_size, file) == m_size;
+    return (std::fclose(file) == 0) && written;
+  }
+}
@@ -0,0 +1,122 @@
+/** @file */
+#pragma once
+
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace chill {
+
+#ifdef WIN32
+namespace fs = std::experimental::filesystem;
+#else
+namespace fs = std::filesystem;
+#endif
+
+  /**
+   *  LuaWriter class.
+   *  Memory sink for the Lua code of the saved graphs and of the IceSL exports.
+   *  Everything is appended to one growing buffer, written to the file at once.
+   *  Numbers are written with std::to_chars: the shortest text reading back to
+   *  the same value, whatever the locale.
+   **/
+  class LuaWriter
+  {
+  public:
+    /** Initial size of the buffer, enough for most graphs */
+    static const size_t c_initial_capacity;
+
+    LuaWriter();
+
+    LuaWriter& operator<<(const char* _text) {
+      return append(_text, std::strlen(_text));
+    }
+
+    LuaWriter& operator<<(const std::string& _text) {
+      return append(_text.data(), _text.size());
+    }
+
+    LuaWriter& operator<<(char _c) {
+      *reserve(1) = _c;
+      m_size++;
+      return *this;
+    }
+
+    LuaWriter& operator<<(float _value);
+    LuaWriter& operator<<(double _value);
+
+    /** Any integer but bool and char, see boolean() */
+    template <typename T_Int>
+    typename std::enable_if<std::is_integral<T_Int>::value
+      && !std::is_same<T_Int, bool>::value && !std::is_same<T_Int, char>::value, LuaWriter&>::type
+    operator<<(T_Int _value) {
+      return integer(static_cast<long long>(_value));
+    }
+
+    /** Write true or false */
+    LuaWriter& boolean(bool _value) {
+      return _value ? append("true", 4) : append("false", 5);
+    }
+
+    /**
+     *  Write a Lua string literal between single quotes, escaping what needs it.
+     *  @param _text The raw text.
+     **/
+    LuaWriter& quoted(const std::string& _text);
+
+    LuaWriter& append(const char* _text, size_t _size) {
+      std::memcpy(reserve(_size), _text, _size);
+      m_size += _size;
+      return *this;
+    }
+
+    const char* data() const {
+      return m_data.get();
+    }
+
+    /** Number of bytes written so far */
+    size_t size() const {
+      return m_size;
+    }
+
+    /** Number of times the buffer grew */
+    size_t reallocations() const {
+      return m_reallocations;
+    }
+
+    std::string str() const {
+      return std::string(m_data.get(), m_size);
+    }
+
+    void clear() {
+      m_size = 0;
+    }
+
+    /**
+     *  Write the buffer to a file, in a single write.
+     *  @param _filename The file, replaced.
+     *  @return false if the file cannot be written.
+     **/
+    bool save(const fs::path& _filename) const;
+
+  private:
+    LuaWriter& integer(long long _value);
+
+    /** Room for _size more bytes, returns where to write them */
+    char* reserve(size_t _size) {
+      if (m_size + _size > m_capacity) {
+        grow(m_size + _size);
+      }
+      return m_data.get() + m_size;
+    }
+
+    void grow(size_t _needed);
+
+    std::unique_ptr<char[]> m_data;
+    size_t                  m_size          = 0;
+    size_t                  m_capacity      = 0;
+    size_t                  m_reallocations = 0;
+  };
+}
@@ -0,0 +1,187 @@
+#include "NodeCatalog.h"
+
+#include <algorithm>
+
+namespace chill {
+
+  const std::chrono::milliseconds NodeCatalog::c_check_period(2000);
+
+  namespace {
+    uint32_t trigram(const std::string& _text, size_t _at) {
+      return (static_cast<uint32_t>(static_cast<unsigned char>(_text[_at])) << 16)
+           | (static_cast<uint32_t>(static_cast<unsigned char>(_text[_at + 1])) << 8)
+           |  static_cast<uint32_t>(static_cast<unsigned char>(_text[_at + 2]));
+    }
+  }
+
+  //-------------------------------------------------------
+
+  std::string NodeCatalog::toLower(const std::string& _text) {
+    std::string lower = _text;
+    for (char& c : lower) {
+      if (c >= 'A' && c <= 'Z') {
+        c = static_cast<char>(c - 'A' + 'a');
+      }
+    }
+    return lower;
+  }
+
+  //-------------------------------------------------------
+
+  void NodeCatalog::setRoot(const std::string& _root) {
+    m_root = _root;
+    rebuild();
+  }
+
+  //-------------------------------------------------------
+
+  void NodeCatalog::update() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_last_check < c_check_period) {
+      return;
+    }
+    m_last_check = now;
+
+    for (const auto& watched : m_watched) {
+      std::error_code error;
+      fs::file_time_type time = fs::last_write_time(watched.first, error);
+      if (error || time != watched.second) {
+        rebuild();
+        return;
+      }
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void NodeCatalog::rebuild() {
+    m_nodes.clear();
+    m_folders.clear();
+    m_trigrams.clear();
+    m_watched.clear();
+    m_result_valid = false;
+    m_last_check   = std::chrono::steady_clock::now();
+
+    std::error_code error;
+    if (m_root.empty() || !fs::is_directory(m_root, error)) {
+      m_folders.emplace_back();
+      return;
+    }
+    scan(fs::path(m_root));
+  }
+
+  //-------------------------------------------------------
+
+  int NodeCatalog::scan(const fs::path& _folder) {
+    int id = static_cast<int>(m_folders.size());
+    m_folders.emplace_back();
+    m_folders[id].name = _folder.filename().generic_string();
+    m_folders[id].path = _folder.generic_string();
+
+    std::error_code error;
+    m_watched.emplace_back(_folder, fs::last_write_time(_folder, error));
+
+    std::vector<fs::path> directories;
+    std::vector<fs::path> files;
+    for (fs::directory_iterator itr(_folder, error); !error && itr != fs::directory_iterator(); itr.increment(error)) {
+      const fs::path& path = itr->path();
+      if (fs::is_directory(path, error)) {
+        if (path.filename().generic_string()[0] != '.') {
+          directories.push_back(path);
+        }
+      } else if (path.extension() == ".lua") {
+        files.push_back(path);
+      }
+    }
+    std::sort(directories.begin(), directories.end());
+    std::sort(files.begin(), files.end());
+
+    for (const fs::path& directory : directories) {
+      int sub = scan(directory);
+      m_folders[id].folders.push_back(sub);
+    }
+
+    for (const fs::path& file : files) {
+      Node node;
+      node.name  = file.stem().generic_string();
+      node.lower = toLower(node.name);
+      node.path  = file.generic_string();
+
+      int n = static_cast<int>(m_nodes.size());
+      m_nodes.push_back(node);
+      m_folders[id].nodes.push_back(n);
+      index(n);
+    }
+    return id;
+  }
+
+  //-------------------------------------------------------
+
+  void NodeCatalog::index(int _node) {
+    const std::string& lower = m_nodes[_node].lower;
+    for (size_t i = 0; i + 3 <= lower.size(); ++i) {
+      std::vector<int>& list = m_trigrams[trigram(lower, i)];
+      // nodes are indexed in order, a repeated trigram shows up at the back
+      if (list.empty() || list.back() != _node) {
+        list.push_back(_node);
+      }
+    }
+  }
+
+  //-------------------------------------------------------
+
+  const std::vector<int>& NodeCatalog::search(const std::string& _query) {
+    if (m_result_valid && _query == m_query) {
+      return m_result;
+    }
+    m_query        = _query;
+    m_result_valid = true;
+    m_result.clear();
+
+    int count = static_cast<int>(m_nodes.size());
+
+    // too short for the index
+    if (_query.size() < 3) {
+      for (int n = 0; n < count; ++n) {
+        if (m_nodes[n].lower.find(_query) != std::string::npos) {
+          m_result.push_back(n);
+        }
+      }
+      return m_result;
+    }
+
+    std::vector<uint32_t> grams;
+    for (size_t i = 0; i + 3 <= _query.size(); ++i) {
+      grams.push_back(trigram(_query, i));
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+    // score = number of trigrams of the query found in the name
+    m_scores.assign(m_nodes.size(), 0);
+    for (uint32_t gram : grams) {
+      auto found = m_trigrams.find(gram);
+      if (found == m_trigrams.end()) {
+        continue;
+      }
+      for (int n : found->second) {
+        m_scores[n]++;
+      }
+    }
+
+    int all = static_cast<int>(grams.size());
+    std::vector<int> fuzzy;
+    for (int n = 0; n < count; ++n) {
+      if (m_scores[n] == all && m_nodes[n].lower.find(_query) != std::string::npos) {
+        m_result.push_back(n);
+      } else if (m_scores[n] * 2 >= all) {
+        fuzzy.push_back(n);
+      }
+    }
+    std::stable_sort(fuzzy.begin(), fuzzy.end(), [this](int _a, int _b) {
+      return m_scores[_a] > m_scores[_b];
+    });
+    m_result.insert(m_result.end(), fuzzy.begin(), fuzzy.end());
+    return m_result;
+  }
+}
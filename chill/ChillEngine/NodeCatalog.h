@@ -0,0 +1,117 @@
+/** @file */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace chill {
+
+#ifdef WIN32
+namespace fs = std::experimental::filesystem;
+#else
+namespace fs = std::filesystem;
+#endif
+
+  /**
+   *  NodeCatalog class.
+   *  In-memory list of the node files of the library, built once and rebuilt only
+   *  when a folder of the library changes. Names are kept in lower case with a
+   *  trigram index, so that the add-node menus never touch the file system.
+   **/
+  class NodeCatalog
+  {
+  public:
+    /** A node file */
+    struct Node {
+      /** File name without extension */
+      std::string name;
+      /** Lower case name, used by the search */
+      std::string lower;
+      /** Full path of the file */
+      std::string path;
+    };
+
+    /** A folder of the library */
+    struct Folder {
+      std::string      name;
+      std::string      path;
+      /** Sub-folders, indices in folders() */
+      std::vector<int> folders;
+      /** Node files, indices in nodes() */
+      std::vector<int> nodes;
+    };
+
+    /**
+     *  Set the folder of the library, the catalog is rebuilt.
+     *  @param _root The folder.
+     **/
+    void setRoot(const std::string& _root);
+
+    const std::string& root() const {
+      return m_root;
+    }
+
+    /**
+     *  Rebuild the catalog if a folder changed since the last check. The folders
+     *  are checked at most once per c_check_period, so this can be called each frame.
+     **/
+    void update();
+
+    /**
+     *  Scan the library and rebuild the catalog.
+     **/
+    void rebuild();
+
+    const std::vector<Node>& nodes() const {
+      return m_nodes;
+    }
+
+    const std::vector<Folder>& folders() const {
+      return m_folders;
+    }
+
+    /**
+     *  Search the nodes. The nodes whose name contains the query come first, in
+     *  library order, followed by the nodes sharing at least half of its trigrams.
+     *  The result of the last query is cached.
+     *  @param _query The query, in lower case.
+     *  @return The indices of the matching nodes.
+     **/
+    const std::vector<int>& search(const std::string& _query);
+
+    /**
+     *  Lower case a string, ASCII only.
+     *  @param _text The string.
+     *  @return The string in lower case.
+     **/
+    static std::string toLower(const std::string& _text);
+
+    /** Minimum time between two checks of the folders */
+    static const std::chrono::milliseconds c_check_period;
+
+  private:
+    int  scan(const fs::path& _folder);
+    void index(int _node);
+
+    std::string         m_root;
+    std::vector<Node>   m_nodes;
+    std::vector<Folder> m_folders;
+
+    /** trigram -> sorted indices of the nodes containing it */
+    std::unordered_map<uint32_t, std::vector<int>> m_trigrams;
+
+    /** last write time of each folder, to detect changes */
+    std::vector<std::pair<fs::path, fs::file_time_type>> m_watched;
+    std::chrono::steady_clock::time_point                m_last_check;
+
+    std::string      m_query;
+    std::vector<int> m_result;
+    bool             m_result_valid = false;
+    std::vector<int> m_scores;
+  };
+}
@@ -2,10 +2,13 @@
 #include "Processor.h"
 #include "LuaProcessor.h"
 #include "IOs.h"
+#include "GraphBinary.h"
+#include "GraphExporter.h"
 #include "GraphSaver.h"
 #include "FileDialog.h"
 #include "Resources.h"
 #include "VisualComment.h"
+#include "HeadlessUI.h"
 
 #include "SourcePath.h"
 
@@ -22,141 +25,109 @@ namespace chill
 {
   NodeEditor* NodeEditor::s_instance = nullptr;
 
-  //-------------------------------------------------------
-  void listFolderinDir(std::vector<std::string>& _files, const std::string& _dir)
-  {
-    for (fs::directory_iterator itr(_dir); itr != fs::directory_iterator(); ++itr)
-    {
-      fs::path file = itr->path();
-      if (is_directory(file))_files.push_back(file.filename().generic_string());
-    }
-  }
+  // node outputs IceSL keeps when m_memoize is set
+  const size_t c_memo_entries = 256;
 
+  //-------------------------------------------------------
   void listLuaFileInDir(std::vector<std::string>& _files)
   {
     listFiles(NodeEditor::NodesFolder().c_str(), _files);
   }
 
-  void listLuaFileInDir(std::vector<std::string>& _files, const std::string& _dir)
-  {
-    for (fs::directory_iterator itr(_dir); itr != fs::directory_iterator(); ++itr)
-    {
-      fs::path file = itr->path();
-      if (!is_directory(file) && strcmp(extractExtension(file.filename().generic_string()).c_str(), "lua") == 0) {
-        _files.push_back(file.filename().generic_string());
-      }
-    }
-  }
-
   //---------------------------------------------------
-  std::string recursiveFileMenuSelecter(const std::string& _current_dir, std::string filter = "")
+  std::string nodeListSelecter(NodeCatalog& _catalog, const std::string& _filter)
   {
-    std::vector<std::string> files;
-    std::vector<std::string> directories;
-
-    listLuaFileInDir(files, _current_dir);
-    listFolderinDir(directories, _current_dir);
-
     std::string nameDir = "";
+    const std::vector<int>& found = _catalog.search(_filter);
 
-    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.7F, 0.7F, 1.0F, 1.0F));
-    ForIndex(i, directories.size()) {
-      const char* dir_name = directories[static_cast<unsigned>(i)].c_str();
-      if (!nameDir.empty()) break;
-
-      if (dir_name[0] != '.') {
-        if (!filter.empty()){
-          nameDir = recursiveFileMenuSelecter(Resources::toPath(_current_dir, directories[i]), filter);
-        } else {
-          if (ImGui::CollapsingHeader((std::string(dir_name) + "##" + _current_dir).c_str() )) {
-            ImGui::SetCursorPosX(ImGui::GetCursorPosX() + 10);
-            ImGui::BeginGroup();
-            nameDir = recursiveFileMenuSelecter(Resources::toPath(_current_dir, directories[i]), filter);
-            ImGui::EndGroup();
-
-          }
+    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0F, 1.0F, 1.0F, 1.0F));
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(found.size()));
+    while (clipper.Step()) {
+      for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+        const NodeCatalog::Node& node = _catalog.nodes()[found[i]];
+        ImGui::PushID(found[i]);
+        if (ImGui::MenuItem(node.name.c_str())) {
+          nameDir = node.path;
         }
+        ImGui::PopID();
       }
     }
     ImGui::PopStyleColor();
+    return nameDir;
+  }
 
-    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0F, 1.0F, 1.0F, 1.0F));
-    ForIndex(i, files.size()) {
-      std::string name = removeExtensionFromFileName(files[i]);
-      std::string low_name = name;
-      std::locale loc;
-
-      for(auto& elem : low_name)
-          elem = std::tolower(elem,loc);
-
-      // If don't match the filter, we skip
-      if (low_name.find(filter) == std::string::npos) {
-        continue;
-      }
-
-      bool test = ImGui::MenuItem(name.c_str());
+  //---------------------------------------------------
+  std::string folderNodeSelecter(NodeCatalog& _catalog, const NodeCatalog::Folder& _folder)
+  {
+    std::string nameDir = "";
 
-      if (test) {
-        nameDir = Resources::toPath(_current_dir, files[i]);
+    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0F, 1.0F, 1.0F, 1.0F));
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(_folder.nodes.size()));
+    while (clipper.Step()) {
+      for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+        const NodeCatalog::Node& node = _catalog.nodes()[_folder.nodes[i]];
+        if (ImGui::MenuItem(node.name.c_str())) {
+          nameDir = node.path;
+        }
       }
-
     }
     ImGui::PopStyleColor();
     return nameDir;
   }
 
   //---------------------------------------------------
-  std::string recursiveFileSelecter(const std::string& _current_dir, std::string filter = "")
+  std::string recursiveFileMenuSelecter(NodeCatalog& _catalog, int _folder, const std::string& filter = "")
   {
-    std::vector<std::string> files;
-    std::vector<std::string> directories;
-
-    listLuaFileInDir(files, _current_dir);
-    listFolderinDir(directories, _current_dir);
+    if (!filter.empty()) {
+      return nodeListSelecter(_catalog, filter);
+    }
 
+    const NodeCatalog::Folder& folder = _catalog.folders()[_folder];
     std::string nameDir = "";
 
     ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.7F, 0.7F, 1.0F, 1.0F));
-    ForIndex(i, directories.size()) {
-      const char* dir_name = directories[static_cast<unsigned>(i)].c_str();
+    for (int sub : folder.folders) {
       if (!nameDir.empty()) break;
 
-      if (dir_name[0] != '.') {
-        if (!filter.empty()){
-          nameDir = recursiveFileSelecter(Resources::toPath(_current_dir, directories[i]), filter);
-        } else {
-          if (ImGui::BeginMenu(dir_name)) {
-            nameDir = recursiveFileSelecter(Resources::toPath(_current_dir, directories[i]), filter);
-            ImGui::EndMenu();
-          }
-        }
+      const NodeCatalog::Folder& dir = _catalog.folders()[sub];
+      if (ImGui::CollapsingHeader((dir.name + "##" + folder.path).c_str())) {
+        ImGui::SetCursorPosX(ImGui::GetCursorPosX() + 10);
+        ImGui::BeginGroup();
+        nameDir = recursiveFileMenuSelecter(_catalog, sub);
+        ImGui::EndGroup();
       }
     }
     ImGui::PopStyleColor();
 
-    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0F, 1.0F, 1.0F, 1.0F));
-    ForIndex(i, files.size()) {
-      std::string name = removeExtensionFromFileName(files[i]);
-      std::string low_name = name;
-      std::locale loc;
+    std::string node = folderNodeSelecter(_catalog, folder);
+    return node.empty() ? nameDir : node;
+  }
 
-      for(auto& elem : low_name)
-          elem = std::tolower(elem,loc);
+  //---------------------------------------------------
+  std::string recursiveFileSelecter(NodeCatalog& _catalog, int _folder, const std::string& filter = "")
+  {
+    if (!filter.empty()) {
+      return nodeListSelecter(_catalog, filter);
+    }
 
-      // If don't match the filter, we skip
-      if (low_name.find(filter) == std::string::npos) {
-        continue;
-      }
+    const NodeCatalog::Folder& folder = _catalog.folders()[_folder];
+    std::string nameDir = "";
 
-      bool test = ImGui::MenuItem(name.c_str());
+    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.7F, 0.7F, 1.0F, 1.0F));
+    for (int sub : folder.folders) {
+      if (!nameDir.empty()) break;
 
-      if (test) {
-        nameDir = Resources::toPath(_current_dir, files[i]);
+      if (ImGui::BeginMenu(_catalog.folders()[sub].name.c_str())) {
+        nameDir = recursiveFileSelecter(_catalog, sub);
+        ImGui::EndMenu();
       }
-
     }
     ImGui::PopStyleColor();
-    return nameDir;
+
+    std::string node = folderNodeSelecter(_catalog, folder);
+    return node.empty() ? nameDir : node;
   }
 
   //-------------------------------------------------------
@@ -170,10 +141,10 @@ namespace chill
   //-------------------------------------------------------
   bool addNodeLeftMenu(ImVec2 _pos, std::string filter = "") {
     NodeEditor* n_e = NodeEditor::Instance();
-    std::string node = recursiveFileMenuSelecter(NodeEditor::NodesFolder(), filter);
+    std::string node = recursiveFileMenuSelecter(n_e->nodeCatalog(), 0, filter);
     if (!node.empty()) {
       std::shared_ptr<LuaProcessor> proc = n_e->getCurrentGraph()->addProcessor<LuaProcessor>(relativePath(node));
-      proc->setPosition(_pos);
+      proc->setPosition(toVec2(_pos));
       return true;
     }
     return false;
@@ -182,10 +153,10 @@ namespace chill
   //-------------------------------------------------------
   bool addNodeMenu(ImVec2 _pos, std::string filter = "") {
     NodeEditor* n_e = NodeEditor::Instance();
-    std::string node = recursiveFileSelecter(NodeEditor::NodesFolder(), filter);
+    std::string node = recursiveFileSelecter(n_e->nodeCatalog(), 0, filter);
     if (!node.empty()) {
       std::shared_ptr<LuaProcessor> proc = n_e->getCurrentGraph()->addProcessor<LuaProcessor>(relativePath(node));
-      proc->setPosition(_pos);
+      proc->setPosition(toVec2(_pos));
       return true;
     }
     return false;
@@ -265,30 +236,201 @@ namespace chill
   //-------------------------------------------------------
 
   void NodeEditor::loadGraph(const fs::path* _path, bool _setAsAutoSavePath = false) {
-    GraphSaver loader;
-    loader.execute(_path);
+    if (m_loader) {
+      cancelLoading();
+    }
+    m_journal.close(*getMainGraph());
+
+    std::string error;
+    std::unique_ptr<GraphLoader> loader = GraphLoader::open(*_path, error);
+    if (loader) {
+      // the graph fills up over the next frames, see stepLoading
+      m_loading_previous = getMainGraph();
+      m_loading_path     = _setAsAutoSavePath ? *_path : fs::path();
+      setMainGraph(loader->graph());
+      if (loader->total() > 0) {
+        centerView(loader->bounds());
+      }
+      m_loader = std::move(loader);
+      return;
+    }
+    if (GraphBinary::recognize(*_path)) {
+      // the current graph stays
+      openJournal(false);
+      return;
+    }
+
+    // not written by ProcessingGraph::save, let Lua run it
+    std::cerr << Console::yellow << "Running " << _path->string() << " in Lua (" << error << ")" << Console::gray << std::endl;
+    GraphSaver saver;
+    saver.execute(_path);
+    if (saver.mainGraph()) {
+      setMainGraph(saver.mainGraph());
+    }
 
     if (_setAsAutoSavePath) {
       m_graphPath = fs::path(*_path);
+      // the journal was not replayed on this graph, the first snapshot would replace its edits
+      fs::path aside;
+      if (!GraphJournal::setAside(m_graphPath, aside)) {
+        std::cerr << Console::red << "The journal of " << m_graphPath.string() << " cannot be replayed nor moved aside, the graph is saved without journal" << Console::gray << std::endl;
+      } else {
+        if (!aside.empty()) {
+          std::cerr << Console::yellow << "The journal of " << m_graphPath.string() << " cannot be replayed on a graph run in Lua, its edits are kept in " << aside.string() << Console::gray << std::endl;
+        }
+        openJournal(false);
+      }
     }
+    centerView(getMainGraph()->getBoundingBox());
+  }
 
+  //-------------------------------------------------------
 
+  void NodeEditor::followSelection() {
+    if (m_ui_tweaks != ExportOptions::UI_SELECTED || m_loader) {
+      m_tweaked.clear();
+      return;
+    }
+    ExportOptions options;
+    options.ui_tweaks = m_ui_tweaks;
+    // the nodes that gain or lose their tweaks, their value in IceSL is not the one of Chill
+    std::unordered_set<Processor*> tweaked;
+    std::vector<Processor*> changed;
+    std::function<void(ProcessingGraph&)> visit = [&](ProcessingGraph& _graph) {
+      for (std::shared_ptr<Processor> processor : *_graph.processors()) {
+        bool tweaks = false;
+        for (std::shared_ptr<ProcessorInput> input : processor->inputs()) {
+          tweaks = tweaks || GraphExporter::isUiTweak(*input, options);
+        }
+        if (tweaks) {
+          tweaked.insert(processor.get());
+        }
+        if (tweaks != (m_tweaked.count(processor.get()) > 0)) {
+          changed.push_back(processor.get());
+        }
+        ProcessingGraph* group = dynamic_cast<ProcessingGraph*>(processor.get());
+        if (group) {
+          visit(*group);
+        }
+      }
+    };
+    visit(*getMainGraph());
+    m_tweaked = std::move(tweaked);
+    if (changed.empty() || !m_auto_export) {
+      return;
+    }
+    // they run again in IceSL, the nodes dirty for another reason stay dirty
+    std::vector<Processor*> clean;
+    for (Processor* processor : changed) {
+      if (!processor->isDirty()) {
+        clean.push_back(processor);
+        processor->setDirty(true);
+      }
+    }
+    {
+      FrameProfiler::Scope scope(m_profiler, FrameProfiler::EXPORT);
+      exportIceSL(&m_iceSLTempExportPath);
+    }
+    for (Processor* processor : clean) {
+      processor->setDirty(false);
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void NodeEditor::centerView(const AASquare& _bbox) {
     // Recenter the view and adjust zoom
-    auto bbox = getMainGraph()->getBoundingBox();
-    auto center = bbox.center();
+    auto center = _bbox.center();
 
     ImGuiWindow* window = m_graphWindow;
 
     if (window) {
       m_offset = ImVec2(center[0], center[1]) - window->Pos;
-      m_zoom =  min(window->Size[0] / bbox.extent()[0], window->Size[1] / bbox.extent()[1])  * 0.8F;
+      m_zoom =  min(window->Size[0] / _bbox.extent()[0], window->Size[1] / _bbox.extent()[1])  * 0.8F;
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void NodeEditor::stepLoading() {
+    if (m_loader && m_loader->step(c_load_budget)) {
+      finishLoading();
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void NodeEditor::finishLoading() {
+    if (!m_loader) {
+      return;
+    }
+    m_loader->finish();
+    m_loader.reset();
+    m_loading_previous.reset();
+    if (!m_loading_path.empty()) {
+      m_graphPath = m_loading_path;
+      openJournal(false);
     }
   }
 
+  //-------------------------------------------------------
+
+  void NodeEditor::cancelLoading() {
+    if (!m_loader) {
+      return;
+    }
+    setMainGraph(m_loading_previous);
+    m_loader.reset();
+    m_loading_previous.reset();
+    // closed by loadGraph, the previous graph is saved to its file again
+    openJournal(false);
+  }
+
+  //-------------------------------------------------------
+
+  void NodeEditor::drawLoading() {
+    // centered on the part of the graph view inside the window
+    ImGui::SetNextWindowPos(ImVec2(200 + (m_size.x - 200) / 2.0F, 20 + (m_size.y - 20) / 2.0F), ImGuiCond_Always, ImVec2(0.5F, 0.5F));
+    ImGui::Begin("Loading", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings);
+    std::string count = std::to_string(m_loader->created()) + " / " + std::to_string(m_loader->total()) + " nodes";
+    ImGui::Text("Loading graph");
+    ImGui::ProgressBar(m_loader->progress(), ImVec2(200, 0), count.c_str());
+    if (ImGui::Button("Cancel")) {
+      cancelLoading();
+    }
+    ImGui::End();
+  }
+
+  //-------------------------------------------------------
+
+  void NodeEditor::openJournal(bool _saved) {
+    // binary graphs are written whole, GraphBinary::save is already atomic
+    if (m_graphPath.empty() || m_graphPath.extension() == GraphBinary::c_extension) {
+      return;
+    }
+    m_journal.open(m_graphPath, *getMainGraph(), _saved);
+  }
+
+  //-------------------------------------------------------
+
+  void NodeEditor::saveGraph(ProcessingGraph& _graph, const fs::path& _path) {
+    if (_path.extension() == GraphBinary::c_extension) {
+      GraphBinary::save(GraphData::capture(_graph), _path);
+      return;
+    }
+    LuaWriter writer;
+    _graph.save(writer);
+    m_lua_bytes         += writer.size();
+    m_lua_reallocations += writer.reallocations();
+    if (!writer.save(_path)) {
+      std::cerr << Console::red << "Cannot write " << _path.string() << Console::gray << std::endl;
+    }
+  }
 
   //-------------------------------------------------------
 
   NodeEditor::NodeEditor() {
+    NodeLibrary::Instance().setFolder(NodesFolder(), ChillFolder() + "/chill-nodes.index");
     m_graphs.push(std::shared_ptr<ProcessingGraph>(new ProcessingGraph()));
   }
 
@@ -302,6 +444,7 @@ namespace chill
       if (fs::exists(filepath.c_str())) {
         const fs::path path = fs::path(filepath);
         s_instance->loadGraph(&path);
+        s_instance->finishLoading();
       }
     }
     return s_instance;
@@ -313,6 +456,7 @@ namespace chill
     glClearColor(0.F, 0.F, 0.F, 0.F);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    Instance()->m_recorder.frame(ImGui::GetIO());
     Instance()->draw();
 
     ImGui::Render();
@@ -339,13 +483,14 @@ namespace chill
   //-------------------------------------------------------
   void NodeEditor::mainOnResize(uint width, uint height)
   {
-    Instance()->m_size = ImVec2(static_cast<float>(width), static_cast<float>(height));
+    Instance()->m_size = Vec2(static_cast<float>(width), static_cast<float>(height));
     Instance()->moveIceSLWindowAlongChill(false,false);
   }
 
   //-------------------------------------------------------
-  void NodeEditor::mainKeyPressed(uchar /*_k*/)
+  void NodeEditor::mainKeyPressed(uchar _k)
   {
+    Instance()->m_recorder.character(_k);
   }
 
   //-------------------------------------------------------
@@ -388,26 +533,71 @@ namespace chill
     /*if (m_docking_icesl && m_icesl_hwnd) {
       SetWindowLongPtr(m_icesl_hwnd, GWL_STYLE, WS_VISIBLE | WS_CHILD);
     }*/
+    m_profiler.beginFrame();
+
+    stepLoading();
+    m_journal.poll();
+
     drawMenuBar();
     ImGui::SetNextWindowPos(ImVec2(0, 20));
     ImGui::SetNextWindowSize(ImVec2(200, m_size.y - 20));
     drawLeftMenu();
 
     ImGui::SetNextWindowPos(ImVec2(200, 20));
-    ImGui::SetNextWindowSize(m_size);
+    ImGui::SetNextWindowSize(toImGui(m_size));
     drawGraph();
 
+    if (m_loader) {
+      drawLoading();
+    }
+
+    if (m_show_profiler) {
+      m_profiler.draw(&m_show_profiler, ChillFolder() + "/chill-profile.csv");
+    }
+
     //for docking
     updateIceSLPosRatio();
     showIceSL();
 
+    m_profiler.endFrame();
+
     return true;
   }
 
+  //-------------------------------------------------------
+  NodeCatalog& NodeEditor::nodeCatalog()
+  {
+    if (m_catalog.root().empty()) {
+      m_catalog.setRoot(NodesFolder());
+    } else {
+      m_catalog.update();
+    }
+    return m_catalog;
+  }
+
+  //-------------------------------------------------------
+  NodeIndex& NodeEditor::nodeIndex()
+  {
+    return NodeLibrary::Instance().index();
+  }
+
+  //-------------------------------------------------------
+  void NodeEditor::drawGraphView(const ImVec2& _size)
+  {
+    m_size = toVec2(_size);
+    m_profiler.beginFrame();
+
+    ImGui::SetNextWindowPos(ImVec2(200, 20));
+    ImGui::SetNextWindowSize(toImGui(m_size));
+    drawGraph();
+
+    m_profiler.endFrame();
+  }
+
   //-------------------------------------------------------
   void NodeEditor::drawMenuBar()
   {
-    ImGui::PushStyleColor(ImGuiCol_MenuBarBg, style.menubar_color);
+    ImGui::PushStyleColor(ImGuiCol_MenuBarBg, toImGui(style.menubar_color));
 
     if (ImGui::BeginMainMenuBar()) {
       // opening file
@@ -417,12 +607,11 @@ namespace chill
           std::string graph_filename = getMainGraph()->name() + ".graph";
           fullpath = saveFileDialog(graph_filename.c_str(), OFD_FILTER_GRAPHS);
           if (!fullpath.empty()) {
-            std::ofstream file;
-            file.open(fullpath);
+            m_journal.close(*getMainGraph());
             setMainGraph(std::shared_ptr<ProcessingGraph>(new ProcessingGraph()));
-            getMainGraph()->save(file);
-            file.close();
+            saveGraph(*getMainGraph(), fullpath);
             m_graphPath = fullpath;
+            openJournal(true);
           }
         }
         if (ImGui::MenuItem("Load graph")) {
@@ -452,11 +641,10 @@ namespace chill
           std::string graph_filename = getMainGraph()->name() + ".graph";
           fullpath = saveFileDialog(graph_filename.c_str(), OFD_FILTER_GRAPHS);
           if (!fullpath.empty()) {
-            std::ofstream file;
-            file.open(fullpath);
-            getMainGraph()->save(file);
-            file.close();
+            m_journal.close(*getMainGraph());
+            saveGraph(*getMainGraph(), fullpath);
             m_graphPath = fullpath;
+            openJournal(true);
           }
         }
         /*
@@ -464,10 +652,7 @@ namespace chill
           std::string graph_filename = getCurrentGraph()->name() + ".graph";
           fullpath = saveFileDialog(graph_filename.c_str(), OFD_FILTER_GRAPHS);
           if (!fullpath.empty()) {
-            std::ofstream file;
-            file.open(fullpath);
-            getCurrentGraph()->save(file);
-            file.close();
+            saveGraph(*getCurrentGraph(), fullpath);
           }
         }
         */
@@ -484,7 +669,33 @@ namespace chill
       if (ImGui::BeginMenu("Settings")) {
         ImGui::MenuItem("Automatic save", "", &m_auto_save);
         ImGui::MenuItem("Automatic export", "", &m_auto_export);
+        ImGui::MenuItem("Export only the edits changing shapes", "", &m_skip_value_exports);
+        ImGui::MenuItem("Export the values of constant nodes", "", &m_fold_constants);
+        ImGui::MenuItem("Export identical nodes once", "", &m_deduplicate);
+        ImGui::MenuItem("Keep node outputs between IceSL runs", "", &m_memoize);
+        ImGui::MenuItem("Pass values through numbered slots", "", &m_slots);
+        if (ImGui::BeginMenu("Tweaks set in IceSL")) {
+          if (ImGui::MenuItem("None", "", m_ui_tweaks == ExportOptions::UI_NONE)) {
+            m_ui_tweaks = ExportOptions::UI_NONE;
+          }
+          if (ImGui::MenuItem("Of the selected nodes", "", m_ui_tweaks == ExportOptions::UI_SELECTED)) {
+            m_ui_tweaks = ExportOptions::UI_SELECTED;
+          }
+          if (ImGui::MenuItem("All", "", m_ui_tweaks == ExportOptions::UI_ALL)) {
+            m_ui_tweaks = ExportOptions::UI_ALL;
+          }
+          ImGui::EndMenu();
+        }
+        if (m_export_count > 0) {
+          ImGui::TextDisabled("last export: %d nodes, %d folded, %d deduplicated, %d memoized",
+            int(m_export_stats.nodes), int(m_export_stats.folded), int(m_export_stats.deduplicated), int(m_export_stats.memoized));
+        }
         ImGui::MenuItem("Automatic use of IceSL", "", &m_auto_icesl);
+        if (ImGui::MenuItem("Run nodes to read their inputs", "", &m_sandbox_nodes)) {
+          NodeLibrary::Instance().setExtractor(m_sandbox_nodes ? NodeIndex::SANDBOX : NodeIndex::LEXER);
+        }
+        ImGui::Separator();
+        ImGui::MenuItem("Show profiler", "", &m_show_profiler);
         ImGui::EndMenu();
       }
 
@@ -585,10 +796,10 @@ namespace chill
 
       ImGui::Text("Color:");
       ImGuiColorEditFlags flags = ImGuiColorEditFlags_RGB | ImGuiColorEditFlags_NoSidePreview | ImGuiColorEditFlags_NoPicker | ImGuiColorEditFlags_AlphaPreview | ImGuiColorEditFlags_AlphaBar;
-      ImVec4 col = ImGui::ColorConvertU32ToFloat4(object->color());
+      ImVec4 col = ImGui::ColorConvertU32ToFloat4(toImGui(object->color()));
       float color[4] = { col.x, col.y , col.z , col.w };
       if (ImGui::ColorPicker4(("##color" + std::to_string(object->getUniqueID())).c_str(), color, flags)) {
-        object->setColor(ImGui::ColorConvertFloat4ToU32(ImVec4(color[0], color[1], color[2], color[3])));
+        object->setColor(toColor(ImVec4(color[0], color[1], color[2], color[3])));
       }
       
       /*
@@ -612,10 +823,7 @@ namespace chill
 
     ImGui::InputTextWithHint("##", "search", leftMenuSearch,  64);
 
-    std::locale loc;
-    for( auto& elem: leftMenuSearch)
-       elem = std::tolower(elem, loc);
-    addNodeLeftMenu(s2g, leftMenuSearch);
+    addNodeLeftMenu(s2g, NodeCatalog::toLower(leftMenuSearch));
 
 
     ImGui::End();
@@ -627,7 +835,7 @@ namespace chill
 
     linking = m_selected_input || m_selected_output;
 
-    ImGui::PushStyleColor(ImGuiCol_WindowBg, style.graph_bg_color);
+    ImGui::PushStyleColor(ImGuiCol_WindowBg, toImGui(style.graph_bg_color));
     ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0.0F);
     ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
 
@@ -657,22 +865,29 @@ namespace chill
     ImVec2 offset = (m_offset * m_zoom + (w_size - w_pos) / 2.0F);
 
     if (ImGui::IsWindowHovered()) {
+      m_profiler.begin(FrameProfiler::HIT_TEST);
+
       // clear data
       hovered.clear();
       selected.clear();
       text_editing = false;
 
-      for (std::shared_ptr<Processor> processor : *m_graphs.top()->processors()) {
-        ImVec2 socket_size = ImVec2(1, 1) * (style.socket_radius + style.socket_border_width) * m_zoom;
+      std::vector<std::shared_ptr<Processor>>& processors = *m_graphs.top()->processors();
 
-        ImVec2 size = processor->m_size * m_zoom;
-        ImVec2 min_pos = offset + w_pos + processor->m_position * m_zoom - socket_size;
-        ImVec2 max_pos = min_pos + size + socket_size * 2;
+      refreshGeometry();
 
-        if (ImGui::IsMouseHoveringRect(min_pos, max_pos)) {
-          hovered.push_back(std::shared_ptr<SelectableUI>(processor));
-        }
+      // hit test all the node rectangles at once, in graph space, within the clip rect of the window
+      ImVec2 mouse  = (io.MousePos - offset - w_pos) / m_zoom;
+      float  margin = style.socket_radius + style.socket_border_width;
+      m_hits.clear();
+      if (ImGui::IsMouseHoveringRect(w_pos, w_pos + w_size)) {
+        m_geometry.hitPoint(mouse, margin, m_hits);
+      }
+      for (uint32_t i : m_hits) {
+        hovered.push_back(std::shared_ptr<SelectableUI>(processors[i]));
+      }
 
+      for (std::shared_ptr<Processor> processor : processors) {
         if (processor->m_selected) {
           selected.push_back(std::shared_ptr<SelectableUI>(processor));
         }
@@ -685,8 +900,8 @@ namespace chill
       for (std::shared_ptr<VisualComment> comment : m_graphs.top()->comments()) {
         ImVec2 socket_size = ImVec2(1, 1) * (style.socket_radius + style.socket_border_width) * m_zoom;
 
-        ImVec2 size = comment->m_title_size * m_zoom;
-        ImVec2 min_pos = offset + w_pos + comment->m_position * m_zoom - socket_size;
+        ImVec2 size = toImGui(comment->m_title_size) * m_zoom;
+        ImVec2 min_pos = offset + w_pos + toImGui(comment->m_position) * m_zoom - socket_size;
         ImVec2 max_pos = min_pos + size + socket_size * 2;
 
         if (ImGui::IsMouseHoveringRect(min_pos, max_pos)) {
@@ -702,6 +917,8 @@ namespace chill
         }
       }
 
+      m_profiler.end(FrameProfiler::HIT_TEST);
+
       // LEFT CLICK
       if (linking) {
         m_selecting = false;
@@ -719,7 +936,7 @@ namespace chill
             std::shared_ptr<ProcessingGraph> v = std::dynamic_pointer_cast<ProcessingGraph>(hovproc);
             if (v && !v->m_edit) {
               m_graphs.push(v);
-              m_offset = m_graphs.top()->getBarycenter() * -1.0F;
+              m_offset = toImGui(m_graphs.top()->getBarycenter()) * -1.0F;
               break;
             }
           }
@@ -779,14 +996,14 @@ namespace chill
       if (m_dragging) {
         if (!io.KeysDown[LIBSL_KEY_CTRL]) {
           for (std::shared_ptr<SelectableUI> object : selected) {
-            object->translate(io.MouseDelta / m_zoom);
+            object->translate(toVec2(io.MouseDelta / m_zoom));
           }
         }
         else {
           for (std::shared_ptr<SelectableUI> object : selected) {
             std::shared_ptr<VisualComment> com = std::static_pointer_cast<VisualComment>(object);
             if (com)
-              object->m_size += io.MouseDelta / m_zoom;
+              object->m_size += toVec2(io.MouseDelta / m_zoom);
           }
         }
       }
@@ -850,25 +1067,27 @@ namespace chill
     // Draw the grid
     if (m_show_grid)
     {
+      FrameProfiler::Scope scope(m_profiler, FrameProfiler::GRID);
       drawGrid();
     }
     std::shared_ptr<ProcessingGraph> currentGraph = m_graphs.top();
 
     // Draw visual comment
     for (std::shared_ptr<VisualComment> comment : currentGraph->comments()) {
-      ImVec2 position = offset + comment->m_position * m_zoom;
+      ImVec2 position = offset + toImGui(comment->m_position) * m_zoom;
       ImGui::SetCursorPos(position);
-      comment->draw();
+      NodeRenderer::draw(*comment);
     }
 
     // Draw the pipes
+    m_profiler.begin(FrameProfiler::PIPES);
     float pipe_width = style.pipe_line_width * m_zoom;
     int pipe_res = static_cast<int>(20 * m_zoom);
     for (std::shared_ptr<Processor> processor : *currentGraph->processors()) {
       for (std::shared_ptr<ProcessorOutput> output : processor->outputs()) {
         for (std::shared_ptr<ProcessorInput> input : output->m_links) {
-          ImVec2 A = input->getPosition()  + w_pos - ImVec2(pipe_width / 4.F, 0.F);
-          ImVec2 B = output->getPosition() + w_pos + ImVec2(pipe_width / 4.F, 0.F);
+          ImVec2 A = toImGui(input->getPosition()) + w_pos - ImVec2(pipe_width / 4.F, 0.F);
+          ImVec2 B = toImGui(output->getPosition()) + w_pos + ImVec2(pipe_width / 4.F, 0.F);
 
           float dist = sqrt( (A-B).x * (A-B).x + (A-B).y * (A-B).y);
 
@@ -880,7 +1099,7 @@ namespace chill
             B + bezier,
             B,
             //processor->color(),
-            input->color(),
+            toImGui(input->color()),
             pipe_width,
             pipe_res
           );
@@ -898,11 +1117,14 @@ namespace chill
             ImVec2 W = center - norm_vec;
             std::swap(V.x, W.x);
 
-            ImGui::GetWindowDrawList()->AddTriangleFilled(U, V, W, input->color());
+            ImGui::GetWindowDrawList()->AddTriangleFilled(U, V, W, toImGui(input->color()));
           }
         }
       }
     }
+    m_profiler.end(FrameProfiler::PIPES);
+
+    m_profiler.begin(FrameProfiler::NODES);
 
     if (selected.size() == 1) { // ToDo : """this is a QUICK FIX""" Make this work for N nodes
       std::sort(
@@ -911,12 +1133,13 @@ namespace chill
       );
     }
 
-    // Draw the nodes
+    // Draw the nodes, their rectangles are refreshed before the next hit test
     for (std::shared_ptr<Processor> processor : *currentGraph->processors()) {
-      ImVec2 position = offset + processor->m_position * m_zoom;
+      ImVec2 position = offset + toImGui(processor->m_position) * m_zoom;
       ImGui::SetCursorPos(position);
-      processor->draw();
+      NodeRenderer::draw(*processor);
     }
+    m_profiler.end(FrameProfiler::NODES);
 
 
 
@@ -926,11 +1149,11 @@ namespace chill
       ImVec2 B = ImGui::GetMousePos();
 
       if (m_selected_input) {
-        A = w_pos + m_selected_input->getPosition();
+        A = w_pos + toImGui(m_selected_input->getPosition());
         A -= ImVec2(pipe_width / 4.F, 0.F);
       }
       else if (m_selected_output) {
-        B = w_pos + m_selected_output->getPosition();
+        B = w_pos + toImGui(m_selected_output->getPosition());
         B += ImVec2(pipe_width / 4.F, 0.F);
       }
 
@@ -940,13 +1163,13 @@ namespace chill
         A - bezier,
         B + bezier,
         B,
-        style.pipe_selected_color,
+        toImGui(style.pipe_selected_color),
         pipe_width,
         pipe_res
       );
 
-      ImGui::GetWindowDrawList()->AddCircleFilled(A, pipe_width / 2.0F, style.pipe_selected_color);
-      ImGui::GetWindowDrawList()->AddCircleFilled(B, pipe_width / 2.0F, style.pipe_selected_color);
+      ImGui::GetWindowDrawList()->AddCircleFilled(A, pipe_width / 2.0F, toImGui(style.pipe_selected_color));
+      ImGui::GetWindowDrawList()->AddCircleFilled(B, pipe_width / 2.0F, toImGui(style.pipe_selected_color));
     }
 
 
@@ -960,32 +1183,60 @@ namespace chill
   
 
 
+    // a graph being loaded stays dirty, it is saved and exported once complete
     bool wasDirty = false;
-    for (std::shared_ptr<Processor> processor : *m_graphs.top()->processors()) {
-      if (processor->isDirty()) {
-        wasDirty = true;
-        processor->setDirty(false);
+    std::vector<Processor*> changed;
+    if (!m_loader) {
+      for (std::shared_ptr<Processor> processor : *m_graphs.top()->processors()) {
+        if (processor->isDirty()) {
+          wasDirty = true;
+          changed.push_back(processor.get());
+          processor->setDirty(false);
+        }
       }
     }
 
     if (wasDirty) {
-      modify();
-      if (m_auto_export) {
+      {
+        FrameProfiler::Scope scope(m_profiler, FrameProfiler::UNDO);
+        modify();
+      }
+      // values are shown in Chill, IceSL only needs the edits that change shapes
+      bool shapes = true;
+      {
+        FrameProfiler::Scope scope(m_profiler, FrameProfiler::EVALUATE);
+        m_evaluator.update(*getMainGraph());
+        shapes = !m_skip_value_exports || ScalarEvaluator::affectsShapes(changed);
+      }
+      // the tweaks set in IceSL need no export, only the changes of structure
+      if (shapes && m_ui_tweaks != ExportOptions::UI_NONE) {
+        ExportOptions options;
+        options.ui_tweaks = m_ui_tweaks;
+        shapes = GraphExporter::structure(*getMainGraph(), options) != m_exported_structure;
+      }
+      if (m_auto_export && shapes) {
+        FrameProfiler::Scope scope(m_profiler, FrameProfiler::EXPORT);
         exportIceSL(&m_iceSLTempExportPath);
       }
 
       if (m_auto_save) {
-        std::ofstream file;
-        file.open(m_graphPath);
-        m_graphs.top()->save(file);
+        FrameProfiler::Scope scope(m_profiler, FrameProfiler::SAVE);
+        if (m_journal.isOpen()) {
+          m_journal.record(*getMainGraph());
+        } else {
+          saveGraph(*m_graphs.top(), m_graphPath);
+        }
+        m_save_count++;
       }
     }
-    
+    followSelection();
     
     window->FontWindowScale = 1.0F;
     //DO NOT CHANGE ORDER OF THE FOLLOWING TWO FUNCTIONS !
+    m_profiler.begin(FrameProfiler::MENUS);
     shortcutsAction();
     menus();
+    m_profiler.end(FrameProfiler::MENUS);
     window->FontWindowScale = m_zoom;
 
     ImGui::End(); // Graph
@@ -1032,7 +1283,7 @@ namespace chill
     ImVec2 offset = (m_offset * m_zoom + (window->Size - window->Pos) / 2.F);
     ImDrawList* draw_list = ImGui::GetWindowDrawList();
 
-    const ImU32& grid_Color      = style.graph_grid_color;
+    const ImU32  grid_Color      = toImGui(style.graph_grid_color);
     const float& grid_Line_width = style.graph_grid_line_width;
 
     const int subdiv = m_zoom >= 1.0F ? 10 : 100;
@@ -1101,10 +1352,7 @@ namespace chill
       if (ImGui::BeginMenu("Add", "SPACE")) {
       */
 
-      std::locale loc;
-      for( auto& elem: search)
-         elem = std::tolower(elem, loc);
-      addNodeMenu(s2g, search);
+      addNodeMenu(s2g, NodeCatalog::toLower(search));
       /*
         ImGui::EndMenu();
       }
@@ -1200,7 +1448,7 @@ namespace chill
       draw_list->AddRect(
         io.MouseClickedPos[0],
         io.MousePos,
-        style.processor_selected_color
+        toImGui(style.processor_selected_color)
       );
 
       if (!io.KeysDown[LIBSL_KEY_SHIFT]) {
@@ -1214,17 +1462,19 @@ namespace chill
         return !(min.x < A.x || B.x < max.x || min.y < A.y || B.y < max.y);
       };
 
-      for (std::shared_ptr<Processor> procui : *n_e->getCurrentGraph()->processors()) {
-        ImVec2 pos_min = procui->getPosition();
-        ImVec2 pos_max = pos_min + procui->m_size;
-        procui->m_selected = isInside(pos_min, pos_max, A, B);
-        if (procui->m_selected)
-          selected.push_back(std::shared_ptr<SelectableUI>(procui));
+      std::vector<std::shared_ptr<Processor>>& processors = *n_e->getCurrentGraph()->processors();
+      FrameProfiler::Scope scope(m_profiler, FrameProfiler::HIT_TEST);
+      refreshGeometry();
+      m_geometry.hitBox(A, B, m_inside);
+      for (size_t i = 0; i < processors.size(); ++i) {
+        processors[i]->m_selected = i < m_inside.size() && m_inside[i];
+        if (processors[i]->m_selected)
+          selected.push_back(std::shared_ptr<SelectableUI>(processors[i]));
       }
 
       for (std::shared_ptr<VisualComment> comui : n_e->getCurrentGraph()->comments()) {
-        ImVec2 pos_min = comui->getPosition();
-        ImVec2 pos_max = pos_min + comui->m_size;
+        ImVec2 pos_min = toImGui(comui->getPosition());
+        ImVec2 pos_max = pos_min + toImGui(comui->m_size);
         comui->m_selected = isInside(pos_min, pos_max, A, B);
         if (comui->m_selected)
           selected.push_back(std::shared_ptr<SelectableUI>(comui));
@@ -1232,6 +1482,16 @@ namespace chill
     }
   }
 
+  //-------------------------------------------------------
+  void NodeEditor::refreshGeometry() {
+    // the rectangles as they are now, the last frame moved and reordered the nodes
+    std::vector<std::shared_ptr<Processor>>& processors = *m_graphs.top()->processors();
+    m_geometry.resize(processors.size());
+    for (size_t i = 0; i < processors.size(); ++i) {
+      m_geometry.set(i, toImGui(processors[i]->m_position), toImGui(processors[i]->m_size));
+    }
+  }
+
   //-------------------------------------------------------
   void NodeEditor::shortcutsAction() {
     ImGuiIO      io = ImGui::GetIO();
@@ -1343,7 +1603,7 @@ namespace chill
     ImVec2 s2g = m2s / m_zoom - m_offset;
 
     std::shared_ptr<SelectableUI> copy_buff = buffer->clone();
-    getCurrentGraph()->expandGraph(buffer, s2g);
+    getCurrentGraph()->expandGraph(buffer, toVec2(s2g));
     for (std::shared_ptr<SelectableUI> selproc : selected) {
       selproc->m_selected = false;
     }
@@ -1469,76 +1729,29 @@ namespace chill
   //-------------------------------------------------------
   void NodeEditor::exportIceSL(const fs::path* filename) {
     if (!filename->empty()) {
-      std::ofstream file;
-      file.open(*filename);
-
-      // TODO: CLEAN THIS !!!
-
-      file <<
-        "enable_variable_cache = false" << std::endl <<
-        std::endl <<
-        "local _G0 = {}       --swap environnement(swap variables between scripts)" << std::endl <<
-        "local _Gcurrent = {} --environment local to the script : _Gc includes _G0" << std::endl <<
-        "local __dirty = {}   --table of all dirty nodes" << std::endl <<
-        "__input = {}         --table of all input values" << std::endl <<
-        "" << std::endl <<
-        "setmetatable(_G0, { __index = _G })" << std::endl <<
-        "" << std::endl <<
-        "function setNodeId(id)" << std::endl <<
-        "  setfenv(1, _G0)" << std::endl <<
-        "  __currentNodeId = id" << std::endl <<
-        "  setfenv(1, _Gcurrent)" << std::endl <<
-        "end" << std::endl <<
-        "" << std::endl <<
-        "function setColor(...) end" << std::endl <<
-        "" << std::endl <<
-        "function data(name, type, ...)" << std::endl <<
-        "  return __input[name][1]" << std::endl <<
-        "end" << std::endl <<
-        "" << std::endl <<
-        "function input(name, type, ...)" << std::endl <<
-        "  return __input[name][1]" << std::endl <<
-        "end" << std::endl <<
-        "" << std::endl <<
-        "function getNodeId(name)" << std::endl <<
-        "  return __input[name][2]" << std::endl <<
-        "end" << std::endl <<
-        "function output(name, type, val)" << std::endl <<
-        "  setfenv(1, _G0)" << std::endl <<
-        "  if (isDirty({ __currentNodeId })) then" << std::endl <<
-        "    _G[name..__currentNodeId] = val" << std::endl <<
-        "  end" << std::endl <<
-        "  setfenv(1, _Gcurrent)" << std::endl <<
-        "end" << std::endl <<
-        "" << std::endl <<
-        "function setDirty(node)" << std::endl <<
-        "  __dirty[node] = true" << std::endl <<
-        "end" << std::endl <<
-        "" << std::endl <<
-        "function isDirty(nodes)" << std::endl <<
-        "  if first_exec then" << std::endl <<
-        "    return true" << std::endl <<
-        "  end" << std::endl <<
-        "    " << std::endl <<
-        "  if #nodes == 0 then" << std::endl <<
-        "    return false" << std::endl <<
-        "  else" << std::endl <<
-        "    local node = table.remove(nodes, 1)" << std::endl <<
-        "    if node == NIL then node = nil end" << std::endl <<
-        "    return __dirty[node] or isDirty(nodes)" << std::endl <<
-        "  end" << std::endl <<
-        "end" << std::endl <<
-        "" << std::endl <<
-        "if first_exec == nil then" << std::endl <<
-        "  first_exec = true" << std::endl <<
-        "else" << std::endl <<
-        "  first_exec = false" << std::endl <<
-        "end" << std::endl <<
-        "" << std::endl <<
-        "emit(Void)" << std::endl <<
-        "------------------------------------------------------" << std::endl;
-      getMainGraph()->iceSL(file);
-      file.close();
+      m_export_count++;
+      ExportOptions options;
+      options.fold_constants = m_fold_constants;
+      options.deduplicate    = m_deduplicate;
+      options.memo_entries   = m_memoize ? c_memo_entries : 0;
+      options.slots          = m_slots;
+      options.output_slots   = &m_output_slots;
+      options.ui_tweaks      = m_ui_tweaks;
+      if (m_fold_constants) {
+        // mostly cached, the values are up to date after an edit
+        m_evaluator.update(*getMainGraph());
+        options.evaluator = &m_evaluator;
+      }
+      LuaWriter writer;
+      m_export_stats = GraphExporter::write(*getMainGraph(), writer, options);
+      if (m_ui_tweaks != ExportOptions::UI_NONE) {
+        m_exported_structure = GraphExporter::structure(*getMainGraph(), options);
+      }
+      m_lua_bytes         += writer.size();
+      m_lua_reallocations += writer.reallocations();
+      if (!writer.save(*filename)) {
+        std::cerr << Console::red << "Cannot write " << filename->string() << Console::gray << std::endl;
+      }
     }
   }
 
@@ -1558,6 +1771,13 @@ namespace chill
     f << "auto_save " << m_auto_save << std::endl;
     f << "auto_export " << m_auto_export << std::endl;
     f << "auto_launch_icesl " << m_auto_icesl << std::endl;
+    f << "sandbox_nodes " << m_sandbox_nodes << std::endl;
+    f << "skip_value_exports " << m_skip_value_exports << std::endl;
+    f << "fold_constants " << m_fold_constants << std::endl;
+    f << "deduplicate " << m_deduplicate << std::endl;
+    f << "memoize " << m_memoize << std::endl;
+    f << "slots " << m_slots << std::endl;
+    f << "ui_tweaks " << int(m_ui_tweaks) << std::endl;
     f << "icesl_is_docked " << m_icesl_is_docked << std::endl;
     f << "ratio_iceslx " << m_ratio_icesl.x << std::endl;
     f << "ratio_icesly " << m_ratio_icesl.y << std::endl;
@@ -1588,6 +1808,27 @@ namespace chill
         if (setting == "auto_launch_icesl") {
           m_auto_icesl = (std::stoi(value) ? true : false);
         }
+        if (setting == "sandbox_nodes") {
+          m_sandbox_nodes = (std::stoi(value) ? true : false);
+        }
+        if (setting == "skip_value_exports") {
+          m_skip_value_exports = (std::stoi(value) ? true : false);
+        }
+        if (setting == "fold_constants") {
+          m_fold_constants = (std::stoi(value) ? true : false);
+        }
+        if (setting == "deduplicate") {
+          m_deduplicate = (std::stoi(value) ? true : false);
+        }
+        if (setting == "memoize") {
+          m_memoize = (std::stoi(value) ? true : false);
+        }
+        if (setting == "slots") {
+          m_slots = (std::stoi(value) ? true : false);
+        }
+        if (setting == "ui_tweaks") {
+          m_ui_tweaks = ExportOptions::UiTweaks(std::min(std::max(std::stoi(value), 0), int(ExportOptions::UI_ALL)));
+        }
         if (setting == "icesl_is_docked") {
           m_icesl_start_docked = (std::stoi(value) ? true : false);
         }
@@ -1606,6 +1847,7 @@ namespace chill
       }
       f.close();
     }
+    NodeLibrary::Instance().setExtractor(m_sandbox_nodes ? NodeIndex::SANDBOX : NodeIndex::LEXER);
   }
 
   //-------------------------------------------------------
@@ -1647,7 +1889,7 @@ namespace chill
   }
 
   //-------------------------------------------------------
-  void NodeEditor::launch()
+  void NodeEditor::launch(const std::string& _session)
   {
 
     NodeEditor *nodeEditor = Instance();
@@ -1655,6 +1897,17 @@ namespace chill
     nodeEditor->loadSettings();
     nodeEditor->SetIceslPath();
 
+    // check the whole node library at once, only new or modified files are parsed
+    {
+      NodeCatalog& catalog = nodeEditor->nodeCatalog();
+      std::vector<std::string> nodepaths;
+      for (const NodeCatalog::Node& node : catalog.nodes()) {
+        nodepaths.push_back(node.path.substr(catalog.root().size()));
+      }
+      nodeEditor->nodeIndex().refresh(nodepaths);
+      nodeEditor->nodeIndex().save();
+    }
+
     // create the temp file
     nodeEditor->exportIceSL(&(Instance()->m_iceSLTempExportPath));
 
@@ -1690,15 +1943,32 @@ namespace chill
         nodeEditor->setDefaultAppsPos();
       }
 
+      if (!_session.empty()) {
+        LuaWriter writer;
+        nodeEditor->getMainGraph()->save(writer);
+
+        SessionRecorder::Session start;
+        start.graph       = writer.str();
+        start.offset      = nodeEditor->m_offset;
+        start.zoom        = nodeEditor->m_zoom;
+        start.auto_save   = nodeEditor->m_auto_save;
+        start.auto_export = nodeEditor->m_auto_export;
+        nodeEditor->m_recorder.start(_session, start);
+      }
+
       // main loop
       SimpleUI::loop();
 
+      nodeEditor->m_recorder.stop();
+
       if (nodeEditor->m_auto_icesl) {
         // closing Icesl
         std::atexit(closeIcesl);
       }
 
+      nodeEditor->m_journal.close(*nodeEditor->getMainGraph());
       nodeEditor->saveSettings();
+      nodeEditor->nodeIndex().save();
 
       // clean up
       SimpleUI::terminateImGui();
@@ -1712,6 +1982,109 @@ namespace chill
     }
   }
 
+  //-------------------------------------------------------
+  namespace {
+    void countNodes(ProcessingGraph& _graph, size_t& _nodes, size_t& _ios) {
+      for (std::shared_ptr<Processor> processor : *_graph.processors()) {
+        _nodes++;
+        _ios += processor->inputs().size() + processor->outputs().size();
+        std::shared_ptr<ProcessingGraph> group = std::dynamic_pointer_cast<ProcessingGraph>(processor);
+        if (group) {
+          countNodes(*group, _nodes, _ios);
+        }
+      }
+    }
+  }
+
+  int NodeEditor::replay(const std::string& _session)
+  {
+    SessionRecorder::Session session;
+    if (!SessionRecorder::load(_session, session)) {
+      return 1;
+    }
+
+    NodeEditor *nodeEditor = Instance();
+
+    // everything written during the replay goes to temporary files
+    fs::path folder = fs::temp_directory_path();
+    fs::path graph  = folder / "chill-replay.graph";
+    {
+      std::ofstream file(graph, std::ios::binary);
+      file.write(session.graph.data(), static_cast<std::streamsize>(session.graph.size()));
+    }
+    nodeEditor->m_iceSLTempExportPath = folder / "chill-replay.lua";
+
+    ImVec2 size = session.frames.empty()
+      ? ImVec2(static_cast<float>(nodeEditor->default_width), static_cast<float>(nodeEditor->default_height))
+      : session.frames.front().display_size;
+    HeadlessUI headless(size);
+
+    nodeEditor->loadGraph(&graph, true);
+    nodeEditor->finishLoading();
+    nodeEditor->m_offset      = session.offset;
+    nodeEditor->m_zoom        = session.zoom;
+    nodeEditor->m_auto_save   = session.auto_save;
+    nodeEditor->m_auto_export = session.auto_export;
+    nodeEditor->m_undo.clear();
+    nodeEditor->m_redo.clear();
+    nodeEditor->m_export_count = 0;
+    nodeEditor->m_save_count   = 0;
+    nodeEditor->m_lua_bytes    = 0;
+    nodeEditor->m_lua_reallocations = 0;
+    size_t journal_bytes     = nodeEditor->m_journal.bytes();
+    int    journal_snapshots = nodeEditor->m_journal.snapshots();
+
+    std::vector<double> times;
+    times.reserve(session.frames.size());
+    for (const SessionRecorder::Frame& frame : session.frames) {
+      SessionRecorder::apply(frame, ImGui::GetIO());
+      nodeEditor->m_size = toVec2(frame.display_size);
+
+      auto start = std::chrono::high_resolution_clock::now();
+      headless.newFrame(frame.delta_time);
+      nodeEditor->draw();
+      headless.render();
+      times.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+    }
+
+    // undo footprint: nodes kept alive by the snapshots, and their size once saved
+    size_t undo_nodes = 0, undo_ios = 0;
+    uintmax_t undo_bytes = 0;
+    LuaWriter snapshot;
+    for (std::shared_ptr<ProcessingGraph> undo : nodeEditor->m_undo) {
+      countNodes(*undo, undo_nodes, undo_ios);
+      snapshot.clear();
+      undo->save(snapshot);
+      undo_bytes += snapshot.size();
+    }
+
+    double total = 0.0;
+    for (double t : times) total += t;
+    std::vector<double> sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double _p) {
+      return sorted.empty() ? 0.0 : sorted[static_cast<size_t>(_p * (sorted.size() - 1))];
+    };
+
+    std::cout << "session         " << _session << std::endl;
+    std::cout << "frames          " << times.size() << std::endl;
+    std::cout << "total ms        " << total << std::endl;
+    std::cout << "frame ms        mean " << (times.empty() ? 0.0 : total / times.size())
+              << "  p50 " << percentile(0.5) << "  p95 " << percentile(0.95) << "  max " << percentile(1.0) << std::endl;
+    std::cout << "exports         " << nodeEditor->m_export_count << std::endl;
+    std::cout << "auto saves      " << nodeEditor->m_save_count << std::endl;
+    std::cout << "lua written     " << nodeEditor->m_lua_bytes << " bytes (" << nodeEditor->m_lua_reallocations << " buffer growths)" << std::endl;
+    std::cout << "journal         " << nodeEditor->m_journal.bytes() - journal_bytes << " bytes, "
+              << nodeEditor->m_journal.snapshots() - journal_snapshots << " snapshots" << std::endl;
+    std::cout << "undo snapshots  " << nodeEditor->m_undo.size() << std::endl;
+    std::cout << "undo nodes      " << undo_nodes << " (" << undo_ios << " inputs/outputs, " << undo_bytes << " bytes saved)" << std::endl;
+
+    nodeEditor->m_journal.close(*nodeEditor->getMainGraph());
+    // the graph window belongs to the headless context
+    nodeEditor->m_graphWindow = nullptr;
+    return 0;
+  }
+
   //-------------------------------------------------------
 
   void NodeEditor::setDefaultAppsPos() {
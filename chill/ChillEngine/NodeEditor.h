@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+#include <unordered_set>
 #include <vector>
 #include <stack>
 
@@ -11,8 +13,20 @@
 #include <LibSL/LibSL_gl.h>
 
 #include "UI.h"
+#include "FrameProfiler.h"
+#include "GraphExporter.h"
+#include "GraphJournal.h"
+#include "GraphLoader.h"
+#include "ImGuiTypes.h"
+#include "NodeCatalog.h"
+#include "NodeGeometry.h"
+#include "NodeLibrary.h"
+#include "NodeRenderer.h"
+#include "OutputSlots.h"
 #include "Processor.h"
 #include "ProcessingGraph.h"
+#include "ScalarEvaluator.h"
+#include "SessionRecorder.h"
 
 
 
@@ -37,10 +51,30 @@ namespace fs = std::filesystem;
     const uint default_width = 800;
     const uint default_height = 600;
     const float c_zoom_motion_scale = 0.1f;
+    // milliseconds per frame spent creating the nodes of a graph being loaded
+    const double c_load_budget = 8.0;
 
     bool m_auto_save = true;
     bool m_auto_export = true;
     bool m_auto_icesl = true;
+    // extract node signatures by running the nodes, see NodeSandbox
+    bool m_sandbox_nodes = false;
+    // no export when an edit only changes values computed in Chill, see ScalarEvaluator
+    bool m_skip_value_exports = true;
+    // nodes computing constants exported as their values, see ExportOptions
+    bool m_fold_constants = false;
+    // identical nodes exported once, see ExportOptions
+    bool m_deduplicate = false;
+    // node outputs kept by IceSL between the runs of the script, see ExportOptions
+    bool m_memoize = false;
+    // values passed through numbered slots, see ExportOptions
+    bool m_slots = false;
+    // tweaks set in IceSL, exports only on changes of structure, see ExportOptions
+    ExportOptions::UiTweaks m_ui_tweaks = ExportOptions::UI_NONE;
+    // the structure of the last script, see GraphExporter::structure
+    uint64_t m_exported_structure = 0;
+    // the selected nodes that have tweaks, set in IceSL in UI_SELECTED mode
+    std::unordered_set<Processor*> m_tweaked;
 
     fs::path m_iceslPath           = "";
     fs::path m_graphPath           = "";
@@ -57,6 +91,7 @@ namespace fs = std::filesystem;
     bool   m_dragging     = false;
     bool   m_selecting    = false;
     bool   m_show_grid    = true;
+    bool   m_show_profiler = false;
 
     bool m_minimized         = false;
 
@@ -89,7 +124,41 @@ namespace fs = std::filesystem;
 
     static NodeEditor* Instance();
 
-    static void launch();
+    /**
+     *  Open the editor window and run until it is closed.
+     *  @param _session If not empty, the session is recorded in this file.
+     */
+    static void launch(const std::string& _session = "");
+
+    /**
+     *  Replay a recorded session without window and report the timings.
+     *  @param _session The session file.
+     *  @return The exit code of the program.
+     */
+    static int replay(const std::string& _session);
+
+    /**
+     *  Draw the graph view alone, inside an ImGui frame started by the caller.
+     *  Used to run the editor without any window, see HeadlessUI.
+     *  @param _size The size of the view.
+     */
+    void drawGraphView(const ImVec2& _size);
+
+    const FrameProfiler& profiler() const {
+      return m_profiler;
+    }
+
+    /**
+     *  Get the catalog of the node library, checked for changes first.
+     *  @return The catalog.
+     */
+    NodeCatalog& nodeCatalog();
+
+    /**
+     *  Get the index of the node signatures, see NodeLibrary.
+     *  @return The index.
+     */
+    NodeIndex& nodeIndex();
 
     void setDefaultAppsPos();
 
@@ -210,6 +279,9 @@ namespace fs = std::filesystem;
 
       void selectProcessors();
 
+      // copy the rectangles of the nodes of the current graph to m_geometry, before hit testing them
+      void refreshGeometry();
+
       static void launchIcesl();
       static void closeIcesl();
 
@@ -219,8 +291,32 @@ namespace fs = std::filesystem;
       void saveSettings();
       void loadSettings();
 
+      /**
+       *  Load a graph file. Text files written by Chill and binary files are loaded
+       *  over the next frames, other files are run in Lua at once.
+       */
       void loadGraph(const fs::path* _path, bool _setAsAutoSavePath);
 
+      // create the next nodes of the graph being loaded, called at each frame
+      void stepLoading();
+      // create all the remaining nodes at once
+      void finishLoading();
+      // drop the graph being loaded and go back to the previous one
+      void cancelLoading();
+      // progress and cancel button, while a graph is being loaded
+      void drawLoading();
+
+      void centerView(const AASquare& _bbox);
+
+      // save as Lua, or as a binary graph if the extension is GraphBinary::c_extension
+      void saveGraph(ProcessingGraph& _graph, const fs::path& _path);
+
+      // journal the edits of the main graph to m_graphPath, see GraphJournal
+      void openJournal(bool _saved);
+
+      // export again when the selection changes the tweaks set in IceSL, called at each frame
+      void followSelection();
+
       // Get current screen size
       static void getScreenRes(int& width, int& height);
       // Get current desktop size (without taskbar for windows)
@@ -242,6 +338,38 @@ namespace fs = std::filesystem;
       std::vector<std::shared_ptr<SelectableUI>>     selected;
       std::shared_ptr<ProcessingGraph> buffer;
 
+      // rectangles of the nodes of the current graph, see refreshGeometry
+      NodeGeometry m_geometry;
+      // hit test results, kept between frames to avoid reallocations
+      std::vector<uint32_t> m_hits;
+      std::vector<uint8_t>  m_inside;
+
+      FrameProfiler m_profiler;
+
+      NodeCatalog m_catalog;
+
+      // values of the scalar outputs, shown on the sockets
+      ScalarEvaluator m_evaluator;
+      // numbers of the outputs in the script, kept between the exports, see OutputSlots
+      OutputSlots m_output_slots;
+
+      SessionRecorder m_recorder;
+      // number of exports and automatic saves, reported by replay()
+      int m_export_count = 0;
+      ExportStats m_export_stats;
+      int m_save_count   = 0;
+      // Lua code written by the exports and saves
+      size_t m_lua_bytes         = 0;
+      size_t m_lua_reallocations = 0;
+
+      // graph being loaded, see stepLoading
+      std::unique_ptr<GraphLoader>     m_loader;
+      std::shared_ptr<ProcessingGraph> m_loading_previous;
+      fs::path                         m_loading_path;
+
+      // automatic saving of the main graph
+      GraphJournal m_journal;
+
       float m_zoom = 1.0F;
       ImGuiWindow* m_graphWindow = nullptr;
 
@@ -0,0 +1,159 @@
+#include "NodeGeometry.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CHILL_GEOMETRY_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CHILL_GEOMETRY_SSE
+#endif
+
+namespace chill {
+
+  void NodeGeometry::resize(size_t _size) {
+    m_min_x.resize(_size, 0.0F);
+    m_min_y.resize(_size, 0.0F);
+    m_max_x.resize(_size, 0.0F);
+    m_max_y.resize(_size, 0.0F);
+  }
+
+  //-------------------------------------------------------
+
+  void NodeGeometry::push(const ImVec2& _position, const ImVec2& _size) {
+    m_min_x.push_back(_position.x);
+    m_min_y.push_back(_position.y);
+    m_max_x.push_back(_position.x + _size.x);
+    m_max_y.push_back(_position.y + _size.y);
+  }
+
+  //-------------------------------------------------------
+
+  void NodeGeometry::set(size_t _index, const ImVec2& _position, const ImVec2& _size) {
+    m_min_x[_index] = _position.x;
+    m_min_y[_index] = _position.y;
+    m_max_x[_index] = _position.x + _size.x;
+    m_max_y[_index] = _position.y + _size.y;
+  }
+
+  //-------------------------------------------------------
+
+  void NodeGeometry::erase(size_t _index) {
+    m_min_x.erase(m_min_x.begin() + static_cast<std::ptrdiff_t>(_index));
+    m_min_y.erase(m_min_y.begin() + static_cast<std::ptrdiff_t>(_index));
+    m_max_x.erase(m_max_x.begin() + static_cast<std::ptrdiff_t>(_index));
+    m_max_y.erase(m_max_y.begin() + static_cast<std::ptrdiff_t>(_index));
+  }
+
+  //-------------------------------------------------------
+
+  void NodeGeometry::hitPoint(const ImVec2& _point, float _margin, std::vector<uint32_t>& _hits) const {
+    _hits.clear();
+
+    // min - margin <= p < max + margin
+    const float lo_x = _point.x - _margin;
+    const float lo_y = _point.y - _margin;
+    const float hi_x = _point.x + _margin;
+    const float hi_y = _point.y + _margin;
+
+    const size_t n = size();
+    size_t i = 0;
+
+#if defined(CHILL_GEOMETRY_AVX)
+    const __m256 v_lo_x = _mm256_set1_ps(lo_x);
+    const __m256 v_lo_y = _mm256_set1_ps(lo_y);
+    const __m256 v_hi_x = _mm256_set1_ps(hi_x);
+    const __m256 v_hi_y = _mm256_set1_ps(hi_y);
+    for (; i + 8 <= n; i += 8) {
+      __m256 in_x = _mm256_and_ps(
+        _mm256_cmp_ps(_mm256_loadu_ps(&m_min_x[i]), v_hi_x, _CMP_LE_OQ),
+        _mm256_cmp_ps(_mm256_loadu_ps(&m_max_x[i]), v_lo_x, _CMP_GT_OQ));
+      __m256 in_y = _mm256_and_ps(
+        _mm256_cmp_ps(_mm256_loadu_ps(&m_min_y[i]), v_hi_y, _CMP_LE_OQ),
+        _mm256_cmp_ps(_mm256_loadu_ps(&m_max_y[i]), v_lo_y, _CMP_GT_OQ));
+      int mask = _mm256_movemask_ps(_mm256_and_ps(in_x, in_y));
+      for (int bit = 0; mask; ++bit, mask >>= 1) {
+        if (mask & 1) {
+          _hits.push_back(static_cast<uint32_t>(i + bit));
+        }
+      }
+    }
+#elif defined(CHILL_GEOMETRY_SSE)
+    const __m128 v_lo_x = _mm_set1_ps(lo_x);
+    const __m128 v_lo_y = _mm_set1_ps(lo_y);
+    const __m128 v_hi_x = _mm_set1_ps(hi_x);
+    const __m128 v_hi_y = _mm_set1_ps(hi_y);
+    for (; i + 4 <= n; i += 4) {
+      __m128 in_x = _mm_and_ps(
+        _mm_cmple_ps(_mm_loadu_ps(&m_min_x[i]), v_hi_x),
+        _mm_cmpgt_ps(_mm_loadu_ps(&m_max_x[i]), v_lo_x));
+      __m128 in_y = _mm_and_ps(
+        _mm_cmple_ps(_mm_loadu_ps(&m_min_y[i]), v_hi_y),
+        _mm_cmpgt_ps(_mm_loadu_ps(&m_max_y[i]), v_lo_y));
+      int mask = _mm_movemask_ps(_mm_and_ps(in_x, in_y));
+      for (int bit = 0; mask; ++bit, mask >>= 1) {
+        if (mask & 1) {
+          _hits.push_back(static_cast<uint32_t>(i + bit));
+        }
+      }
+    }
+#endif
+
+    // remaining rectangles, or everything without SIMD
+    for (; i < n; ++i) {
+      if (m_min_x[i] <= hi_x && m_max_x[i] > lo_x && m_min_y[i] <= hi_y && m_max_y[i] > lo_y) {
+        _hits.push_back(static_cast<uint32_t>(i));
+      }
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void NodeGeometry::hitBox(const ImVec2& _min, const ImVec2& _max, std::vector<uint8_t>& _inside) const {
+    const size_t n = size();
+    _inside.resize(n);
+
+    size_t i = 0;
+
+#if defined(CHILL_GEOMETRY_AVX)
+    const __m256 v_min_x = _mm256_set1_ps(_min.x);
+    const __m256 v_min_y = _mm256_set1_ps(_min.y);
+    const __m256 v_max_x = _mm256_set1_ps(_max.x);
+    const __m256 v_max_y = _mm256_set1_ps(_max.y);
+    for (; i + 8 <= n; i += 8) {
+      __m256 in_x = _mm256_and_ps(
+        _mm256_cmp_ps(_mm256_loadu_ps(&m_min_x[i]), v_min_x, _CMP_GE_OQ),
+        _mm256_cmp_ps(_mm256_loadu_ps(&m_max_x[i]), v_max_x, _CMP_LE_OQ));
+      __m256 in_y = _mm256_and_ps(
+        _mm256_cmp_ps(_mm256_loadu_ps(&m_min_y[i]), v_min_y, _CMP_GE_OQ),
+        _mm256_cmp_ps(_mm256_loadu_ps(&m_max_y[i]), v_max_y, _CMP_LE_OQ));
+      int mask = _mm256_movemask_ps(_mm256_and_ps(in_x, in_y));
+      for (int bit = 0; bit < 8; ++bit) {
+        _inside[i + bit] = static_cast<uint8_t>((mask >> bit) & 1);
+      }
+    }
+#elif defined(CHILL_GEOMETRY_SSE)
+    const __m128 v_min_x = _mm_set1_ps(_min.x);
+    const __m128 v_min_y = _mm_set1_ps(_min.y);
+    const __m128 v_max_x = _mm_set1_ps(_max.x);
+    const __m128 v_max_y = _mm_set1_ps(_max.y);
+    for (; i + 4 <= n; i += 4) {
+      __m128 in_x = _mm_and_ps(
+        _mm_cmpge_ps(_mm_loadu_ps(&m_min_x[i]), v_min_x),
+        _mm_cmple_ps(_mm_loadu_ps(&m_max_x[i]), v_max_x));
+      __m128 in_y = _mm_and_ps(
+        _mm_cmpge_ps(_mm_loadu_ps(&m_min_y[i]), v_min_y),
+        _mm_cmple_ps(_mm_loadu_ps(&m_max_y[i]), v_max_y));
+      int mask = _mm_movemask_ps(_mm_and_ps(in_x, in_y));
+      for (int bit = 0; bit < 4; ++bit) {
+        _inside[i + bit] = static_cast<uint8_t>((mask >> bit) & 1);
+      }
+    }
+#endif
+
+    for (; i < n; ++i) {
+      _inside[i] = static_cast<uint8_t>(
+        m_min_x[i] >= _min.x && m_max_x[i] <= _max.x &&
+        m_min_y[i] >= _min.y && m_max_y[i] <= _max.y);
+    }
+  }
+}
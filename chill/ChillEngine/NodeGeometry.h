@@ -0,0 +1,76 @@
+/** @file */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ImGuiTypes.h"
+
+namespace chill {
+
+  /**
+   *  NodeGeometry class.
+   *  Packed struct-of-arrays mirror of the rectangles of the nodes of a graph,
+   *  in graph coordinates. Used to hit test many nodes at once.
+   **/
+  class NodeGeometry
+  {
+  public:
+    /**
+     *  Get the number of rectangles.
+     *  @return The number of rectangles.
+     **/
+    size_t size() const {
+      return m_min_x.size();
+    }
+
+    /**
+     *  Change the number of rectangles, new ones are empty.
+     *  @param _size The new number of rectangles.
+     **/
+    void resize(size_t _size);
+
+    /**
+     *  Add a rectangle at the end.
+     *  @param _position The top left corner.
+     *  @param _size The size of the rectangle.
+     **/
+    void push(const ImVec2& _position, const ImVec2& _size);
+
+    /**
+     *  Update a rectangle.
+     *  @param _index The rectangle index.
+     *  @param _position The top left corner.
+     *  @param _size The size of the rectangle.
+     **/
+    void set(size_t _index, const ImVec2& _position, const ImVec2& _size);
+
+    /**
+     *  Remove a rectangle, the following ones are shifted.
+     *  @param _index The rectangle index.
+     **/
+    void erase(size_t _index);
+
+    /**
+     *  Find all the rectangles containing a point.
+     *  @param _point The point, in graph coordinates.
+     *  @param _margin Border added around each rectangle.
+     *  @param _hits Filled with the indices of the rectangles hit, in increasing order.
+     **/
+    void hitPoint(const ImVec2& _point, float _margin, std::vector<uint32_t>& _hits) const;
+
+    /**
+     *  Find all the rectangles fully inside a box.
+     *  @param _min The box top left corner, in graph coordinates.
+     *  @param _max The box bottom right corner, in graph coordinates.
+     *  @param _inside Filled with one flag per rectangle.
+     **/
+    void hitBox(const ImVec2& _min, const ImVec2& _max, std::vector<uint8_t>& _inside) const;
+
+  private:
+    std::vector<float> m_min_x;
+    std::vector<float> m_min_y;
+    std::vector<float> m_max_x;
+    std::vector<float> m_max_y;
+  };
+}
@@ -0,0 +1,364 @@
+#include "NodeIndex.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <LibSL/LibSL.h>
+
+#include "NodeSandbox.h"
+#include "Parallel.h"
+
+namespace chill {
+
+#ifdef WIN32
+namespace fs = std::experimental::filesystem;
+#else
+namespace fs = std::filesystem;
+#endif
+
+  namespace {
+    const std::string c_header = "chill-node-index";
+    // bump when NodeSignature::parse or NodeSandbox change, older indices are then discarded
+    const int         c_version = 3;
+
+    uint64_t fnv1a(const std::string& _text) {
+      uint64_t hash = 14695981039346656037ULL;
+      for (char c : _text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+      }
+      return hash;
+    }
+
+    // strings are written as <length>:<bytes>, so that they may hold spaces and new lines
+    void writeString(std::ostream& _stream, const std::string& _text) {
+      _stream << _text.size() << ':' << _text;
+    }
+
+    bool readString(std::istream& _stream, std::string& _text) {
+      size_t size = 0;
+      char   colon = 0;
+      if (!(_stream >> size) || !_stream.get(colon) || colon != ':') {
+        return false;
+      }
+      _text.resize(size);
+      return size == 0 || _stream.read(&_text[0], size);
+    }
+  }
+
+  //-------------------------------------------------------
+
+  std::string NodeIndex::key(const std::string& _nodepath) {
+    std::string key = _nodepath;
+    std::replace(key.begin(), key.end(), '\\', '/');
+    if (key.empty() || key[0] != '/') {
+      key = "/" + key;
+    }
+    return key;
+  }
+
+  //-------------------------------------------------------
+
+  void NodeIndex::setExtractor(Extractor _extractor) {
+    if (_extractor == m_extractor) {
+      return;
+    }
+    m_extractor = _extractor;
+    m_entries.clear();
+    m_changed = true;
+  }
+
+  //-------------------------------------------------------
+
+  void NodeIndex::open(const std::string& _filename, const std::string& _nodes_folder) {
+    m_filename     = _filename;
+    m_nodes_folder = _nodes_folder;
+    m_changed      = false;
+    m_entries.clear();
+
+    std::ifstream file(_filename, std::ios::binary);
+    if (!file.is_open()) {
+      return;
+    }
+
+    std::string header;
+    int version   = 0;
+    int extractor = -1;
+    if (!(file >> header >> version >> extractor) || header != c_header || version != c_version || extractor != m_extractor) {
+      // unknown or older format, or other extractor: rebuilt from the node files
+      m_changed = true;
+      return;
+    }
+
+    std::string tag;
+    std::string name;
+    Entry*      entry = nullptr;
+    std::shared_ptr<NodeSignature> signature;
+    while (file >> tag) {
+      bool ok = true;
+      if (tag == "entry") {
+        Entry read;
+        signature = std::make_shared<NodeSignature>();
+        int emit = 0, has_color = 0;
+        ok = readString(file, name)
+          && (file >> read.size >> read.mtime >> read.hash >> emit >> has_color
+                   >> signature->color[0] >> signature->color[1] >> signature->color[2]);
+        if (ok) {
+          signature->emit      = (emit != 0);
+          signature->has_color = (has_color != 0);
+          read.signature       = signature;
+          entry = &(m_entries[name] = read);
+        }
+      } else if (tag == "input" && entry) {
+        NodeSignature::Input input;
+        int    data_only = 0;
+        size_t params    = 0;
+        ok = readString(file, input.name) && readString(file, input.type) && (file >> data_only >> params);
+        input.data_only = (data_only != 0);
+        for (size_t p = 0; ok && p < params; ++p) {
+          input.params.emplace_back();
+          ok = readString(file, input.params.back());
+        }
+        signature->inputs.push_back(input);
+      } else if (tag == "output" && entry) {
+        NodeSignature::Output output;
+        ok = readString(file, output.name) && readString(file, output.type);
+        signature->outputs.push_back(output);
+      } else {
+        ok = false;
+      }
+
+      if (!ok) {
+        std::cerr << Console::red << "Corrupted node index " << _filename << ", rebuilding it" << Console::gray << std::endl;
+        m_entries.clear();
+        m_changed = true;
+        return;
+      }
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void NodeIndex::save() {
+    if (!m_changed || m_filename.empty()) {
+      return;
+    }
+
+    // written aside then renamed, a crash never leaves half an index
+    std::string temp = m_filename + ".tmp";
+    std::ofstream file(temp, std::ios::binary);
+    if (!file.is_open()) {
+      std::cerr << Console::red << "Cannot write the node index " << m_filename << Console::gray << std::endl;
+      return;
+    }
+
+    file << c_header << " " << c_version << " " << m_extractor << "\n";
+    for (const auto& item : m_entries) {
+      const Entry&         entry     = item.second;
+      const NodeSignature& signature = *entry.signature;
+      file << "entry ";
+      writeString(file, item.first);
+      file << " " << entry.size << " " << entry.mtime << " " << entry.hash
+           << " " << signature.emit << " " << signature.has_color
+           << " " << signature.color[0] << " " << signature.color[1] << " " << signature.color[2] << "\n";
+      for (const NodeSignature::Input& input : signature.inputs) {
+        file << "input ";
+        writeString(file, input.name);
+        file << " ";
+        writeString(file, input.type);
+        file << " " << input.data_only << " " << input.params.size();
+        for (const std::string& param : input.params) {
+          file << " ";
+          writeString(file, param);
+        }
+        file << "\n";
+      }
+      for (const NodeSignature::Output& output : signature.outputs) {
+        file << "output ";
+        writeString(file, output.name);
+        file << " ";
+        writeString(file, output.type);
+        file << "\n";
+      }
+    }
+    file.close();
+
+    std::error_code error;
+    fs::rename(temp, m_filename, error);
+    if (error) {
+      std::cerr << Console::red << "Cannot write the node index " << m_filename << ": " << error.message() << Console::gray << std::endl;
+      return;
+    }
+    m_changed = false;
+  }
+
+  //-------------------------------------------------------
+
+  bool NodeIndex::stat(const std::string& _key, uint64_t& _size, int64_t& _mtime) const {
+    fs::path path = m_nodes_folder + _key;
+    std::error_code error;
+    _size = static_cast<uint64_t>(fs::file_size(path, error));
+    if (error) {
+      return false;
+    }
+    _mtime = static_cast<int64_t>(fs::last_write_time(path, error).time_since_epoch().count());
+    return !error;
+  }
+
+  //-------------------------------------------------------
+
+  bool NodeIndex::read(const std::string& _key, std::string& _program, uint64_t& _size, int64_t& _mtime) const {
+    if (!stat(_key, _size, _mtime)) {
+      return false;
+    }
+    std::ifstream file(m_nodes_folder + _key, std::ios::binary);
+    if (!file.is_open()) {
+      return false;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    _program = content.str();
+    return true;
+  }
+
+  //-------------------------------------------------------
+
+  NodeIndex::Check NodeIndex::check(const std::string& _key, Entry& _entry, std::string& _program, uint64_t& _size, int64_t& _mtime) const {
+    if (!stat(_key, _size, _mtime)) {
+      return MISSING;
+    }
+    if (_size == _entry.size && _mtime == _entry.mtime) {
+      return VALID;
+    }
+    if (!read(_key, _program, _size, _mtime)) {
+      return MISSING;
+    }
+    // touched but not modified (checkout, copy, ...): only the time is updated
+    if (_size == _entry.size && fnv1a(_program) == _entry.hash) {
+      _entry.mtime = _mtime;
+      return VALID;
+    }
+    return STALE;
+  }
+
+  //-------------------------------------------------------
+
+  std::shared_ptr<const NodeSignature> NodeIndex::extract(const std::string& _key, const std::string& _program) const {
+    if (m_extractor == SANDBOX) {
+      std::shared_ptr<NodeSignature> signature = std::make_shared<NodeSignature>();
+      std::string error;
+      if (NodeSandbox::extract(_program, _key, *signature, error)) {
+        return signature;
+      }
+      std::cerr << Console::yellow << "Cannot run " << _key << " in the sandbox (" << error << "), parsing it instead" << Console::gray << std::endl;
+    }
+    return std::make_shared<NodeSignature>(NodeSignature::parse(_program));
+  }
+
+  //-------------------------------------------------------
+
+  std::shared_ptr<const NodeSignature> NodeIndex::signature(const std::string& _nodepath) {
+    std::string k = key(_nodepath);
+
+    Entry       entry;
+    std::string program;
+    auto found = m_entries.find(k);
+    if (found == m_entries.end()) {
+      if (!read(k, program, entry.size, entry.mtime)) {
+        return std::make_shared<NodeSignature>();
+      }
+    } else {
+      Entry& cached = found->second;
+      if (cached.checked) {
+        return cached.signature;
+      }
+      int64_t mtime = cached.mtime;
+      switch (check(k, cached, program, entry.size, entry.mtime)) {
+      case VALID:
+        cached.checked = true;
+        m_changed      = m_changed || (mtime != cached.mtime);
+        return cached.signature;
+      case MISSING:
+        m_entries.erase(found);
+        m_changed = true;
+        return std::make_shared<NodeSignature>();
+      case STALE:
+        break;
+      }
+    }
+
+    entry.hash      = fnv1a(program);
+    entry.checked   = true;
+    entry.signature = extract(k, program);
+    m_entries[k]    = entry;
+    m_changed       = true;
+    return entry.signature;
+  }
+
+  //-------------------------------------------------------
+
+  size_t NodeIndex::refresh(const std::vector<std::string>& _nodepaths) {
+    struct Job {
+      std::string  key;
+      const Entry* previous = nullptr;
+      Entry        entry;
+      bool         ok     = false;
+      bool         parsed = false;
+    };
+
+    // cheap checks first, only the files whose size or time changed are queued
+    std::vector<Job> jobs;
+    for (const std::string& nodepath : _nodepaths) {
+      Job job;
+      job.key = key(nodepath);
+      auto found = m_entries.find(job.key);
+      if (found != m_entries.end()) {
+        Entry& entry = found->second;
+        if (entry.checked) {
+          continue;
+        }
+        uint64_t size  = 0;
+        int64_t  mtime = 0;
+        if (stat(job.key, size, mtime) && size == entry.size && mtime == entry.mtime) {
+          entry.checked = true;
+          continue;
+        }
+        job.previous = &entry;
+      }
+      jobs.push_back(job);
+    }
+
+    // reading, hashing and parsing run in parallel, the map is only read
+    parallelFor(jobs.size(), [&](size_t _i) {
+      Job&        job = jobs[_i];
+      std::string program;
+      job.ok = read(job.key, program, job.entry.size, job.entry.mtime);
+      if (!job.ok) {
+        return;
+      }
+      job.entry.hash    = fnv1a(program);
+      job.entry.checked = true;
+      if (job.previous && job.previous->hash == job.entry.hash) {
+        job.entry.signature = job.previous->signature;
+      } else {
+        job.entry.signature = extract(job.key, program);
+        job.parsed          = true;
+      }
+    });
+
+    size_t parsed = 0;
+    for (Job& job : jobs) {
+      if (job.ok) {
+        m_entries[job.key] = job.entry;
+      } else {
+        m_entries.erase(job.key);
+      }
+      parsed += job.parsed ? 1 : 0;
+    }
+    m_changed = m_changed || !jobs.empty();
+    return parsed;
+  }
+}
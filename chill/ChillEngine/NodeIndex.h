@@ -0,0 +1,108 @@
+/** @file */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "NodeSignature.h"
+
+namespace chill {
+
+  /**
+   *  NodeIndex class.
+   *  Cache of the signatures of the node files, saved between sessions.
+   *  An entry is identified by the node path, and is valid as long as the size,
+   *  the modification time or, failing those, the content hash of the file match.
+   *  Entries are checked lazily, the first time they are used in a session.
+   *  Not thread safe, refresh() does its own parallel work.
+   **/
+  class NodeIndex
+  {
+  public:
+    /** How the signatures are extracted from the node files */
+    enum Extractor {
+      /** Lua lexer looking for the declarations, see NodeSignature::parse */
+      LEXER,
+      /** Node run in a sandboxed Lua state, see NodeSandbox */
+      SANDBOX
+    };
+
+    /**
+     *  Choose how the signatures are extracted. Changing it drops all the entries,
+     *  and so does opening an index built with the other extractor.
+     *  @param _extractor The extractor.
+     **/
+    void setExtractor(Extractor _extractor);
+
+    Extractor extractor() const {
+      return m_extractor;
+    }
+
+    /**
+     *  Open an index, the entries saved in the file are loaded.
+     *  @param _filename The index file.
+     *  @param _nodes_folder The folder the node paths are relative to.
+     **/
+    void open(const std::string& _filename, const std::string& _nodes_folder);
+
+    /**
+     *  Write the index if it changed since it was opened or saved.
+     **/
+    void save();
+
+    /**
+     *  Get the signature of a node file, parsed again only if the file changed.
+     *  @param _nodepath The node path, relative to the nodes folder.
+     *  @return The signature, empty if the file cannot be read.
+     **/
+    std::shared_ptr<const NodeSignature> signature(const std::string& _nodepath);
+
+    /**
+     *  Check a list of node files and parse the changed ones in parallel.
+     *  @param _nodepaths The node paths, relative to the nodes folder.
+     *  @return The number of files parsed.
+     **/
+    size_t refresh(const std::vector<std::string>& _nodepaths);
+
+    /**
+     *  Normalize a node path: forward slashes and a leading slash.
+     *  @param _nodepath The node path.
+     *  @return The normalized path.
+     **/
+    static std::string key(const std::string& _nodepath);
+
+  private:
+    struct Entry {
+      uint64_t size  = 0;
+      int64_t  mtime = 0;
+      uint64_t hash  = 0;
+      /** checked against the file during this session */
+      bool     checked = false;
+      std::shared_ptr<const NodeSignature> signature;
+    };
+
+    enum Check { VALID, STALE, MISSING };
+
+    /** Compare an entry with its file, the file is read only if the size or time differ. */
+    Check check(const std::string& _key, Entry& _entry, std::string& _program, uint64_t& _size, int64_t& _mtime) const;
+
+    /** Read a node file with its size and time. */
+    bool read(const std::string& _key, std::string& _program, uint64_t& _size, int64_t& _mtime) const;
+
+    /** Get the size and time of a node file. */
+    bool stat(const std::string& _key, uint64_t& _size, int64_t& _mtime) const;
+
+    /** Extract the signature of a node program, called from several threads by refresh(). */
+    std::shared_ptr<const NodeSignature> extract(const std::string& _key, const std::string& _program) const;
+
+    std::string m_filename;
+    std::string m_nodes_folder;
+    bool        m_changed = false;
+    Extractor   m_extractor = LEXER;
+
+    std::unordered_map<std::string, Entry> m_entries;
+  };
+}
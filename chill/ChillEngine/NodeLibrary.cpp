@@ -0,0 +1,100 @@
+#include "NodeLibrary.h"
+
+#include <filesystem>
+
+#include <LibSL/LibSL.h>
+
+namespace chill {
+
+#ifdef WIN32
+namespace fs = std::experimental::filesystem;
+#else
+namespace fs = std::filesystem;
+#endif
+
+  //-------------------------------------------------------
+
+  NodeLibrary& NodeLibrary::Instance() {
+    static NodeLibrary s_library;
+    return s_library;
+  }
+
+  //-------------------------------------------------------
+
+  void NodeLibrary::setFolder(const std::string& _folder, const std::string& _index_file) {
+    if (m_open) {
+      m_index.save();
+    }
+    m_folder     = _folder;
+    m_index_file = _index_file;
+    m_open       = false;
+
+    std::lock_guard<std::mutex> lock(m_sources_mutex);
+    m_sources.clear();
+  }
+
+  //-------------------------------------------------------
+
+  NodeIndex& NodeLibrary::index() {
+    if (!m_open) {
+      m_index.open(m_index_file, m_folder);
+      m_open = true;
+    }
+    return m_index;
+  }
+
+  //-------------------------------------------------------
+
+  void NodeLibrary::setExtractor(NodeIndex::Extractor _extractor) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_index.setExtractor(_extractor);
+  }
+
+  //-------------------------------------------------------
+
+  std::shared_ptr<const NodeSignature> NodeLibrary::signature(const std::string& _nodepath) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return index().signature(_nodepath);
+  }
+
+  //-------------------------------------------------------
+
+  size_t NodeLibrary::refresh(const std::vector<std::string>& _nodepaths) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return index().refresh(_nodepaths);
+  }
+
+  //-------------------------------------------------------
+
+  void NodeLibrary::setKeepSources(bool _keep) {
+    std::lock_guard<std::mutex> lock(m_sources_mutex);
+    m_keep_sources = _keep;
+  }
+
+  //-------------------------------------------------------
+
+  std::shared_ptr<const std::string> NodeLibrary::source(const std::string& _nodepath) {
+    std::lock_guard<std::mutex> lock(m_sources_mutex);
+    auto found = m_sources.find(_nodepath);
+    if (found != m_sources.end() && m_keep_sources) {
+      return found->second.text;
+    }
+    // read again only once edited, as NodeIndex does for the signatures
+    fs::path path = m_folder + _nodepath;
+    std::error_code error;
+    uint64_t size  = static_cast<uint64_t>(fs::file_size(path, error));
+    int64_t  mtime = error ? 0 : static_cast<int64_t>(fs::last_write_time(path, error).time_since_epoch().count());
+    if (error) {
+      m_sources.erase(_nodepath);
+      return std::make_shared<const std::string>(loadFileIntoString(path.string().c_str()));
+    }
+    if (found != m_sources.end() && found->second.size == size && found->second.mtime == mtime) {
+      return found->second.text;
+    }
+    Source& source = m_sources[_nodepath];
+    source.text  = std::make_shared<const std::string>(loadFileIntoString(path.string().c_str()));
+    source.size  = size;
+    source.mtime = mtime;
+    return source.text;
+  }
+}
@@ -0,0 +1,102 @@
+/** @file */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "NodeIndex.h"
+
+namespace chill {
+
+  /**
+   *  NodeLibrary class.
+   *  The folder of the node files and the index of their signatures, shared by
+   *  all the graphs. The editor sets it to its chill-nodes folder, a tool without
+   *  a window to any folder; the processors only go through it.
+   *  signature() and refresh() may be called from several threads, when graphs
+   *  are loaded in parallel; the rest is for the thread that set the library up.
+   **/
+  class NodeLibrary
+  {
+  public:
+    static NodeLibrary& Instance();
+
+    NodeLibrary(const NodeLibrary&) = delete;
+    NodeLibrary& operator=(const NodeLibrary&) = delete;
+
+    /**
+     *  Choose the node files, the index is opened on first use.
+     *  @param _folder The folder the node paths are relative to.
+     *  @param _index_file The file the index is kept in, empty to keep it in memory only.
+     **/
+    void setFolder(const std::string& _folder, const std::string& _index_file);
+
+    const std::string& folder() const {
+      return m_folder;
+    }
+
+    /**
+     *  Choose how the signatures are extracted, best before the index is opened. Thread safe.
+     *  @param _extractor The extractor, see NodeIndex::setExtractor.
+     **/
+    void setExtractor(NodeIndex::Extractor _extractor);
+
+    /**
+     *  Keep the content of the node files once read, for the tools whose node
+     *  files do not change while they run. Off by default, the editor checks
+     *  their size and time at each export and reads them again once edited.
+     *  @param _keep true to keep them.
+     **/
+    void setKeepSources(bool _keep);
+
+    /**
+     *  Get the content of a node file, as exported in the IceSL script. Thread safe.
+     *  @param _nodepath The node path, relative to the folder.
+     *  @return The content of the file.
+     **/
+    std::shared_ptr<const std::string> source(const std::string& _nodepath);
+
+    /**
+     *  Get the index of the node signatures, opened on first use.
+     *  @return The index.
+     **/
+    NodeIndex& index();
+
+    /**
+     *  Get the signature of a node file, see NodeIndex::signature. Thread safe.
+     *  @param _nodepath The node path, relative to the folder.
+     *  @return The signature, empty if the file cannot be read.
+     **/
+    std::shared_ptr<const NodeSignature> signature(const std::string& _nodepath);
+
+    /**
+     *  Check node files and parse the changed ones, see NodeIndex::refresh. Thread safe.
+     *  @param _nodepaths The node paths, relative to the folder.
+     *  @return The number of files parsed.
+     **/
+    size_t refresh(const std::vector<std::string>& _nodepaths);
+
+  private:
+    NodeLibrary() = default;
+
+    std::string m_folder;
+    std::string m_index_file;
+    NodeIndex   m_index;
+    bool        m_open = false;
+    std::mutex  m_mutex;
+
+    struct Source {
+      std::shared_ptr<const std::string> text;
+      uint64_t size  = 0;
+      int64_t  mtime = 0;
+    };
+
+    bool        m_keep_sources = false;
+    std::mutex  m_sources_mutex;
+    std::unordered_map<std::string, Source> m_sources;
+  };
+}
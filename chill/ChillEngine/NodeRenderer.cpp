@@ -0,0 +1,880 @@
+#include "NodeRenderer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "FileDialog.h"
+#include "IOs.h"
+#include "NodeEditor.h"
+#include "Processor.h"
+#include "VisualComment.h"
+
+namespace chill {
+
+namespace {
+
+  // the title, the sockets and the tweaks of a node, under its rectangle
+  bool drawNode(Processor& _processor) {
+    const Style& style = _processor.style;
+
+    ImGui::PushID(int(_processor.getUniqueID()));
+
+    ImGuiWindow* window = ImGui::GetCurrentWindow();
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+    float w_scale = window->FontWindowScale;
+
+    ImVec2 size = toImGui(_processor.m_size) * w_scale;
+
+    ImVec2 min_pos = ImGui::GetCursorScreenPos();
+    ImVec2 max_pos = min_pos + size;
+
+    float border_width = style.processor_border_width * w_scale;
+    float rounding_corners = style.processor_rounding_corners * w_scale;
+
+    // shadow
+    if (_processor.m_selected || w_scale > 0.5F) {
+      draw_list->AddRectFilled(
+        min_pos + ImVec2(10, 10) * w_scale,
+        max_pos + ImVec2(10, 10) * w_scale,
+        toImGui(style.processor_shadow_color),
+        rounding_corners + 5.0F, style.processor_rounded_corners);
+    }
+
+    // border
+    ImVec2 border = ImVec2(style.processor_border_width, style.processor_border_width) * w_scale / 2.0F;
+    draw_list->AddRect(
+      min_pos - border,
+      max_pos + border,
+      toImGui(_processor.m_selected ? style.processor_selected_color : _processor.m_color),
+      rounding_corners, style.processor_rounded_corners,
+      border_width
+    );
+
+    // background
+    draw_list->AddRectFilled(min_pos, max_pos, toImGui(style.processor_bg_color), rounding_corners, style.processor_rounded_corners);
+
+    float height = ImGui::GetCursorPosY();
+
+    float padding = (style.socket_radius + style.socket_border_width + style.ItemSpacing.x) * w_scale;
+
+    ImGui::PushItemWidth(_processor.m_size.x * w_scale - padding * 2.F);
+    ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, toImGui(style.ItemSpacing) * w_scale);
+
+    ImGui::BeginGroup();
+
+    float button_size = style.processor_title_height / 1.2F * w_scale;
+
+    // draw title
+    if (w_scale > 0.7F) {
+      ImVec2 title_size(style.processor_width, style.processor_title_height);
+      title_size *= w_scale;
+      draw_list->AddRectFilled(min_pos, min_pos + title_size,
+        toImGui(_processor.m_color),
+        rounding_corners, style.processor_rounded_corners & 3);
+      if (!_processor.m_edit) {
+        ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0, 0, 0, 0));
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0, 0, 0, 0));
+        ImGui::PushStyleColor(ImGuiCol_Border, ImVec4(0, 0, 0, 255));
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0, 0, 0, 255));
+
+        if (ImGui::ButtonEx((_processor.name() + "##" + std::to_string(_processor.getUniqueID())).c_str(), title_size - ImVec2(2 * button_size, 0), ImGuiButtonFlags_PressedOnDoubleClick)) {
+          _processor.m_edit = true;
+        }
+        ImGui::PopStyleColor(5);
+      } else {
+        char title[32];
+        strncpy(title, _processor.name().c_str(), 32);
+        if (ImGui::InputText(("##" + std::to_string(_processor.getUniqueID())).c_str(), title, 32)) {
+          _processor.setName(title);
+        } else if (!_processor.m_selected) {
+          _processor.m_edit = false;
+        }
+      }
+      ImGui::SetCursorPosY(ImGui::GetCursorPosY() + padding);
+    } else {
+      ImVec2 title_size(style.processor_width, style.processor_title_height);
+      title_size *= w_scale;
+      ImVec2 cursor = ImGui::GetCursorPos() + ImVec2(0, 2*padding + title_size.y);
+      draw_list->AddRectFilled(min_pos, max_pos,
+        toImGui(_processor.m_color),
+        rounding_corners, style.processor_rounded_corners & 3);
+      ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
+      ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0, 0, 0, 0));
+      ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0, 0, 0, 0));
+      ImGui::PushStyleColor(ImGuiCol_Border, ImVec4(0, 0, 0, 255));
+      ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0, 0, 0, 255));
+      ImGui::SetWindowFontScale(std::min(1.3f, 2 * w_scale));
+
+      ImVec2 textSize = ImGui::CalcTextSize(_processor.name().c_str());
+      ImGui::SetCursorPosX(ImGui::GetCursorPosX() + (_processor.m_size[0] * w_scale - textSize[0]) / 2.0F);
+      ImGui::SetCursorPosY(ImGui::GetCursorPosY() + (_processor.m_size[1] * w_scale - textSize[1]) / 2.0F);
+      ImGui::Text("%s", _processor.name().c_str());
+      ImGui::SetCursorPos(cursor);
+      ImGui::SetWindowFontScale(w_scale);
+      ImGui::PopStyleColor(5);
+    }
+    ImGui::PushStyleVar(ImGuiStyleVar_FrameBorderSize, 2);
+    ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 20);
+
+    // Drag and Drop Target
+    bool value_changed = false;
+    if (ImGui::BeginDragDropTarget())
+    {
+      float col[4];
+      if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload(IMGUI_PAYLOAD_TYPE_COLOR_3F))
+      {
+        memcpy(static_cast<float*>(col), payload->Data, sizeof(float) * 3);
+        value_changed = true;
+      }
+      if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload(IMGUI_PAYLOAD_TYPE_COLOR_4F))
+      {
+        memcpy(static_cast<float*>(col), payload->Data, sizeof(float) * 4);
+        value_changed = true;
+      }
+      if (value_changed) _processor.m_color = toColor(ImVec4(col[0], col[1], col[2], 1.0F));
+      ImGui::EndDragDropTarget();
+    }
+
+    // draw inputs
+    ImGui::BeginGroup();
+    for (std::shared_ptr<ProcessorInput> input : _processor.inputs()) {
+      if (NodeRenderer::draw(*input)) {
+        _processor.setDirty();
+      }
+    }
+    ImGui::EndGroup();
+
+    // draw outputs
+    ImGui::SetCursorPosX(ImGui::GetCursorPosX() + size.x);
+    ImGui::BeginGroup();
+    for (std::shared_ptr<ProcessorOutput> output : _processor.outputs()) {
+      if (NodeRenderer::draw(*output)) {
+        _processor.setDirty();
+      }
+    }
+    ImGui::EndGroup();
+
+    ImGui::PopStyleVar();
+    ImGui::PopStyleVar();
+
+    ImGui::EndGroup();
+    ImGui::PopItemWidth();
+    ImGui::PopStyleVar();
+
+    height = ImGui::GetCursorPosY() - height + padding;
+
+    _processor.m_size.x = style.processor_width;
+    _processor.m_size.y = height / w_scale;
+
+    ImGui::PopID();
+
+    return _processor.m_edit;
+  }
+
+  //-------------------------------------------------------
+
+  // a node, with a drop zone creating the inputs or the outputs of the group
+  bool drawGroup(GroupProcessor& _group) {
+    const Style& style = _group.style;
+
+    ImGuiWindow* window = ImGui::GetCurrentWindow();
+    float w_scale = window->FontWindowScale;
+
+    ImVec2 initial_pos = ImGui::GetCursorScreenPos();
+    drawNode(_group);
+    ImGui::SetCursorScreenPos(initial_pos);
+
+    ImVec2 title_size(0, style.processor_title_height);
+    title_size *= w_scale;
+
+    ImVec2 size = toImGui(_group.m_size) * w_scale;
+
+    ImVec2 min_pos = initial_pos;
+    ImGui::SetCursorScreenPos(min_pos);
+    ImVec2 max_pos = min_pos + size;
+
+    // draw dropzone
+    ImGui::PushID(int(_group.getUniqueID()));
+
+    ImGui::PushStyleColor(ImGuiCol_ButtonHovered, 0x00000000);
+    ImGui::PushStyleColor(ImGuiCol_ButtonActive, 0x00000000);
+    ImGui::ButtonEx("", max_pos - min_pos, ImGuiButtonFlags_PressedOnDoubleClick);
+    ImGui::PopStyleColor();
+    ImGui::PopStyleColor();
+
+    if (ImGui::BeginDragDropTarget()) {
+      if (_group.isOutputMode()) {
+        if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("_pipe_output")) {
+          std::shared_ptr<ProcessorOutput> output = NodeEditor::Instance()->getSelectedOutput();
+          if (output->owner() != &_group) {
+            std::shared_ptr<ProcessorInput> input = _group.addInput(output->name(), output->type());
+            NodeEditor::Instance()->setSelectedInput(input);
+
+            std::shared_ptr<ProcessorOutput> owner_output = output->clone();
+            owner_output->setName(input->name());
+            _group.owner()->addOutput(owner_output);
+          }
+        }
+      }
+
+      if (_group.isInputMode()) {
+        if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("_pipe_input")) {
+          std::shared_ptr<ProcessorInput> input = NodeEditor::Instance()->getSelectedInput();
+          if (input->owner() != &_group) {
+            std::shared_ptr<ProcessorOutput> output = _group.addOutput(input->name(), input->type());
+            NodeEditor::Instance()->setSelectedOutput(output);
+
+            std::shared_ptr<ProcessorInput> owner_input = input->clone();
+            owner_input->setName(output->name());
+            _group.owner()->addInput(owner_input);
+          }
+        }
+      }
+      ImGui::EndDragDropTarget();
+    }
+    ImGui::PopID();
+    return true;
+  }
+
+  //-------------------------------------------------------
+
+  // a small square taking the color of the node linked to it
+  bool drawMultiplexer(Multiplexer& _multiplexer) {
+    const Style& style = _multiplexer.style;
+
+    ImGui::PushID(int(_multiplexer.getUniqueID()));
+
+    ImGuiWindow* window = ImGui::GetCurrentWindow();
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    float w_scale = window->FontWindowScale;
+
+    ImVec2 size = toImGui(_multiplexer.m_size) * w_scale;
+
+    ImVec2 min_pos = ImGui::GetCursorScreenPos();
+    ImVec2 max_pos = min_pos + size;
+
+    float rounding_corners = style.processor_rounding_corners * w_scale;
+
+    // shadow
+    if (_multiplexer.m_selected || w_scale > 0.5F) {
+      draw_list->AddRectFilled(
+        min_pos + ImVec2(-5, -5) * w_scale,
+        max_pos + ImVec2(5, 5) * w_scale,
+        toImGui(_multiplexer.m_selected ? style.processor_shadow_selected_color : style.processor_shadow_color),
+        rounding_corners * 2.0F, style.processor_rounded_corners);
+    }
+
+    // border & background
+    ImVec2 border = ImVec2(style.processor_border_width, style.processor_border_width) * w_scale / 2.0F;
+    draw_list->AddRectFilled(
+      min_pos - border,
+      max_pos + border,
+      toImGui(_multiplexer.m_selected ? style.processor_selected_color : _multiplexer.color()),
+      rounding_corners, style.processor_rounded_corners
+    );
+
+    ImGui::PushStyleVar(ImGuiStyleVar_FrameBorderSize, 2);
+    ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 20);
+    float x = ImGui::GetCursorPosX();
+    float y = ImGui::GetCursorPosY() + size.y/2.0F - w_scale * style.socket_radius;
+
+    // draw inputs
+    ImGui::SetCursorPosX(x);
+    ImGui::SetCursorPosY(y);
+
+    ImGui::BeginGroup();
+    for (std::shared_ptr<ProcessorInput> input : _multiplexer.inputs()) {
+      NodeRenderer::draw(*input);
+      if (input->m_link) {
+        _multiplexer.setColor(input->m_link->owner()->color());
+      }
+    }
+    ImGui::EndGroup();
+
+    ImGui::SetCursorPosY(y);
+    ImGui::SetCursorPosX(x + size.x);
+    // draw ouputs
+    ImGui::BeginGroup();
+    for (std::shared_ptr<ProcessorOutput> output : _multiplexer.outputs()) {
+      NodeRenderer::draw(*output);
+    }
+    ImGui::EndGroup();
+
+    ImGui::PopStyleVar();
+    ImGui::PopStyleVar();
+    ImGui::PopID();
+
+    return _multiplexer.m_edit;
+  }
+
+  //-------------------------------------------------------
+
+  // the name of the input, for the types without a widget and the linked inputs
+  bool drawLabel(ProcessorInput& _input) {
+    ImGui::SameLine();
+    ImGui::Text("%s", _input.name());
+    return false;
+  }
+
+  template <typename T_Input>
+  bool tweak(T_Input& _input) {
+    return drawLabel(_input);
+  }
+
+  bool tweak(BoolInput& _input) {
+    ImGui::SameLine();
+
+    bool before = _input.m_value;
+    bool value_changed = false;
+
+    if (!_input.m_link) {
+      value_changed = ImGui::Checkbox(_input.name(), &_input.m_value);
+    }
+    else {
+      ImGui::Text("%s", _input.name());
+    }
+
+    return value_changed || _input.m_value != before;
+  }
+
+  bool tweak(IntInput& _input) {
+    ImGui::SameLine();
+    std::string name_str = std::string(_input.name());
+    std::string label = "##" + name_str;
+    std::string format = name_str + ": %" + std::to_string(24 - name_str.size()) + ".0f";
+
+    int before = _input.m_value;
+    bool value_changed = false;
+
+    if (!_input.m_link) {
+      if (_input.m_alt) {
+        value_changed = ImGui::SliderInt(label.c_str(), &_input.m_value, _input.m_min, _input.m_max, format.c_str());
+      }
+      else {
+        value_changed = ImGui::DragInt(label.c_str(), &_input.m_value, float(_input.m_step), _input.m_min, _input.m_max, format.c_str());
+      }
+    }
+    else {
+      ImGui::Text("%s", _input.name());
+    }
+
+    if (value_changed) {
+      _input.m_value = std::min(_input.m_max, std::max(_input.m_min, _input.m_value));
+    }
+
+    return _input.m_value != before;
+  }
+
+  bool tweak(ListInput& _input) {
+    ImGui::SameLine();
+    std::string name_str = std::string(_input.name());
+    std::string label = "##" + name_str;
+
+    int before = _input.m_value;
+
+    ImVec2 cursor = ImGui::GetCursorPos();
+    ImGui::Text(" %s:", name_str.c_str());
+
+    ImGui::SetCursorPos(cursor + ImVec2(0, 1.5F * ImGui::CalcTextSize(_input.name()).y));
+
+    if (!_input.m_link) {
+      ImGui::Combo(label.c_str(), &_input.m_value,
+                   [](void* data, int idx, const char** out_text) {
+        *out_text = static_cast<const std::vector<std::string>*>(data)->at(static_cast<unsigned long>(idx)).c_str();
+        return true;
+      }, reinterpret_cast<void*> (&_input.m_values),
+      static_cast<int>(_input.m_values.size()));
+    } else {
+      ImGui::Text("%s", _input.name());
+    }
+
+    return _input.m_value != before;
+  }
+
+  bool tweak(PathInput& _input) {
+    ImGui::SameLine();
+    std::string name_str = std::string(_input.name());
+
+    const size_t path_max_size = 512;
+    char string[path_max_size];
+    strncpy(string, _input.m_value.c_str(), path_max_size);
+
+    std::string before = _input.m_value;
+    bool value_changed = false;
+
+    ImVec2 cursor = ImGui::GetCursorPos();
+
+    ImGui::Text(" %s:", name_str.c_str());
+    cursor += ImVec2(0, 1.5F * ImGui::CalcTextSize(_input.name()).y);
+
+    float item_width = ImGui::CalcItemWidth();
+    ImGui::PushItemWidth(item_width * 3.F / 4.F);
+
+    if (!_input.m_link) {
+      ImGui::SetCursorPos(cursor + ImVec2(item_width * 1.F / 4.F, 0));
+      std::string path = fs::path(string).filename().generic_string();
+      ImGui::Text("%s", path.c_str());
+
+      ImGui::SetCursorPos(cursor);
+      ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(73/255.F, 193/255.F, 194/255.F, 1));
+      ImGui::PushStyleColor(ImGuiCol_ButtonActive, toImGui(_input.style.processor_title_color));
+      ImGui::PushItemWidth(item_width * 1.F / 4.F);
+
+      if (ImGui::Button(" ... ##")) {
+        std::string fullpath = openFileDialog(_input.m_filter);
+        if (!fullpath.empty()) {
+          std::replace(fullpath.begin(), fullpath.end(), '\\', '/');
+          _input.m_value = fullpath.c_str();
+          value_changed = true;
+        }
+      }
+      ImGui::PopItemWidth();
+      ImGui::PopStyleColor(2);
+    } else {
+      ImGui::Text("%s", _input.name());
+    }
+    ImGui::PopItemWidth();
+    return value_changed || _input.m_value != before;
+  }
+
+  bool tweak(RealInput& _input) {
+    ImGui::SameLine();
+
+    std::string name_str = std::string(_input.name());
+    std::string label = "##" + name_str;
+    std::string format = name_str + ": %" + std::to_string(24 - name_str.size()) + ".4g";
+
+    float before = _input.m_value;
+    bool value_changed = false;
+
+    if (!_input.m_link) {
+      if (_input.m_alt) {
+        value_changed = ImGui::SliderFloat(label.c_str(), &_input.m_value, _input.m_min, _input.m_max, format.c_str());
+      }
+      else {
+        value_changed = ImGui::DragFloat(label.c_str(), &_input.m_value, _input.m_step, _input.m_min, _input.m_max, format.c_str());
+      }
+    }
+    else {
+      ImGui::Text("%s", _input.name());
+    }
+
+    if (value_changed) {
+      _input.m_value = std::min(_input.m_max, std::max(_input.m_min, _input.m_value));
+    }
+
+    return value_changed || _input.m_value != before;
+  }
+
+  bool tweak(StringInput& _input) {
+    ImGui::SameLine();
+
+    const size_t path_max_size = 512;
+    char string[path_max_size];
+    strncpy(string, _input.m_value.c_str(), path_max_size);
+
+    std::string before = _input.m_value;
+    bool value_changed = false;
+
+    if (!_input.m_link) {
+      value_changed = ImGui::InputTextWithHint(("##" + std::to_string(_input.getUniqueID())).c_str(), _input.name(), string, 512);
+      if (value_changed) {
+        _input.m_value = string;
+      }
+    } else {
+      ImGui::Text("%s", _input.name());
+    }
+    return value_changed || _input.m_value != before;
+  }
+
+  bool tweak(Vec4Input& _input) {
+    const Style& style = _input.style;
+
+    ImGuiWindow* window = ImGui::GetCurrentWindow();
+    float w_scale = window->FontWindowScale;
+
+    ImGui::SameLine();
+    ImGui::Text("%s", _input.name());
+    ImVec2 current = ImGui::GetCursorPos();
+
+    float before[4];
+    std::memcpy(before, _input.m_value, sizeof(float) * 4);
+
+    bool value_changed = false;
+
+    if (!_input.m_link) {
+      float padding = (style.socket_radius + style.socket_border_width + style.ItemSpacing.x) * w_scale;
+      ImGui::SetCursorPosX(current.x + padding);
+
+      float item_width = ImGui::CalcItemWidth();
+      std::string label = "##" + std::string(_input.name());
+
+      if (_input.m_alt) {
+        ImGuiColorEditFlags flags = ImGuiColorEditFlags_RGB | ImGuiColorEditFlags_NoSidePreview | ImGuiColorEditFlags_NoPicker | ImGuiColorEditFlags_AlphaPreview | ImGuiColorEditFlags_AlphaBar;
+        ImGui::PushItemWidth(item_width);
+        value_changed = ImGui::ColorPicker4(label.c_str(), _input.m_value, flags);
+        ImGui::PopItemWidth();
+      }
+      else {
+        const char* format = "%0.4g";
+        value_changed = ImGui::DragFloat4(label.c_str(), _input.m_value, _input.m_step, _input.m_min, _input.m_max, format);
+      }
+    }
+    if (value_changed) {
+      for (int i = 0; i < 4; ++i) {
+        _input.m_value[i] = std::min(_input.m_max, std::max(_input.m_min, _input.m_value[i]));
+      }
+    }
+
+    for (int i = 0; i < 4; i++) {
+      value_changed |= before[i] != _input.m_value[i];
+    }
+
+    return value_changed;
+  }
+
+  bool tweak(Vec3Input& _input) {
+    const Style& style = _input.style;
+
+    ImGuiWindow* window = ImGui::GetCurrentWindow();
+    float w_scale = window->FontWindowScale;
+
+    ImGui::SameLine();
+    ImGui::Text("%s", _input.name());
+    ImVec2 current = ImGui::GetCursorPos();
+
+    float before[3];
+    std::memcpy(before, _input.m_value, sizeof(float) * 3);
+    bool value_changed = false;
+
+    if (!_input.m_link) {
+      float padding = (style.socket_radius + style.socket_border_width + style.ItemSpacing.x) * w_scale;
+      ImGui::SetCursorPosX(current.x + padding);
+
+      std::string label = "##" + std::string(_input.name());
+      const char* format = "%0.4g";
+      value_changed = ImGui::DragFloat3(label.c_str(), _input.m_value, _input.m_step, _input.m_min, _input.m_max, format);
+    }
+
+    if (value_changed) {
+      for (int i = 0; i < 3; ++i) {
+        _input.m_value[i] = std::min(_input.m_max, std::max(_input.m_min, _input.m_value[i]));
+      }
+    }
+
+    for (int i = 0; i < 3; i++) {
+      value_changed |= before[i] != _input.m_value[i];
+    }
+
+    return value_changed;
+  }
+
+  // the input as the class ProcessorInput::create makes for its type, its name if it is another
+  template <typename T_Input>
+  bool tweakAs(ProcessorInput& _input) {
+    T_Input* input = dynamic_cast<T_Input*>(&_input);
+    return input ? tweak(*input) : drawLabel(_input);
+  }
+
+#define CHILL_IO_TWEAK(type, in, out, r, g, b, converts) &tweakAs<in##Input>,
+  bool (* const c_tweaks[IOType::COUNT])(ProcessorInput&) = {
+    CHILL_IO_TYPES(CHILL_IO_TWEAK)
+  };
+#undef CHILL_IO_TWEAK
+}
+
+//-------------------------------------------------------
+
+bool NodeRenderer::draw(Processor& _processor) {
+  if (Multiplexer* multiplexer = dynamic_cast<Multiplexer*>(&_processor)) {
+    return drawMultiplexer(*multiplexer);
+  }
+  if (GroupProcessor* group = dynamic_cast<GroupProcessor*>(&_processor)) {
+    return drawGroup(*group);
+  }
+  return drawNode(_processor);
+}
+
+//-------------------------------------------------------
+
+bool NodeRenderer::draw(VisualComment& _comment) {
+  const Style& style = _comment.style;
+
+  _comment.m_size.y = std::max(50.0F, _comment.m_size.y);
+  _comment.m_size.x = std::max(50.0F, _comment.m_size.x);
+  ImGui::PushID(int(_comment.getUniqueID()));
+
+  ImGuiWindow* window = ImGui::GetCurrentWindow();
+  ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+  float w_scale = window->FontWindowScale;
+
+  ImVec2 size = toImGui(_comment.m_size) * w_scale;
+
+  ImVec2 min_pos = ImGui::GetCursorScreenPos();
+  ImVec2 max_pos = min_pos + size;
+
+  float border_width = style.processor_border_width * w_scale;
+  float rounding_corners = style.processor_rounding_corners * w_scale;
+
+  // border
+  ImVec2 border = ImVec2(style.processor_border_width, style.processor_border_width) * w_scale / 2.0f;
+  draw_list->AddRect(
+    min_pos - border,
+    max_pos + border,
+    toImGui(_comment.m_selected ? style.processor_selected_color : _comment.m_color.withAlpha(0x90)),
+    rounding_corners, style.processor_rounded_corners,
+    border_width
+  );
+
+  // background
+  draw_list->AddRectFilled(min_pos, max_pos, toImGui(_comment.m_color.withAlpha(0x60)), rounding_corners, style.processor_rounded_corners);
+
+  float padding = (style.socket_radius + style.socket_border_width + style.ItemSpacing.x) * w_scale;
+
+  ImGui::PushItemWidth(_comment.m_size.x * w_scale - padding * 2);
+  ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, toImGui(style.ItemSpacing) * w_scale);
+
+  ImGui::BeginGroup();
+  // draw title
+  _comment.m_title_size = Vec2(_comment.m_size.x, std::min(50.0F, _comment.m_size.y));
+  ImVec2 title_size = toImGui(_comment.m_title_size) * w_scale;
+
+  draw_list->AddRectFilled(min_pos, min_pos + title_size,
+    0x30FFFFFF,
+    rounding_corners, style.processor_rounded_corners & 3);
+
+  if (!_comment.m_edit) {
+    ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
+    ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0, 0, 0, 0));
+    ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0, 0, 0, 0));
+    ImGui::PushStyleColor(ImGuiCol_Border, ImVec4(0, 0, 0, 0));
+    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(255, 255, 255, 255));
+    if (ImGui::ButtonEx((_comment.m_name + "##" + std::to_string(_comment.getUniqueID())).c_str(), title_size, ImGuiButtonFlags_PressedOnDoubleClick))
+      _comment.m_edit = true;
+    ImGui::PopStyleColor(5);
+  }
+  else {
+    char name[32];
+    strncpy(name, _comment.m_name.c_str(), 32);
+    if (ImGui::InputText(("##" + std::to_string(_comment.getUniqueID())).c_str(), name, 32)) {
+      _comment.m_name = name;
+    }
+    else if (!_comment.m_selected) {
+      _comment.m_edit = false;
+    }
+  }
+
+  bool value_changed = false;
+  if (ImGui::BeginDragDropTarget())
+  {
+    float col[4];
+    if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload(IMGUI_PAYLOAD_TYPE_COLOR_3F))
+    {
+      memcpy(static_cast<float*>(col), payload->Data, sizeof(float) * 3);
+      value_changed = true;
+    }
+    if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload(IMGUI_PAYLOAD_TYPE_COLOR_4F))
+    {
+      memcpy(static_cast<float*>(col), payload->Data, sizeof(float) * 4);
+      value_changed = true;
+    }
+    if (value_changed) _comment.m_color = toColor(ImVec4(col[0], col[1], col[2], 1.0F));
+    ImGui::EndDragDropTarget();
+  }
+
+  ImGui::EndGroup();
+
+  ImGui::PopStyleVar();
+  ImGui::PopItemWidth();
+  ImGui::PopID();
+
+  return true;
+}
+
+//-------------------------------------------------------
+
+bool NodeRenderer::draw(ProcessorInput& _input) {
+  const Style& style = _input.style;
+
+  ImGuiWindow* window = ImGui::GetCurrentWindow();
+  float w_scale = window->FontWindowScale;
+
+  bool updt = false;
+
+  float radius = (style.socket_radius + style.socket_border_width) * w_scale;
+
+  ImVec2 pos = ImGui::GetCursorPos();
+
+  ImGui::SetCursorPos(ImVec2(pos.x - radius - style.processor_border_width * w_scale / 2, pos.y));
+  _input.setPosition(Vec2(pos.x, pos.y + radius));
+
+  if (!_input.m_isDataOnly) {
+    ImGui::PushStyleColor(ImGuiCol_Text, toImGui(_input.color()));
+    ImGui::PushStyleColor(ImGuiCol_Button, toImGui(_input.color()));
+    ImGui::PushStyleColor(ImGuiCol_ButtonHovered, toImGui(_input.color()));
+    ImGui::PushStyleColor(ImGuiCol_ButtonActive, toImGui(_input.color().withAlpha(0xAA)));
+    ImGui::PushStyleColor(ImGuiCol_DragDropTarget, toImGui(style.pipe_selected_color));
+  }
+  else {
+    ImGui::PushStyleColor(ImGuiCol_Text, 0X00000000);
+    ImGui::PushStyleColor(ImGuiCol_Button, 0X00000000);
+    ImGui::PushStyleColor(ImGuiCol_ButtonHovered, 0X00000000);
+    ImGui::PushStyleColor(ImGuiCol_ButtonActive, 0X00000000);
+    ImGui::PushStyleColor(ImGuiCol_DragDropTarget, 0X00000000);
+  }
+
+  int id = int(_input.getUniqueID());
+
+  bool active = false;
+
+  ImGui::PushID(id);
+
+  ImGui::PushStyleColor(ImGuiCol_Border, 0X00000000);
+  if (ImGui::Button("", ImVec2(radius, radius) * 2)) {
+    active = true;
+  }
+  ImGui::PopStyleColor();
+
+  // Drag and Drop Target
+  if (ImGui::BeginDragDropTarget()) {
+    if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("_pipe_output"))
+    {
+      active = true;
+    }
+    ImGui::EndDragDropTarget();
+  }
+
+  // Drag and Drop Source
+  if (ImGui::BeginDragDropSource()) {
+    if (!_input.m_link) {
+      ImGui::SetDragDropPayload("_pipe_input", nullptr, 0, ImGuiCond_Once);
+    }
+    else {
+      ImGui::SetDragDropPayload("_pipe_output", nullptr, 0, ImGuiCond_Once);
+    }
+    if (!NodeEditor::Instance()->getSelectedOutput()) {
+      active = true;
+    }
+    ImGui::EndDragDropSource();
+  }
+  ImGui::PopID();
+
+  if (active && !_input.m_isDataOnly) {
+    updt = true;
+    if (!_input.m_link || NodeEditor::Instance()->getSelectedOutput()) {
+      // start a new link
+      NodeEditor::Instance()->setSelectedInput(_input.owner()->input(_input.name()));
+    }
+    else {
+      // move the actual link
+      std::shared_ptr<ProcessorOutput> link = _input.m_link;
+      NodeEditor::Instance()->setSelectedOutput(link->owner()->output(link->name()));
+      Processor::disconnect(_input.owner()->input(_input.name()));
+    }
+  }
+  ImGui::PopStyleColor(5);
+
+  ImGui::PushStyleVar(ImGuiStyleVar_FrameBorderSize, style.socket_border_width * w_scale);
+  if (w_scale > 0.7F) {
+
+    if (!_input.owner()->m_selected) {
+      ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
+    }
+    updt |= drawTweak(_input);
+
+    if (!_input.owner()->m_selected) {
+      ImGui::PopItemFlag();
+    }
+  }
+  ImGui::PopStyleVar();
+  return updt;
+}
+
+//-------------------------------------------------------
+
+bool NodeRenderer::draw(ProcessorOutput& _output) {
+  const Style& style = _output.style;
+
+  ImGuiWindow* window = ImGui::GetCurrentWindow();
+  float w_scale = window->FontWindowScale;
+
+  float radius = (style.socket_radius + style.socket_border_width) * w_scale;
+  float full_radius = (style.socket_radius + style.socket_border_width) * w_scale;
+
+  ImVec2 pos = ImGui::GetCursorPos();
+  ImVec2 text_size = ImGui::CalcTextSize(_output.name());
+
+  ImGui::SetCursorPosX(pos.x - text_size.x - style.ItemSpacing.x * w_scale - full_radius);
+  ImGui::SetCursorPosY(pos.y - text_size.y/2 + full_radius);
+
+  if (w_scale > 0.7F) {
+    ImGui::Text("%s", _output.name());
+  }
+
+  ImGui::SetCursorPos(ImVec2(pos.x - full_radius + style.processor_border_width * w_scale / 2, pos.y));
+
+  _output.setPosition(Vec2(pos.x, pos.y + full_radius));
+
+  ImGui::PushStyleColor(ImGuiCol_Text, toImGui(_output.color()));
+  ImGui::PushStyleColor(ImGuiCol_Button, toImGui(_output.color()));
+  ImGui::PushStyleColor(ImGuiCol_ButtonHovered, toImGui(_output.color()));
+  ImGui::PushStyleColor(ImGuiCol_ButtonActive, toImGui(_output.color().withAlpha(0xAA)));
+  ImGui::PushStyleColor(ImGuiCol_DragDropTarget, toImGui(style.pipe_selected_color));
+
+  int id = int(_output.getUniqueID());
+  ImGui::PushID(id);
+
+  ImGui::PushStyleColor(ImGuiCol_Border, 0x00000000);
+  ImGui::PushStyleVar(ImGuiStyleVar_FrameBorderSize, style.socket_border_width * w_scale);
+  if (ImGui::Button("", ImVec2(radius, radius) * 2)) {
+    NodeEditor::Instance()->setSelectedOutput(_output.owner()->output(_output.name()));
+  }
+  ImGui::PopStyleVar();
+  ImGui::PopStyleColor();
+
+  // the value computed in Chill, beside the socket so that the node keeps its size
+  if (!_output.m_value.empty()) {
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("%s", _output.m_value.c_str());
+    }
+    if (w_scale > 0.7F) {
+      ImVec2 min = ImGui::GetItemRectMin();
+      ImVec2 max = ImGui::GetItemRectMax();
+      ImVec2 at(max.x + style.ItemSpacing.x * w_scale, (min.y + max.y - ImGui::GetTextLineHeight()) / 2);
+      ImGui::GetWindowDrawList()->AddText(at, ImGui::GetColorU32(ImGuiCol_TextDisabled), _output.m_value.c_str());
+    }
+  }
+
+  if (ImGui::BeginDragDropSource()) {
+    NodeEditor::Instance()->setSelectedOutput(_output.owner()->output(_output.name()));
+    ImGui::SetDragDropPayload("_pipe_output", nullptr, 0, ImGuiCond_Once);
+    ImGui::EndDragDropSource();
+  }
+
+  if (ImGui::BeginDragDropTarget()) {
+    if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("_pipe_input")){
+      NodeEditor::Instance()->setSelectedOutput(_output.owner()->output(_output.name()));
+    }
+    ImGui::EndDragDropTarget();
+  }
+  ImGui::PopID();
+
+  ImGui::PopStyleColor(5);
+
+  return false;
+}
+
+//-------------------------------------------------------
+
+bool NodeRenderer::drawTweak(ProcessorInput& _input) {
+  IOType::IOType type = _input.type();
+  if (type < 0 || type >= IOType::COUNT) {
+    return drawLabel(_input);
+  }
+  return c_tweaks[type](_input);
+}
+
+} // namespace chill
@@ -0,0 +1,58 @@
+/** @file */
+#pragma once
+
+#include "ImGuiTypes.h"
+
+namespace chill {
+
+  class Processor;
+  class ProcessorInput;
+  class ProcessorOutput;
+  class VisualComment;
+
+  /**
+   *  NodeRenderer class.
+   *  Draws the nodes, their sockets and their tweaks in the current ImGui window,
+   *  at the cursor, and applies what the user did with them. The graph model knows
+   *  nothing of the drawing: the renderer picks the drawing of each element from
+   *  its class, and of each tweak from its type, see CHILL_IO_TYPES.
+   **/
+  class NodeRenderer
+  {
+  public:
+    /**
+     *  Draw a node, its sockets and its tweaks, then update its size.
+     *  @param _processor The node.
+     *  @return true while its name is being edited.
+     **/
+    static bool draw(Processor& _processor);
+
+    /**
+     *  Draw a comment.
+     *  @param _comment The comment.
+     *  @return true.
+     **/
+    static bool draw(VisualComment& _comment);
+
+    /**
+     *  Draw the socket of an input and its tweak.
+     *  @param _input The input.
+     *  @return true if the user changed the input.
+     **/
+    static bool draw(ProcessorInput& _input);
+
+    /**
+     *  Draw the socket of an output and the value computed in Chill next to it.
+     *  @param _output The output.
+     *  @return false, the outputs have nothing to change.
+     **/
+    static bool draw(ProcessorOutput& _output);
+
+    /**
+     *  Draw the widget setting the value of an input, only its name once linked.
+     *  @param _input The input.
+     *  @return true if the value changed.
+     **/
+    static bool drawTweak(ProcessorInput& _input);
+  };
+}
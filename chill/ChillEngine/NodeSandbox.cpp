@@ -0,0 +1,516 @@
+#include "NodeSandbox.h"
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+#include <lualib.h>
+}
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace chill {
+
+  const int    NodeSandbox::c_instruction_budget = 1000000;
+  const size_t NodeSandbox::c_memory_budget      = 16 * 1024 * 1024;
+
+  std::mutex                                       NodeSandbox::s_mutex;
+  std::vector<std::unique_ptr<NodeSandbox::State>> NodeSandbox::s_pool;
+
+  namespace {
+    // registry keys, only their addresses matter
+    const char c_state_key    = 0;
+    const char c_run_key      = 0;
+    const char c_evaluate_key = 0;
+
+    const int c_table_depth = 8;
+
+    // Builds the environment of the nodes, returns the function running a node
+    // to record its declarations, and the function computing its outputs.
+    // Every node gets fresh globals and fresh copies of the libraries, so that
+    // nothing leaks from one node to the next. Unknown globals are a placeholder
+    // absorbing indexing, calls and arithmetic, so that the IceSL code after the
+    // declarations runs through.
+    const char* c_prelude = R"LUA(
+      local record = ...
+      local setfenv, setmetatable, getmetatable = setfenv, setmetatable, getmetatable
+      local loadstring, pcall, type, tostring, format = loadstring, pcall, type, tostring, string.format
+      local libs = { math = math, string = string, table = table }
+
+      local dummy = {}
+      local function same() return dummy end
+      setmetatable(dummy, {
+        __index = same, __newindex = function() end, __call = same,
+        __add = same, __sub = same, __mul = same, __div = same, __mod = same,
+        __pow = same, __unm = same, __concat = same,
+      })
+      -- input and data go on with the default value, or the placeholder
+      local function declare(record)
+        return function(...)
+          local value = record(...)
+          if value == nil then return dummy end
+          return value
+        end
+      end
+
+      local safe = {
+        assert = assert, error = error, ipairs = ipairs, next = next, pairs = pairs,
+        pcall = pcall, select = select, tonumber = tonumber, tostring = tostring,
+        type = type, unpack = unpack, rawequal = rawequal, rawget = rawget,
+        setmetatable = setmetatable, print = function() end,
+      }
+      -- their result is not the one IceSL would get
+      local varying = { math = { 'random', 'randomseed' } }
+      local function environment(api, unknown)
+        local env = {}
+        for name, lib in pairs(libs) do
+          local copy = {}
+          for _, f in ipairs(unknown and varying[name] or {}) do
+            local original = lib[f]
+            copy[f] = function(...) unknown() return original(...) end
+          end
+          env[name] = setmetatable(copy, { __index = lib })
+        end
+        return setmetatable(env, { __index = function(_, key)
+          local value = api[key]
+          if value == nil then value = safe[key] end
+          if value == nil then
+            if unknown then unknown() end
+            return dummy
+          end
+          return value
+        end })
+      end
+
+      local declarations = {
+        input = declare(record.input), data = declare(record.data), output = record.output,
+        emit = record.emit, setColor = record.setColor,
+      }
+      local function run(chunk)
+        setfenv(chunk, environment(declarations))
+        chunk()
+      end
+
+      -- the vectors of IceSL, as far as scalar nodes use them
+      local vec = {}
+      local function v(x, y, z) return setmetatable({ x = x or 0, y = y or 0, z = z or 0 }, vec) end
+      local function scale(a, s) return v(a.x * s, a.y * s, a.z * s) end
+      vec.__add = function(a, b) return v(a.x + b.x, a.y + b.y, a.z + b.z) end
+      vec.__sub = function(a, b) return v(a.x - b.x, a.y - b.y, a.z - b.z) end
+      vec.__unm = function(a) return v(-a.x, -a.y, -a.z) end
+      vec.__mul = function(a, b)
+        if type(a) == 'number' then return scale(b, a) end
+        if type(b) == 'number' then return scale(a, b) end
+        return v(a.x * b.x, a.y * b.y, a.z * b.z)
+      end
+      vec.__div = function(a, b)
+        if type(b) == 'number' then return scale(a, 1 / b) end
+        return v(a.x / b.x, a.y / b.y, a.z / b.z)
+      end
+      vec.__eq = function(a, b) return a.x == b.x and a.y == b.y and a.z == b.z end
+      local function dot(a, b) return a.x * b.x + a.y * b.y + a.z * b.z end
+      local function cross(a, b) return v(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x) end
+      local function length(a) return math.sqrt(dot(a, a)) end
+      local function normalize(a) return a / length(a) end
+      local vectors = { v = v, dot = dot, cross = cross, length = length, normalize = normalize }
+
+      -- a value as the Lua expression of a tweak, nil if it is not a scalar
+      local function number(n)
+        if type(n) ~= 'number' or n ~= n or n == math.huge or n == -math.huge then return nil end
+        return format('%.17g', n)
+      end
+      local function literal(value)
+        local kind = type(value)
+        if kind == 'number' then return number(value) end
+        if kind == 'boolean' then return tostring(value) end
+        if kind == 'string' then return format('%q', value) end
+        if kind ~= 'table' then return nil end
+        if getmetatable(value) == vec then
+          local x, y, z = number(value.x), number(value.y), number(value.z)
+          if x and y and z then return 'v(' .. x .. ', ' .. y .. ', ' .. z .. ')' end
+          return nil
+        end
+        local a, b, c, d = number(value[1]), number(value[2]), number(value[3]), number(value[4])
+        if a and b and c and d and value[5] == nil then return '{' .. a .. ', ' .. b .. ', ' .. c .. ', ' .. d .. '}' end
+        return nil
+      end
+
+      -- returns whether the node used anything unknown, IceSL or a missing input
+      local function evaluate(chunk, inputs, outputs)
+        local impure = false
+        local function unknown() impure = true end
+        local values = {}
+        for name, expression in pairs(inputs) do
+          local value = loadstring('return ' .. expression)
+          if value then
+            setfenv(value, vectors)
+            local ok, result = pcall(value)
+            if ok then values[name] = result end
+          end
+        end
+        local function bound(name)
+          local value = values[name]
+          if value == nil then
+            impure = true
+            return dummy
+          end
+          return value
+        end
+        local api = {
+          input = bound, data = bound, emit = function() end, setColor = function() end,
+          output = function(name, _, value) outputs[name] = literal(value) end,
+        }
+        for name, f in pairs(vectors) do api[name] = f end
+        setfenv(chunk, environment(api, unknown))
+        chunk()
+        return impure
+      end
+
+      return run, evaluate
+    )LUA";
+  }
+
+  //-------------------------------------------------------
+
+  struct NodeSandbox::State {
+    lua_State*     lua            = nullptr;
+    size_t         used           = 0;
+    bool           out_of_budget  = false;
+    NodeSignature* signature      = nullptr;
+
+    State();
+    ~State() {
+      if (lua) {
+        lua_close(lua);
+      }
+    }
+
+    static State* of(lua_State* _lua) {
+      lua_pushlightuserdata(_lua, const_cast<char*>(&c_state_key));
+      lua_rawget(_lua, LUA_REGISTRYINDEX);
+      State* state = static_cast<State*>(lua_touserdata(_lua, -1));
+      lua_pop(_lua, 1);
+      return state;
+    }
+  };
+
+  namespace {
+
+    void* allocate(void* _ud, void* _ptr, size_t _osize, size_t _nsize) {
+      NodeSandbox::State* state = static_cast<NodeSandbox::State*>(_ud);
+      if (_nsize == 0) {
+        free(_ptr);
+        state->used -= _osize;
+        return nullptr;
+      }
+      // shrinking must never fail
+      if (_nsize > _osize && state->used - _osize + _nsize > NodeSandbox::c_memory_budget) {
+        return nullptr;
+      }
+      void* ptr = realloc(_ptr, _nsize);
+      if (ptr) {
+        state->used = state->used - _osize + _nsize;
+      }
+      return ptr;
+    }
+
+    void budgetHook(lua_State* _lua, lua_Debug*) {
+      NodeSandbox::State::of(_lua)->out_of_budget = true;
+      // from now on every instruction fails, so that pcall cannot swallow the error
+      lua_sethook(_lua, budgetHook, LUA_MASKCOUNT, 1);
+      lua_pushstring(_lua, "instruction budget exceeded");
+      lua_error(_lua);
+    }
+
+    /** Write a value as Lua text, the way it would appear in the node file */
+    void serialize(lua_State* _lua, int _index, int _depth, std::string& _text) {
+      switch (lua_type(_lua, _index)) {
+      case LUA_TNUMBER:
+      {
+        lua_pushvalue(_lua, _index);
+        _text += lua_tostring(_lua, -1);
+        lua_pop(_lua, 1);
+        break;
+      }
+      case LUA_TBOOLEAN:
+        _text += lua_toboolean(_lua, _index) ? "true" : "false";
+        break;
+      case LUA_TSTRING:
+        // decoded, the inputs only strip the quotes
+        _text += '\'';
+        _text.append(lua_tostring(_lua, _index), lua_strlen(_lua, _index));
+        _text += '\'';
+        break;
+      case LUA_TTABLE:
+      {
+        if (_depth >= c_table_depth) {
+          _text += "{}";
+          break;
+        }
+        int    table = (_index > 0) ? _index : lua_gettop(_lua) + _index + 1;
+        size_t count = lua_objlen(_lua, table);
+        bool   first = true;
+        _text += "{";
+        for (size_t i = 1; i <= count; ++i) {
+          lua_rawgeti(_lua, table, static_cast<int>(i));
+          _text += first ? "" : ", ";
+          serialize(_lua, -1, _depth + 1, _text);
+          lua_pop(_lua, 1);
+          first = false;
+        }
+        lua_pushnil(_lua);
+        while (lua_next(_lua, table) != 0) {
+          // named fields only, the array part is already written
+          if (lua_type(_lua, -2) == LUA_TSTRING) {
+            _text += first ? "" : ", ";
+            _text += lua_tostring(_lua, -2);
+            _text += " = ";
+            serialize(_lua, -1, _depth + 1, _text);
+            first = false;
+          }
+          lua_pop(_lua, 1);
+        }
+        _text += "}";
+        break;
+      }
+      default:
+        _text += "nil";
+        break;
+      }
+    }
+
+    int recordInput(lua_State* _lua, bool _data_only) {
+      NodeSignature* signature = NodeSandbox::State::of(_lua)->signature;
+      if (lua_type(_lua, 1) == LUA_TSTRING && lua_type(_lua, 2) == LUA_TSTRING) {
+        NodeSignature::Input input;
+        input.name      = lua_tostring(_lua, 1);
+        input.type      = lua_tostring(_lua, 2);
+        input.data_only = _data_only;
+        for (int i = 3; i <= lua_gettop(_lua); ++i) {
+          input.params.emplace_back();
+          serialize(_lua, i, 0, input.params.back());
+        }
+        signature->inputs.push_back(input);
+      }
+      // the default value, if any
+      if (lua_gettop(_lua) >= 3) {
+        lua_pushvalue(_lua, 3);
+        return 1;
+      }
+      return 0;
+    }
+
+    int luaInput(lua_State* _lua) {
+      return recordInput(_lua, false);
+    }
+
+    int luaData(lua_State* _lua) {
+      return recordInput(_lua, true);
+    }
+
+    int luaOutput(lua_State* _lua) {
+      NodeSignature* signature = NodeSandbox::State::of(_lua)->signature;
+      if (lua_type(_lua, 1) == LUA_TSTRING && lua_type(_lua, 2) == LUA_TSTRING) {
+        NodeSignature::Output output;
+        output.name = lua_tostring(_lua, 1);
+        output.type = lua_tostring(_lua, 2);
+        signature->outputs.push_back(output);
+      }
+      return 0;
+    }
+
+    int luaEmit(lua_State* _lua) {
+      NodeSandbox::State::of(_lua)->signature->emit = true;
+      return 0;
+    }
+
+    int luaSetColor(lua_State* _lua) {
+      NodeSignature* signature = NodeSandbox::State::of(_lua)->signature;
+      if (!signature->has_color && lua_isnumber(_lua, 1) && lua_isnumber(_lua, 2) && lua_isnumber(_lua, 3)) {
+        signature->has_color = true;
+        for (int c = 0; c < 3; ++c) {
+          signature->color[c] = static_cast<int>(lua_tonumber(_lua, c + 1));
+        }
+      }
+      return 0;
+    }
+  }
+
+  //-------------------------------------------------------
+
+  NodeSandbox::State::State() {
+    lua = lua_newstate(allocate, this);
+    if (!lua) {
+      return;
+    }
+
+    lua_pushlightuserdata(lua, const_cast<char*>(&c_state_key));
+    lua_pushlightuserdata(lua, this);
+    lua_rawset(lua, LUA_REGISTRYINDEX);
+
+    // no io, os, package or debug
+    const lua_CFunction libs[] = { luaopen_base, luaopen_table, luaopen_string, luaopen_math };
+    for (lua_CFunction open : libs) {
+      lua_pushcfunction(lua, open);
+      lua_call(lua, 0, 0);
+    }
+
+    lua_newtable(lua);
+    const luaL_Reg record[] = {
+      { "input", luaInput }, { "data", luaData }, { "output", luaOutput },
+      { "emit", luaEmit }, { "setColor", luaSetColor }, { nullptr, nullptr }
+    };
+    for (const luaL_Reg* function = record; function->name; ++function) {
+      lua_pushcfunction(lua, function->func);
+      lua_setfield(lua, -2, function->name);
+    }
+
+    // the prelude gets the recording functions and returns the functions running a node
+    if (luaL_loadbuffer(lua, c_prelude, strlen(c_prelude), "=sandbox") != 0) {
+      lua_close(lua);
+      lua = nullptr;
+      return;
+    }
+    lua_insert(lua, -2);
+    if (lua_pcall(lua, 1, 2, 0) != 0) {
+      lua_close(lua);
+      lua = nullptr;
+      return;
+    }
+    lua_pushlightuserdata(lua, const_cast<char*>(&c_evaluate_key));
+    lua_insert(lua, -2);
+    lua_rawset(lua, LUA_REGISTRYINDEX);
+    lua_pushlightuserdata(lua, const_cast<char*>(&c_run_key));
+    lua_insert(lua, -2);
+    lua_rawset(lua, LUA_REGISTRYINDEX);
+  }
+
+  //-------------------------------------------------------
+
+  std::unique_ptr<NodeSandbox::State> NodeSandbox::acquire() {
+    {
+      std::lock_guard<std::mutex> lock(s_mutex);
+      if (!s_pool.empty()) {
+        std::unique_ptr<State> state = std::move(s_pool.back());
+        s_pool.pop_back();
+        return state;
+      }
+    }
+    return std::unique_ptr<State>(new State());
+  }
+
+  //-------------------------------------------------------
+
+  void NodeSandbox::release(std::unique_ptr<State> _state) {
+    size_t max = std::max<size_t>(1, std::thread::hardware_concurrency());
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_pool.size() < max) {
+      s_pool.push_back(std::move(_state));
+    }
+  }
+
+  //-------------------------------------------------------
+
+  bool NodeSandbox::extract(const std::string& _program, const std::string& _chunkname, NodeSignature& _signature, std::string& _error) {
+    std::unique_ptr<State> state = acquire();
+    lua_State* lua = state->lua;
+    if (!lua) {
+      _error = "cannot create a Lua state";
+      return false;
+    }
+
+    _signature = NodeSignature();
+    state->signature     = &_signature;
+    state->out_of_budget = false;
+
+    lua_pushlightuserdata(lua, const_cast<char*>(&c_run_key));
+    lua_rawget(lua, LUA_REGISTRYINDEX);
+    std::string chunkname = "@" + _chunkname;
+    if (luaL_loadbuffer(lua, _program.data(), _program.size(), chunkname.c_str()) != 0) {
+      _error = lua_tostring(lua, -1);
+      lua_settop(lua, 0);
+      release(std::move(state));
+      return false;
+    }
+
+    lua_sethook(lua, budgetHook, LUA_MASKCOUNT, c_instruction_budget);
+    int status = lua_pcall(lua, 1, 0, 0);
+    lua_sethook(lua, nullptr, 0, 0);
+
+    // the declarations after an error are missing, the signature is not complete
+    bool ok = status == 0;
+    if (!ok) {
+      _error = lua_isstring(lua, -1) ? lua_tostring(lua, -1) : "error";
+    }
+    lua_settop(lua, 0);
+    state->signature = nullptr;
+
+    if (status == LUA_ERRMEM) {
+      // not worth keeping a state that ran out of memory
+      return ok;
+    }
+    lua_gc(lua, LUA_GCCOLLECT, 0);
+    release(std::move(state));
+    return ok;
+  }
+
+  //-------------------------------------------------------
+
+  bool NodeSandbox::evaluate(const std::string& _program, const std::string& _chunkname, const Values& _inputs, Values& _outputs, bool& _pure, std::string& _error) {
+    _outputs.clear();
+    _pure = false;
+    std::unique_ptr<State> state = acquire();
+    lua_State* lua = state->lua;
+    if (!lua) {
+      _error = "cannot create a Lua state";
+      return false;
+    }
+    state->out_of_budget = false;
+
+    lua_pushlightuserdata(lua, const_cast<char*>(&c_evaluate_key));
+    lua_rawget(lua, LUA_REGISTRYINDEX);
+    std::string chunkname = "@" + _chunkname;
+    if (luaL_loadbuffer(lua, _program.data(), _program.size(), chunkname.c_str()) != 0) {
+      _error = lua_tostring(lua, -1);
+      lua_settop(lua, 0);
+      release(std::move(state));
+      return false;
+    }
+    lua_newtable(lua);
+    for (const auto& input : _inputs) {
+      lua_pushlstring(lua, input.second.data(), input.second.size());
+      lua_setfield(lua, -2, input.first.c_str());
+    }
+    lua_newtable(lua);
+    lua_pushvalue(lua, -1);
+    // the outputs table stays below the call
+    lua_insert(lua, 1);
+
+    lua_sethook(lua, budgetHook, LUA_MASKCOUNT, c_instruction_budget);
+    int status = lua_pcall(lua, 3, 1, 0);
+    lua_sethook(lua, nullptr, 0, 0);
+
+    if (status != 0) {
+      _error = lua_isstring(lua, -1) ? lua_tostring(lua, -1) : "error";
+    } else {
+      _pure = !lua_toboolean(lua, -1);
+      lua_pushnil(lua);
+      while (lua_next(lua, 1) != 0) {
+        if (lua_type(lua, -2) == LUA_TSTRING && lua_type(lua, -1) == LUA_TSTRING) {
+          _outputs.emplace_back(lua_tostring(lua, -2), std::string(lua_tostring(lua, -1), lua_strlen(lua, -1)));
+        }
+        lua_pop(lua, 1);
+      }
+    }
+    lua_settop(lua, 0);
+
+    if (status == LUA_ERRMEM) {
+      return false;
+    }
+    lua_gc(lua, LUA_GCCOLLECT, 0);
+    release(std::move(state));
+    return status == 0;
+  }
+}
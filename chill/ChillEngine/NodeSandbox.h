@@ -0,0 +1,79 @@
+/** @file */
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "NodeSignature.h"
+
+struct lua_State;
+
+namespace chill {
+
+  /**
+   *  NodeSandbox class.
+   *  Extract the signature of a node by running its program in the embedded Lua,
+   *  with input, data, output, emit and setColor replaced by functions recording
+   *  their arguments. Computed defaults, tables and string escapes are thus read
+   *  exactly as IceSL would see them.
+   *  Nodes computing numbers, vectors or strings can also be run on actual input
+   *  values, to get their outputs without IceSL.
+   *  The program only sees the safe parts of the standard library, everything
+   *  else (IceSL API, shapes, ...) answers with an inert placeholder. Runaway
+   *  programs are stopped by an instruction and a memory budget.
+   *  The Lua states are pooled and can be used from several threads.
+   **/
+  class NodeSandbox
+  {
+  public:
+    /** Number of Lua instructions a node may run */
+    static const int    c_instruction_budget;
+    /** Memory a Lua state may allocate, in bytes */
+    static const size_t c_memory_budget;
+
+    /**
+     *  Run a node program and record its declarations.
+     *  A program that does not compile, raises an error or exceeds its budget fails:
+     *  the declarations after the error would be missing.
+     *  @param _program The Lua code of the node.
+     *  @param _chunkname The name used in the error messages, usually the node path.
+     *  @param _signature The recorded signature.
+     *  @param _error The error message, if any.
+     *  @return false if the signature could not be extracted.
+     **/
+    static bool extract(const std::string& _program, const std::string& _chunkname, NodeSignature& _signature, std::string& _error);
+
+    /** Values by name, as Lua expressions */
+    typedef std::vector<std::pair<std::string, std::string>> Values;
+
+    /**
+     *  Run a node program on input values and get the outputs it computes.
+     *  Besides the placeholder, the program sees the vectors of IceSL (v, dot, cross,
+     *  length, normalize). Only the outputs set to a number, a boolean, a string, a
+     *  vector or a table of four numbers are returned; the ones depending on shapes,
+     *  fields or anything else of IceSL come out as the placeholder and are left out.
+     *  @param _program The Lua code of the node.
+     *  @param _chunkname The name used in the error messages, usually the node path.
+     *  @param _inputs The input values, as written by ProcessorInput::luaValue.
+     *  @param _outputs The computed outputs, written the same way.
+     *  @param _pure Set to false if the program read a global or an input it was not given,
+     *               IceSL would then do more than computing the outputs.
+     *  @param _error The error message, if any.
+     *  @return false if the program does not compile, fails or exceeds its budget.
+     **/
+    static bool evaluate(const std::string& _program, const std::string& _chunkname, const Values& _inputs, Values& _outputs, bool& _pure, std::string& _error);
+
+    /** A pooled Lua state, defined in NodeSandbox.cpp */
+    struct State;
+
+  private:
+    static std::unique_ptr<State> acquire();
+    static void                   release(std::unique_ptr<State> _state);
+
+    static std::mutex                          s_mutex;
+    static std::vector<std::unique_ptr<State>> s_pool;
+  };
+}
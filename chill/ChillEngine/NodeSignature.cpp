@@ -0,0 +1,142 @@
+#include "NodeSignature.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string_view>
+
+#include "LuaLexer.h"
+
+namespace chill {
+
+  namespace {
+
+    using namespace lua;
+
+    /**
+     *  Read a literal parameter: string, number, boolean or table.
+     *  @return false if the parameter is an expression.
+     **/
+    bool readParameter(Lexer& _lexer, Token _token, std::string& _raw) {
+      size_t from = _lexer.position() - _token.text.size();
+      if (isSymbol(_token, '-')) {
+        _token = _lexer.next();
+        if (_token.kind != NUMBER) return false;
+      } else if (isSymbol(_token, '{')) {
+        int depth = 1;
+        while (depth > 0) {
+          _token = _lexer.next();
+          if (_token.kind == END) return false;
+          if (isSymbol(_token, '{')) depth++;
+          if (isSymbol(_token, '}')) depth--;
+        }
+      } else if (_token.kind == NAME) {
+        if (_token.text != "true" && _token.text != "false") return false;
+      } else if (_token.kind != STRING && _token.kind != NUMBER) {
+        return false;
+      }
+      _raw = std::string(_lexer.text(from, _lexer.position()));
+      return true;
+    }
+
+    /** Read ("name", "type" after the function name */
+    bool readNameAndType(Lexer& _lexer, std::string& _name, std::string& _type) {
+      Token name = _lexer.next();
+      if (name.kind != STRING || !isSymbol(_lexer.next(), ',')) return false;
+      Token type = _lexer.next();
+      if (type.kind != STRING) return false;
+      _name = std::string(unquote(name));
+      _type = std::string(unquote(type));
+      return true;
+    }
+
+    /** input("name", "type", params...) or data(...) */
+    bool readInput(Lexer& _lexer, NodeSignature::Input& _input) {
+      if (!readNameAndType(_lexer, _input.name, _input.type)) return false;
+      Token token = _lexer.next();
+      while (isSymbol(token, ',')) {
+        token = _lexer.next();
+        // a trailing comma is accepted
+        if (isSymbol(token, ')')) break;
+        std::string raw;
+        if (!readParameter(_lexer, token, raw)) return false;
+        _input.params.push_back(raw);
+        token = _lexer.next();
+      }
+      return isSymbol(token, ')');
+    }
+
+    /** output("name", "type", anything) */
+    bool readOutput(Lexer& _lexer, NodeSignature::Output& _output) {
+      if (!readNameAndType(_lexer, _output.name, _output.type)) return false;
+      int depth = 1;
+      while (depth > 0) {
+        Token token = _lexer.next();
+        if (token.kind == END) return false;
+        if (isSymbol(token, '(')) depth++;
+        if (isSymbol(token, ')')) depth--;
+      }
+      return true;
+    }
+
+    /** setColor(r, g, b) */
+    bool readColor(Lexer& _lexer, int _color[3]) {
+      for (int c = 0; c < 3; ++c) {
+        if (c > 0 && !isSymbol(_lexer.next(), ',')) return false;
+        Token token = _lexer.next();
+        bool negative = isSymbol(token, '-');
+        if (negative) token = _lexer.next();
+        if (token.kind != NUMBER) return false;
+        _color[c] = atoi(std::string(token.text).c_str()) * (negative ? -1 : 1);
+      }
+      return isSymbol(_lexer.next(), ')');
+    }
+  }
+
+  //-------------------------------------------------------
+
+  NodeSignature NodeSignature::parse(const std::string& _program) {
+    NodeSignature signature;
+
+    Lexer lexer(_program);
+    Token previous;
+    Token token = lexer.next();
+    while (token.kind != END) {
+      // a call to a global function: input(...), not t.input(...) or t:input(...)
+      bool call = token.kind == NAME && !isSymbol(previous, '.') && !isSymbol(previous, ':');
+      previous  = token;
+      token     = lexer.next();
+      if (!call || !isSymbol(token, '(')) {
+        continue;
+      }
+
+      // a malformed declaration is ignored and the scan resumes after its '('
+      Lexer resume = lexer;
+      bool  ok     = false;
+      if (previous.text == "input" || previous.text == "data") {
+        Input input;
+        input.data_only = (previous.text == "data");
+        ok = readInput(lexer, input);
+        if (ok) signature.inputs.push_back(input);
+      } else if (previous.text == "output") {
+        Output output;
+        ok = readOutput(lexer, output);
+        if (ok) signature.outputs.push_back(output);
+      } else if (previous.text == "emit") {
+        signature.emit = true;
+      } else if (previous.text == "setColor" && !signature.has_color) {
+        int color[3];
+        ok = readColor(lexer, color);
+        if (ok) {
+          signature.has_color = true;
+          std::copy(color, color + 3, signature.color);
+        }
+      }
+      if (!ok) {
+        lexer = resume;
+      }
+      previous = Token();
+      token    = lexer.next();
+    }
+    return signature;
+  }
+}
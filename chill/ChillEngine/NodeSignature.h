@@ -0,0 +1,44 @@
+/** @file */
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace chill {
+
+  /**
+   *  NodeSignature struct.
+   *  What a node file declares: its inputs, outputs, color and whether it emits.
+   *  Computed once per file and shared by all the nodes using it.
+   **/
+  struct NodeSignature
+  {
+    /** An input(...) or data(...) declaration */
+    struct Input {
+      std::string              name;
+      std::string              type;
+      /** Raw Lua text of the extra parameters (default value, min, max, ...) */
+      std::vector<std::string> params;
+      bool                     data_only = false;
+    };
+
+    /** An output(...) declaration */
+    struct Output {
+      std::string name;
+      std::string type;
+    };
+
+    std::vector<Input>  inputs;
+    std::vector<Output> outputs;
+    bool                emit      = false;
+    bool                has_color = false;
+    int                 color[3]  = { 0, 0, 0 };
+
+    /**
+     *  Extract the signature of a node program.
+     *  @param _program The Lua code of the node.
+     *  @return The signature.
+     **/
+    static NodeSignature parse(const std::string& _program);
+  };
+}
@@ -0,0 +1,99 @@
+#include "OutputSlots.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include "IOs.h"
+#include "ProcessingGraph.h"
+
+namespace chill {
+
+  namespace {
+    /** Differs from the epochs of the tables of this process, and likely of the ones before */
+    uint64_t newEpoch() {
+      static std::atomic<uint64_t> s_count(0);
+      uint64_t clock = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+      return (clock << 16) ^ s_count++;
+    }
+  }
+
+  //-------------------------------------------------------
+
+  OutputSlots::OutputSlots()
+    : m_epoch(newEpoch())
+  {}
+
+  //-------------------------------------------------------
+
+  void OutputSlots::clear() {
+    m_slots.clear();
+    m_free.clear();
+    m_next  = 1;
+    m_epoch = newEpoch();
+  }
+
+  //-------------------------------------------------------
+
+  bool OutputSlots::assign(ProcessingGraph& _graph) {
+    std::vector<int64_t> outputs;
+    visit(_graph, outputs);
+
+    std::unordered_map<int64_t, int> slots;
+    std::vector<int64_t>             added;
+    for (int64_t output : outputs) {
+      auto known = m_slots.find(output);
+      if (known != m_slots.end()) {
+        slots[output] = known->second;
+      } else {
+        added.push_back(output);
+      }
+    }
+    bool changed = false;
+    for (const auto& gone : m_slots) {
+      if (!slots.count(gone.first)) {
+        m_free.push_back(gone.second);
+        changed = true;
+      }
+    }
+    // the lowest slots are given first, the array stays dense
+    std::sort(m_free.begin(), m_free.end(), std::greater<int>());
+    for (int64_t output : added) {
+      if (!m_free.empty()) {
+        slots[output] = m_free.back();
+        m_free.pop_back();
+      } else {
+        slots[output] = m_next++;
+      }
+    }
+    m_slots.swap(slots);
+    return changed;
+  }
+
+  //-------------------------------------------------------
+
+  int OutputSlots::slot(ProcessorOutput& _output) const {
+    auto found = m_slots.find(_output.getUniqueID());
+    return found == m_slots.end() ? 0 : found->second;
+  }
+
+  //-------------------------------------------------------
+
+  void OutputSlots::visit(ProcessingGraph& _graph, std::vector<int64_t>& _outputs) {
+    // the outputs of a group are written by its GroupOutput
+    for (std::shared_ptr<ProcessorOutput> output : _graph.outputs()) {
+      _outputs.push_back(output->getUniqueID());
+    }
+    for (std::shared_ptr<Processor> processor : *_graph.processors()) {
+      ProcessingGraph* inner = dynamic_cast<ProcessingGraph*>(processor.get());
+      if (inner) {
+        visit(*inner, _outputs);
+        continue;
+      }
+      for (std::shared_ptr<ProcessorOutput> output : processor->outputs()) {
+        _outputs.push_back(output->getUniqueID());
+      }
+    }
+  }
+}
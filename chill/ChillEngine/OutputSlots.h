@@ -0,0 +1,61 @@
+/** @file */
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace chill {
+  class ProcessingGraph;
+  class ProcessorOutput;
+
+  /**
+   *  OutputSlots class.
+   *  The places of the node outputs in the array of a script written with slots,
+   *  see ExportOptions::slots. Kept from an export to the next, an output keeps its
+   *  slot and IceSL finds the outputs of the clean nodes where it left them; the
+   *  slots of the outputs gone go to new outputs, whose nodes are dirty.
+   **/
+  class OutputSlots
+  {
+  public:
+    OutputSlots();
+
+    /**
+     *  Give a slot to each output of a graph and of the graphs it contains, free the others.
+     *  @param _graph The main graph.
+     *  @return Whether a slot changed hands since the last call.
+     **/
+    bool assign(ProcessingGraph& _graph);
+
+    /**
+     *  Get the slot of an output.
+     *  @param _output The output, of the graph of the last assign.
+     *  @return The slot from 1, 0 if it has none.
+     **/
+    int slot(ProcessorOutput& _output) const;
+
+    /** The highest slot given, the size of the array */
+    int size() const {
+      return m_next - 1;
+    }
+
+    /** Changes with the numbering: another table, or a cleared one */
+    uint64_t epoch() const {
+      return m_epoch;
+    }
+
+    /** Forget the slots, the nodes of the next script run from scratch */
+    void clear();
+
+  private:
+    static void visit(ProcessingGraph& _graph, std::vector<int64_t>& _outputs);
+
+    // by unique ID of the outputs
+    std::unordered_map<int64_t, int> m_slots;
+    // the slots of the outputs gone, lowest last
+    std::vector<int>                 m_free;
+    int                              m_next = 1;
+    uint64_t                         m_epoch;
+  };
+}
@@ -0,0 +1,52 @@
+/** @file */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace chill {
+
+  /**
+   *  Call a function for each index in [0, _count), spread over several threads.
+   *  The indices are handed out one at a time, so uneven jobs stay balanced.
+   *  @param _count The number of indices.
+   *  @param _workers The number of threads, the calling one included.
+   *  @param _body The function, called as _body(size_t index) from several threads.
+   **/
+  template <typename T_Body>
+  void parallelFor(size_t _count, size_t _workers, T_Body _body)
+  {
+    size_t workers = std::min(std::max<size_t>(1, _workers), _count);
+
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+      for (size_t i = next++; i < _count; i = next++) {
+        _body(i);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < workers; ++t) {
+      threads.emplace_back(work);
+    }
+    work();
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+
+  //-------------------------------------------------------
+
+  /**
+   *  Call a function for each index in [0, _count), spread over all the cores.
+   *  @param _count The number of indices.
+   *  @param _body The function, called as _body(size_t index) from several threads.
+   **/
+  template <typename T_Body>
+  void parallelFor(size_t _count, T_Body _body)
+  {
+    parallelFor(_count, std::thread::hardware_concurrency(), _body);
+  }
+}
@@ -1,5 +1,6 @@
 #include "ProcessingGraph.h"
 
+#include "GraphExporter.h"
 
 namespace chill {
 
@@ -231,12 +232,12 @@ namespace chill {
     auto barycenter = getBarycenter(subset);
 
     innerGraph->setPosition(barycenter);
-    groupInputs->setPosition (ImVec2(bbox.minCorner()[0] - style.processor_width * 2, barycenter.y));
-    groupOutputs->setPosition(ImVec2(bbox.maxCorner()[0] + style.processor_width * 2, barycenter.y));
+    groupInputs->setPosition (Vec2(bbox.minCorner()[0] - style.processor_width * 2, barycenter.y));
+    groupOutputs->setPosition(Vec2(bbox.maxCorner()[0] + style.processor_width * 2, barycenter.y));
     return innerGraph;
   }
 
-  void ProcessingGraph::expandGraph(std::shared_ptr<ProcessingGraph> collapsed, ImVec2 position) {
+  void ProcessingGraph::expandGraph(std::shared_ptr<ProcessingGraph> collapsed, Vec2 position) {
 
     // Move processors
     for (std::shared_ptr<Processor> processor : collapsed->m_processors) {
@@ -265,7 +266,7 @@ namespace chill {
       }
     }
 
-    ImVec2 offset = position - collapsed->getBarycenter();
+    Vec2 offset = position - collapsed->getBarycenter();
     for (std::shared_ptr<Processor> processor : collapsed->m_processors) {
       processor->setPosition(processor->getPosition() + offset);
     }
@@ -325,16 +326,17 @@ namespace chill {
     return graph;
   }
 
-  void ProcessingGraph::save(std::ofstream& _stream) {
-    _stream << "p_" << getUniqueID() << " = Graph('" << name() << "')" << std::endl;
+  void ProcessingGraph::save(LuaWriter& _writer) {
+    _writer << "p_" << getUniqueID() << " = Graph(";
+    _writer.quoted(name()) << ")\n";
     
-    ImVec2 bar = getBarycenter();
+    Vec2 bar = getBarycenter();
     // Save the nodes
     for (std::shared_ptr<Processor> proc : m_processors) {
-      proc->translate(ImVec2(0,0)-bar);
-      proc->save(_stream);
+      proc->translate(Vec2(0,0)-bar);
+      proc->save(_writer);
       proc->translate(bar);
-      _stream << "p_" << getUniqueID() << ":add( p_" << proc->getUniqueID() << ")" << std::endl;
+      _writer << "p_" << getUniqueID() << ":add( p_" << proc->getUniqueID() << ")\n";
     }
 
     // Save the connections
@@ -342,13 +344,13 @@ namespace chill {
       for (std::shared_ptr<ProcessorInput> input : proc->inputs()) {
         std::shared_ptr<ProcessorOutput> output = input->m_link;
         if (!output) continue;
-        _stream << "connect( o_" << output->getUniqueID() << ", i_" << input->getUniqueID() << ")" << std::endl;
+        _writer << "connect( o_" << output->getUniqueID() << ", i_" << input->getUniqueID() << ")\n";
       }
     }
-    _stream << "set_graph(p_" << getUniqueID() << ")" << std::endl;
+    _writer << "set_graph(p_" << getUniqueID() << ")\n";
   }
 
-  void ProcessingGraph::iceSL(std::ofstream& _stream) {
+  void ProcessingGraph::iceSL(LuaWriter& _writer) {
     std::set<Processor*> done;
     std::unordered_set<Processor*> toDo;
 
@@ -365,31 +367,31 @@ namespace chill {
       }
     }
 
-    _stream << "--[[ " + std::string(name()) + " ]]--" << std::endl <<
-               "setfenv(1, _G0)  --go back to global initialization" << std::endl <<
-               "__currentNodeId = " << std::to_string(reinterpret_cast<int64_t>(this)) << std::endl;
+    _writer << "--[[ " << name() << " ]]--\n" <<
+               "setfenv(1, _G0)  --go back to global initialization\n" <<
+               "__currentNodeId = " << reinterpret_cast<int64_t>(this) << "\n";
 
     if ( (owner() != nullptr && owner()->isDirty()) || isDirty() || isEmiter()) {
-      _stream << "setDirty(__currentNodeId)" << std::endl;
+      _writer << "setDirty(__currentNodeId)\n";
     }
+    GraphExporter::writeChanges(_writer, *this, std::string());
 
-    _stream << "if (isDirty({__currentNodeId";
+    _writer << "if (isDirty({__currentNodeId";
 
     for (auto input : inputs()) {
       if (input->m_link) {
-        std::string s2 = std::to_string(reinterpret_cast<int64_t>(input->m_link->owner()));
-        _stream << ", " + s2;
+        _writer << ", " << reinterpret_cast<int64_t>(input->m_link->owner());
       }
     }
 
-    _stream << "})) then" << std::endl
-            << "setDirty(__currentNodeId)" << std::endl
-            << "end" << std::endl;
+    _writer << "})) then\n"
+            << "setDirty(__currentNodeId)\n"
+            << "end\n";
 
     while (!toDo.empty()) {
       Processor* processor = *toDo.begin();
       toDo.erase(toDo.begin());
-      processor->iceSL(_stream);
+      processor->iceSL(_writer);
       done.emplace(processor);
 
       for (std::shared_ptr<ProcessorOutput> output : processor->outputs()) {
@@ -414,6 +416,33 @@ namespace chill {
     toDo.clear();
     done.clear();
 
-    _stream << "--[[ ! " + std::string(name()) + " ]]--\n" << std::endl;
+    _writer << "--[[ ! " << name() << " ]]--\n\n";
+  }
+
+  //-------------------------------------------------------
+
+  std::vector<std::shared_ptr<ProcessorInput>> ProcessingGraph::tweaks(const std::string& _name) {
+    size_t      slash = _name.rfind('/');
+    std::string processor_name = (slash == std::string::npos) ? std::string() : _name.substr(0, slash);
+    std::string input_name     = (slash == std::string::npos) ? _name : _name.substr(slash + 1);
+
+    std::vector<std::shared_ptr<ProcessorInput>> found;
+    for (std::shared_ptr<Processor> processor : m_processors) {
+      ProcessingGraph* inner = dynamic_cast<ProcessingGraph*>(processor.get());
+      if (inner) {
+        std::vector<std::shared_ptr<ProcessorInput>> nested = inner->tweaks(_name);
+        found.insert(found.end(), nested.begin(), nested.end());
+        continue;
+      }
+      if (slash != std::string::npos && processor->name() != processor_name) {
+        continue;
+      }
+      for (std::shared_ptr<ProcessorInput> input : processor->inputs()) {
+        if (input && !input->m_link && input->name() == input_name) {
+          found.push_back(input);
+        }
+      }
+    }
+    return found;
   }
 }
@@ -155,7 +155,7 @@ class ProcessingGraph : public Processor
      *  @param _graph The graph to expand.
      *  @param _position Where the graph has to expand.
      **/
-    void expandGraph(std::shared_ptr<ProcessingGraph> _graph, ImVec2 _position);
+    void expandGraph(std::shared_ptr<ProcessingGraph> _graph, Vec2 _position);
     
     void addProxy(std::shared_ptr<ProcessorOutput> _proxy_o, std::shared_ptr<ProcessorInput> _proxy_i)
     {
@@ -184,6 +184,15 @@ class ProcessingGraph : public Processor
     {
       return m_comments;
     }
+
+    /**
+     *  Find tweaks by name, in this graph and in the nested ones.
+     *  A tweak is an input of a node that no output is linked to.
+     *  @param _name "input" for all the tweaks with this name,
+     *               "processor/input" for those of the processors with this name.
+     *  @return The tweaks found.
+     */
+    std::vector<std::shared_ptr<ProcessorInput>> tweaks(const std::string& _name);
     
   public:
     //bool draw();
@@ -192,9 +201,9 @@ class ProcessingGraph : public Processor
       return std::shared_ptr<SelectableUI>(new ProcessingGraph(*this));
     }
 
-    void save(std::ofstream& _stream);
+    void save(LuaWriter& _writer);
 
-    void iceSL(std::ofstream& _stream);
+    void iceSL(LuaWriter& _writer);
 
     bool isDirty() {
       for (std::shared_ptr<Processor> processor : m_processors) {
@@ -205,15 +214,15 @@ class ProcessingGraph : public Processor
       return false;
     }
     
-    ImVec2 getBarycenter(const std::vector<std::shared_ptr<SelectableUI>>& _elements) {
-      ImVec2 position(0, 0);
+    Vec2 getBarycenter(const std::vector<std::shared_ptr<SelectableUI>>& _elements) {
+      Vec2 position(0, 0);
       for (std::shared_ptr<SelectableUI> element : _elements) {
         position += element->getPosition();
       }
       return position / static_cast<float>(_elements.size());
     }
 
-    ImVec2 getBarycenter() {
+    Vec2 getBarycenter() {
 
       std::vector<std::shared_ptr<SelectableUI>> list;
       for (std::shared_ptr<Processor> proc : m_processors) {
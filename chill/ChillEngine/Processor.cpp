@@ -1,6 +1,7 @@
 #include "Processor.h"
 #include "ProcessingGraph.h"
 #include "IOs.h"
+#include "GraphExporter.h"
 
 namespace chill {
 
@@ -188,364 +189,78 @@ std::shared_ptr<ProcessorInput> Processor::addInput(std::shared_ptr<ProcessorInp
     return false;
   }
 
-  void Processor::save(std::ofstream& stream) {
-    ImVec4 color4vec = ImGui::ColorConvertU32ToFloat4(color());
-    stream << "p_" << getUniqueID() << " = Processor({" <<
-              "name = '" << m_name << "'" <<
+  void Processor::save(LuaWriter& _writer) {
+    _writer << "p_" << getUniqueID() << " = Processor({name = ";
+    _writer.quoted(m_name) <<
               ", x = " << getPosition().x <<
               ", y = " << getPosition().y <<
-              ", color = {" << int(color4vec.x * 255) << ", " << int(color4vec.y * 255) << ", " << int(color4vec.z * 255) << "}"
-              "})" << std::endl;
+              ", color = {" << int(color().r) << ", " << int(color().g) << ", " << int(color().b) << "}"
+              "})\n";
     
     /* Saving I/Os is not usefull in general case*/
     // Save inputs
     for (std::shared_ptr<ProcessorInput> input : m_inputs) {
-      input->save(stream);
-      stream << "p_" << getUniqueID() << ":add(i_" << input->getUniqueID() << ")" << std::endl;
+      input->save(_writer);
+      _writer << "p_" << getUniqueID() << ":add(i_" << input->getUniqueID() << ")\n";
     }
     // Save outputs
     for (std::shared_ptr<ProcessorOutput> output : m_outputs) {
-      output->save(stream);
-      stream << "p_" << getUniqueID() << ":add(o_" << output->getUniqueID() << ")" << std::endl;
+      output->save(_writer);
+      _writer << "p_" << getUniqueID() << ":add(o_" << output->getUniqueID() << ")\n";
     }
   }
   
-  void Processor::iceSL(std::ofstream& ) {}
+  void Processor::iceSL(LuaWriter& ) {}
 };
 
-bool chill::Processor::draw() {
-  ImGui::PushID(int(getUniqueID()));
-
-  ImGuiWindow* window = ImGui::GetCurrentWindow();
-  ImDrawList* draw_list = ImGui::GetWindowDrawList();
-
-  float w_scale = window->FontWindowScale;
-
-  ImVec2 size = m_size * w_scale;
-
-  ImVec2 min_pos = ImGui::GetCursorScreenPos();
-  ImVec2 max_pos = min_pos + size;
-
-  float border_width = style.processor_border_width * w_scale;
-  float rounding_corners = style.processor_rounding_corners * w_scale;
-
-  // shadow
-  if (m_selected || w_scale > 0.5F) {
-    draw_list->AddRectFilled(
-      min_pos + ImVec2(10, 10) * w_scale,
-      max_pos + ImVec2(10, 10) * w_scale,
-      style.processor_shadow_color,
-      rounding_corners + 5.0F, style.processor_rounded_corners);
-  }
-
-  // border
-  ImVec2 border = ImVec2(style.processor_border_width, style.processor_border_width) * w_scale / 2.0F;
-  draw_list->AddRect(
-    min_pos - border,
-    max_pos + border,
-    m_selected ? style.processor_selected_color : m_color,
-    rounding_corners, style.processor_rounded_corners,
-    border_width
-  );
-
-  // background
-  draw_list->AddRectFilled(min_pos, max_pos, style.processor_bg_color, rounding_corners, style.processor_rounded_corners);
-
-  float height = ImGui::GetCursorPosY();
-
-  float padding = (style.socket_radius + style.socket_border_width + style.ItemSpacing.x) * w_scale;
-
-  ImGui::PushItemWidth(m_size.x * w_scale - padding * 2.F);
-  ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, style.ItemSpacing * w_scale);
-
-  ImGui::BeginGroup();
-
-  float button_size = style.processor_title_height / 1.2F * w_scale;
-
-  // draw title
-  
-
-  if (w_scale > 0.7F) {
-	  ImVec2 title_size(style.processor_width, style.processor_title_height);
-	  title_size *= w_scale;
-	  draw_list->AddRectFilled(min_pos, min_pos + title_size,
-		  m_color,
-		  rounding_corners, style.processor_rounded_corners & 3);
-    if (!m_edit) {
-      ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
-      ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0, 0, 0, 0));
-      ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0, 0, 0, 0));
-      ImGui::PushStyleColor(ImGuiCol_Border, ImVec4(0, 0, 0, 255));
-      ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0, 0, 0, 255));
-
-
-      if (ImGui::ButtonEx((name() + "##" + std::to_string(getUniqueID())).c_str(), title_size - ImVec2(2 * button_size, 0), ImGuiButtonFlags_PressedOnDoubleClick)) {
-        m_edit = true;
-      }
-      ImGui::PopStyleColor(5);
-    } else {
-      char title[32];
-      strncpy(title, name().c_str(), 32);
-      if (ImGui::InputText(("##" + std::to_string(getUniqueID())).c_str(), title, 32)) {
-        setName(title);
-      } else if (!m_selected) {
-        m_edit = false;
-      }
-    }
-    ImGui::SetCursorPosY(ImGui::GetCursorPosY() + padding);
-  } else {
-
-	  ImVec2 title_size(style.processor_width, style.processor_title_height);
-	  title_size *= w_scale;
-    ImVec2 cursor = ImGui::GetCursorPos() + ImVec2(0, 2*padding + title_size.y);
-	  draw_list->AddRectFilled(min_pos, max_pos,
-		  m_color,
-		  rounding_corners, style.processor_rounded_corners & 3);
-	  ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
-	  ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0, 0, 0, 0));
-	  ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0, 0, 0, 0));
-	  ImGui::PushStyleColor(ImGuiCol_Border, ImVec4(0, 0, 0, 255));
-	  ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0, 0, 0, 255));
-	  ImGui::SetWindowFontScale(min(1.3f,2* w_scale));
-	
-    ImVec2 textSize = ImGui::CalcTextSize(name().c_str());
-    ImGui::SetCursorPosX(ImGui::GetCursorPosX() + (m_size[0]*w_scale - textSize[0])/2.0);
-    ImGui::SetCursorPosY(ImGui::GetCursorPosY() + (m_size[1] * w_scale - textSize[1]) / 2.0);
-	  ImGui::Text( "%s" ,name().c_str(), m_size );
-    ImGui::SetCursorPos(cursor);
-	  ImGui::SetWindowFontScale(w_scale);
-	  ImGui::PopStyleColor(5);
-  }
-  ImGui::PushStyleVar(ImGuiStyleVar_FrameBorderSize, 2);
-  ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 20);
-
-  
-  
-  // Drag and Drop Target
-  bool value_changed = false;
-  if (ImGui::BeginDragDropTarget())
-  {
-    float col[4];
-    if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload(IMGUI_PAYLOAD_TYPE_COLOR_3F))
-    {
-      memcpy(static_cast<float*>(col), payload->Data, sizeof(float) * 3);
-      value_changed = true;
-    }
-    if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload(IMGUI_PAYLOAD_TYPE_COLOR_4F))
-    {
-      memcpy(static_cast<float*>(col), payload->Data, sizeof(float) * 4);
-      value_changed = true;
-    }
-    if (value_changed) m_color = ImColor(col[0], col[1], col[2]);
-    ImGui::EndDragDropTarget();
-  }
-
-  // DISABLE / EMIT
-
-  bool isStateful = false;
-  for (auto output : m_outputs) {
-    if (output->type() == IOType::SHAPE) {
-      isStateful = true;
-      break;
-    }
-  }
-  /*
-  if (isStateful || isEmiter()) {
-    ImGui::SameLine();
-    ImGui::SetCursorPosY(ImGui::GetCursorPosY() + (style.processor_title_height * w_scale - button_size)/2.0F);
-    ImU32 color(m_state == DISABLED ? 0XFF0000CC : m_state == DEFAULT ? 0XFFCC7700 : m_state == EMITING ? 0XFF00CC00 : 0XFF888888);
-    ImGui::PushStyleColor(ImGuiCol_Button, color);
-    ImGui::PushStyleColor(ImGuiCol_ButtonHovered, color);
-    ImGui::PushStyleColor(ImGuiCol_ButtonActive, color);
-    ImGui::PushStyleColor(ImGuiCol_Border, ImVec4(0, 0, 0, 255));
-    ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, button_size);
-    ImGui::PushStyleVar(ImGuiStyleVar_FrameBorderSize, 1);
-    if (ImGui::Button("", ImVec2(button_size, button_size))) {
-      setDirty(true);
-      switch (m_state) {
-      case DISABLED:
-        m_state = DEFAULT;
-        break;
-      case DEFAULT:
-        if (isEmiter())
-          m_state = DISABLED;
-        else
-          m_state = EMITING;
-        break;
-      case EMITING:
-        m_state = DISABLED;
-        break;
-      default:
-        m_state = DEFAULT;
-        break;
-      }
-    }
-    ImGui::PopStyleVar();
-    ImGui::PopStyleVar();
-    ImGui::PopStyleColor();
-    ImGui::PopStyleColor();
-    ImGui::PopStyleColor();
-    ImGui::PopStyleColor();
-  }
-  */
-
-  // draw inputs
-  ImGui::BeginGroup();
-  for (std::shared_ptr<ProcessorInput> input : m_inputs) {
-    m_dirty |= input->draw();
-  }
-  ImGui::EndGroup();
-
-  // draw outputs
-  ImGui::SetCursorPosX(ImGui::GetCursorPosX() + size.x);
-  ImGui::BeginGroup();
-  for (std::shared_ptr<ProcessorOutput> output : m_outputs) {
-    m_dirty |= output->draw();
-  }
-  ImGui::EndGroup();
-  
-  ImGui::PopStyleVar();
-  ImGui::PopStyleVar();
-
-  ImGui::EndGroup();
-  ImGui::PopItemWidth();
-  ImGui::PopStyleVar();
-
-  height = ImGui::GetCursorPosY() - height + padding;
-
-  m_size.x = style.processor_width;
-  m_size.y = height / w_scale;
-
-  ImGui::PopID();
-
-  return m_edit;
-}
-
-
-
-
 chill::Multiplexer::Multiplexer() {
   setName("Multiplexer");
-  m_size = ImVec2(1, 1);
+  m_size = Vec2(1, 1);
   m_size *= style.processor_title_height;
 
   addInput("i", IOType::UNDEF);
   addOutput("o", IOType::UNDEF);
 }
 
-bool chill::Multiplexer::draw() {
-
-  ImGui::PushID(int(getUniqueID()));
-
-  ImGuiWindow* window = ImGui::GetCurrentWindow();
-  ImDrawList* draw_list = ImGui::GetWindowDrawList();
-  float w_scale = window->FontWindowScale;
-
-  ImVec2 size = m_size * w_scale;
-  
-  ImVec2 min_pos = ImGui::GetCursorScreenPos();
-  ImVec2 max_pos = min_pos + size;
-
-  //float border_width = style.processor_border_width * w_scale;
-  float rounding_corners = style.processor_rounding_corners * w_scale;
-
-
-  // shadow
-  if (m_selected || w_scale > 0.5F) {
-    draw_list->AddRectFilled(
-      min_pos + ImVec2(-5, -5) * w_scale,
-      max_pos + ImVec2(5, 5) * w_scale,
-      m_selected ? style.processor_shadow_selected_color : style.processor_shadow_color,
-      rounding_corners * 2.0F, style.processor_rounded_corners);
-  }
-
-  // border & background
-  ImVec2 border = ImVec2(style.processor_border_width, style.processor_border_width) * w_scale / 2.0F;
-  draw_list->AddRectFilled(
-    min_pos - border,
-    max_pos + border,
-    m_selected ? style.processor_selected_color : color(),
-    rounding_corners, style.processor_rounded_corners
-  );
-
-  // background
-  // draw_list->AddRectFilled(min_pos, max_pos, style.processor_bg_color, rounding_corners, style.processor_rounded_corners);
-
-  ImGui::PushStyleVar(ImGuiStyleVar_FrameBorderSize, 2);
-  ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 20);
-  float x = ImGui::GetCursorPosX();
-  float y = ImGui::GetCursorPosY() + size.y/2.0F - w_scale * style.socket_radius;
-  
-  // draw inputs
-  ImGui::SetCursorPosX(x);
-  ImGui::SetCursorPosY(y);
-  
-  ImGui::BeginGroup();
-  for (std::shared_ptr<ProcessorInput> input : inputs()) {
-    input->draw();
-    if (input->m_link) {
-      setColor(input->m_link->owner()->color());
-    }
-  }
-  ImGui::EndGroup();
-
-  ImGui::SetCursorPosY(y);
-  ImGui::SetCursorPosX(x + size.x);
-  // draw ouputs
-  ImGui::BeginGroup();
-  for (std::shared_ptr<ProcessorOutput> output : outputs()) {
-    output->draw();
-  }
-  ImGui::EndGroup();
-
-  ImGui::PopStyleVar();
-  ImGui::PopStyleVar();
-  ImGui::PopID();
-
-  return m_edit;
-}
-
-void chill::Multiplexer::iceSL(std::ofstream& _stream) {
+void chill::Multiplexer::iceSL(LuaWriter& _writer) {
   //write the current Id of the node
 
-  std::string lua = "--[[ " + name() + " ]]--\n";
-  lua += "setfenv(1, _G0)  --go back to global initialization\n";
-  lua += "__currentNodeId = ";
-  lua += std::to_string(reinterpret_cast<int64_t>(this));
-  lua += "\n";
+  _writer << "--[[ " << name() << " ]]--\n";
+  _writer << "setfenv(1, _G0)  --go back to global initialization\n";
+  _writer << "__currentNodeId = " << reinterpret_cast<int64_t>(this) << "\n";
+  GraphExporter::writeChanges(_writer, *this, std::string());
 
+  bool slots = GraphExporter::hasSlots();
   for (auto input : inputs()) {
+    _writer << (slots ? "__value[\"" : "__input[\"") << input->name() << "\"] = ";
     // tweak
     if (!input->m_link) {
-      lua += "__input[\"" + std::string(input->name()) + "\"] = nil\n";
+      _writer << "nil\n";
     }
     // input
+    else if (slots) {
+      _writer << "__slots[" << GraphExporter::slot(*input->m_link) << "]\n";
+    }
     else {
-      std::string s2 = std::to_string(reinterpret_cast<int64_t>(input->m_link->owner()));
-      lua += "__input[\"" + std::string(input->name()) + "\"] = " + input->m_link->name() + s2 + "\n";
+      _writer << input->m_link->name() << reinterpret_cast<int64_t>(input->m_link->owner()) << "\n";
     }
   }
 
-  //TODO: CLEAN THIS !!!!
-  lua += std::string("\
-_Gcurrent = {} -- clear _Gcurrent\n\
-setmetatable(_Gcurrent, { __index = _G0 }) --copy index from _G0\n\
-setfenv(1, _Gcurrent)    --set it\n\
-");
+  GraphExporter::writeEnvironment(_writer);
 
-  lua += "if (isDirty({__currentNodeId";
+  _writer << "if (isDirty({__currentNodeId";
 
   for (auto input : inputs()) {
     if (input->m_link) {
-      std::string s2 = std::to_string(reinterpret_cast<int64_t>(input->m_link->owner()));
-      lua += ", " + s2;
+      _writer << ", " << reinterpret_cast<int64_t>(input->m_link->owner());
     }
   }
 
-  lua += "})) then\n\
+  _writer << "})) then\n\
 setDirty(__currentNodeId)\n";
-  lua += "output('o','UNDEF', input('i', 'UNDEF'))";
-  lua += "\nend";
-
-  _stream << lua << std::endl;
+  if (slots) {
+    _writer << "__outslot[\"o\"] = " << GraphExporter::slot(*output("o")) << "\n";
+  }
+  _writer << "output('o','UNDEF', input('i', 'UNDEF'))";
+  _writer << "\nend\n";
 }
@@ -7,6 +7,7 @@
 
 #include "IOs.h"
 #include "IOTypes.h"
+#include "LuaWriter.h"
 #include "UI.h"
 
 //-------------------------------------------------------
@@ -200,11 +201,6 @@ namespace chill {
      **/
     static bool areConnected(Processor * _from, Processor * _to);
 
-    /**
-     *  Draw the processor
-     **/
-    virtual bool draw();
-
     /**
      *  Make a copy of the processor (deep copy).
      **/
@@ -213,16 +209,16 @@ namespace chill {
     }
 
     /**
-     *  Generate the lua code to recreate this processor and add it to the stream.
-     *  @param _stream The output stream.
+     *  Generate the lua code to recreate this processor and add it to the writer.
+     *  @param _writer The output buffer.
      **/
-    virtual void save(std::ofstream& _stream);
+    virtual void save(LuaWriter& _writer);
 
     /**
-     *  Generate the IceSL lua code and add it to the stream.
-     *  @param _stream The output stream.
+     *  Generate the IceSL lua code and add it to the writer.
+     *  @param _writer The output buffer.
      **/
-    virtual void iceSL(std::ofstream& _stream);
+    virtual void iceSL(LuaWriter& _writer);
 
     void setEmiter(bool _emit = true) {
       m_emit = _emit;
@@ -276,8 +272,6 @@ namespace chill {
       return std::shared_ptr<SelectableUI>(new GroupProcessor(*this));
     }
 
-    bool draw() override;
-
     void setInputMode(bool mode_) {
       m_is_input = mode_;
     }
@@ -286,7 +280,15 @@ namespace chill {
       m_is_output = mode_;
     }
 
-    void iceSL(std::ofstream& _stream) override;
+    bool isInputMode() {
+      return m_is_input;
+    }
+
+    bool isOutputMode() {
+      return m_is_output;
+    }
+
+    void iceSL(LuaWriter& _writer) override;
 
   protected:
     bool m_is_input  = false;
@@ -304,8 +306,6 @@ namespace chill {
       return std::shared_ptr<SelectableUI>(new Multiplexer(*this));
     }
 
-    bool draw() override;
-
-    void iceSL(std::ofstream& _stream) override;
+    void iceSL(LuaWriter& _writer) override;
   };
 }
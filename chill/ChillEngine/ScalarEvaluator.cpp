@@ -0,0 +1,240 @@
+#include "ScalarEvaluator.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+
+#include <LibSL/LibSL.h>
+
+#include "IOs.h"
+#include "LuaProcessor.h"
+#include "NodeLibrary.h"
+#include "ProcessingGraph.h"
+
+namespace chill {
+
+  namespace {
+    const size_t c_preview_length = 24;
+
+    /** A value as shown on a socket: short numbers, short strings */
+    std::string preview(const std::string& _value) {
+      if (!_value.empty() && _value[0] == '"') {
+        return _value.size() > c_preview_length ? _value.substr(0, c_preview_length - 3) + "...\"" : _value;
+      }
+      std::string text;
+      for (size_t i = 0; i < _value.size(); ) {
+        char c = _value[i];
+        bool number = isdigit(c) || ((c == '-' || c == '.') && i + 1 < _value.size() && (isdigit(_value[i + 1]) || _value[i + 1] == '.'));
+        if (!number) {
+          text += c;
+          ++i;
+          continue;
+        }
+        char* end = nullptr;
+        double parsed = std::strtod(_value.c_str() + i, &end);
+        char short_number[32];
+        std::snprintf(short_number, sizeof(short_number), "%.4g", parsed);
+        text += short_number;
+        i = static_cast<size_t>(end - _value.c_str());
+      }
+      return text;
+    }
+
+    const std::string* find(const NodeSandbox::Values& _values, const std::string& _name) {
+      for (const auto& value : _values) {
+        if (value.first == _name) {
+          return &value.second;
+        }
+      }
+      return nullptr;
+    }
+  }
+
+  //-------------------------------------------------------
+
+  bool ScalarEvaluator::isScalar(IOType::IOType _type) {
+    switch (_type) {
+    case IOType::BOOLEAN:
+    case IOType::INTEGER:
+    case IOType::LIST:
+    case IOType::PATH:
+    case IOType::REAL:
+    case IOType::STRING:
+    case IOType::VEC3:
+    case IOType::VEC4:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  //-------------------------------------------------------
+
+  bool ScalarEvaluator::isScalar(Processor& _processor) {
+    if (!dynamic_cast<LuaProcessor*>(&_processor) || _processor.outputs().empty()) {
+      return false;
+    }
+    for (std::shared_ptr<ProcessorOutput> output : _processor.outputs()) {
+      if (!isScalar(output->type())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  //-------------------------------------------------------
+
+  bool ScalarEvaluator::affectsShapes(const std::vector<Processor*>& _changed) {
+    if (_changed.empty()) {
+      return true;
+    }
+    std::vector<Processor*>      stack = _changed;
+    std::unordered_set<Processor*> seen;
+    while (!stack.empty()) {
+      Processor* processor = stack.back();
+      stack.pop_back();
+      if (!processor || !seen.insert(processor).second) {
+        continue;
+      }
+      if (!isScalar(*processor)) {
+        return true;
+      }
+      for (std::shared_ptr<ProcessorOutput> output : processor->outputs()) {
+        for (std::shared_ptr<ProcessorInput> input : output->m_links) {
+          if (input) {
+            stack.push_back(input->owner());
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  //-------------------------------------------------------
+
+  size_t ScalarEvaluator::update(ProcessingGraph& _graph) {
+    m_current.clear();
+    m_runs = 0;
+    visit(_graph);
+
+    std::unordered_set<int64_t> alive;
+    for (const auto& current : m_current) {
+      if (current.second) {
+        alive.insert(current.first->getUniqueID());
+      }
+    }
+    for (auto entry = m_entries.begin(); entry != m_entries.end(); ) {
+      entry = alive.count(entry->first) ? std::next(entry) : m_entries.erase(entry);
+    }
+    m_current.clear();
+    return m_runs;
+  }
+
+  //-------------------------------------------------------
+
+  const std::string* ScalarEvaluator::value(ProcessorOutput& _output) const {
+    if (!_output.owner()) {
+      return nullptr;
+    }
+    auto entry = m_entries.find(_output.owner()->getUniqueID());
+    return entry == m_entries.end() ? nullptr : find(entry->second.outputs, _output.name());
+  }
+
+  //-------------------------------------------------------
+
+  const NodeSandbox::Values* ScalarEvaluator::constants(Processor& _processor) const {
+    auto entry = m_entries.find(_processor.getUniqueID());
+    if (entry == m_entries.end() || !entry->second.pure || !entry->second.error.empty() || _processor.isEmiter()) {
+      return nullptr;
+    }
+    for (std::shared_ptr<ProcessorOutput> output : _processor.outputs()) {
+      if (!find(entry->second.outputs, output->name())) {
+        return nullptr;
+      }
+    }
+    return &entry->second.outputs;
+  }
+
+  //-------------------------------------------------------
+
+  void ScalarEvaluator::visit(ProcessingGraph& _graph) {
+    std::unordered_set<Processor*> visiting;
+    for (std::shared_ptr<Processor> processor : *_graph.processors()) {
+      ProcessingGraph* inner = dynamic_cast<ProcessingGraph*>(processor.get());
+      if (inner) {
+        visit(*inner);
+      }
+      const Entry* entry = evaluate(*processor, visiting);
+      for (std::shared_ptr<ProcessorOutput> output : processor->outputs()) {
+        const std::string* value = entry ? find(entry->outputs, output->name()) : nullptr;
+        output->m_value = value ? preview(*value) : (entry && !entry->error.empty() ? "error" : "");
+      }
+    }
+  }
+
+  //-------------------------------------------------------
+
+  const ScalarEvaluator::Entry* ScalarEvaluator::evaluate(Processor& _processor, std::unordered_set<Processor*>& _visiting) {
+    auto done = m_current.find(&_processor);
+    if (done != m_current.end()) {
+      return done->second;
+    }
+    // a cycle, or not a scalar node
+    if (_visiting.count(&_processor) || !isScalar(_processor)) {
+      return nullptr;
+    }
+    LuaProcessor& node = static_cast<LuaProcessor&>(_processor);
+
+    _visiting.insert(&_processor);
+    NodeSandbox::Values inputs;
+    std::string key = node.nodepath();
+    bool known = true;
+    for (std::shared_ptr<ProcessorInput> input : node.inputs()) {
+      std::string value;
+      if (input->m_link) {
+        const Entry*       upstream = evaluate(*input->m_link->owner(), _visiting);
+        const std::string* found    = upstream ? find(upstream->outputs, input->m_link->name()) : nullptr;
+        if (!found) {
+          known = false;
+          break;
+        }
+        value = *found;
+      } else if (isScalar(input->type())) {
+        value = input->getLuaValue();
+      } else {
+        known = false;
+        break;
+      }
+      key += '\n';
+      key += input->name();
+      key += '=';
+      key += value;
+      inputs.emplace_back(input->name(), value);
+    }
+    _visiting.erase(&_processor);
+    if (!known) {
+      m_current[&_processor] = nullptr;
+      return nullptr;
+    }
+
+    std::shared_ptr<const std::string> source = NodeLibrary::Instance().source(node.nodepath());
+    key += '\n';
+    key += std::to_string(std::hash<std::string>()(*source));
+
+    Entry& entry = m_entries[node.getUniqueID()];
+    if (entry.key != key) {
+      entry.key = key;
+      m_runs++;
+      if (NodeSandbox::evaluate(*source, node.nodepath(), inputs, entry.outputs, entry.pure, entry.error)) {
+        entry.error.clear();
+      } else {
+        entry.outputs.clear();
+        std::cerr << Console::yellow << node.name() << ": " << entry.error << Console::gray << std::endl;
+      }
+    }
+    m_current[&_processor] = &entry;
+    return &entry;
+  }
+}
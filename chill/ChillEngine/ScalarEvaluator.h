@@ -0,0 +1,88 @@
+/** @file */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "IOTypes.h"
+#include "NodeSandbox.h"
+
+namespace chill {
+  class Processor;
+  class ProcessingGraph;
+  class ProcessorOutput;
+
+  /**
+   *  ScalarEvaluator class.
+   *  Computes in Chill the outputs of the nodes that only deal with booleans,
+   *  numbers, vectors and strings, see NodeSandbox::evaluate. A node is run on
+   *  the values of its tweaks and of the outputs it is linked to, its outputs
+   *  are kept until its file or one of these values changes.
+   *  The values are written to ProcessorOutput::m_value, for the sockets.
+   **/
+  class ScalarEvaluator
+  {
+  public:
+    /** Whether the outputs of this type can be computed in Chill */
+    static bool isScalar(IOType::IOType _type);
+
+    /** Whether a processor is a node whose outputs are all scalars */
+    static bool isScalar(Processor& _processor);
+
+    /**
+     *  Whether a change of these processors may change what IceSL draws: true when
+     *  one of them, or a processor they feed, is not a scalar node.
+     *  @param _changed The processors that changed.
+     **/
+    static bool affectsShapes(const std::vector<Processor*>& _changed);
+
+    /**
+     *  Compute the scalar outputs of a graph, and of the graphs it contains.
+     *  @param _graph The graph.
+     *  @return The number of nodes run, the others were kept or are not scalar.
+     **/
+    size_t update(ProcessingGraph& _graph);
+
+    /**
+     *  Get the value of an output, computed by the last update.
+     *  @param _output The output.
+     *  @return The value as a Lua expression, nullptr if it is not known.
+     **/
+    const std::string* value(ProcessorOutput& _output) const;
+
+    /**
+     *  Get the outputs of a node that can be replaced by its values in the IceSL
+     *  script: all its outputs are known and computing them used nothing of IceSL.
+     *  @param _processor The node, evaluated by the last update.
+     *  @return Its outputs as Lua expressions, nullptr if it has to run in IceSL.
+     **/
+    const NodeSandbox::Values* constants(Processor& _processor) const;
+
+    /** Forget the values, the nodes run again at the next update */
+    void clear() {
+      m_entries.clear();
+    }
+
+  private:
+    struct Entry {
+      // the node file and the input values the outputs were computed from
+      std::string         key;
+      NodeSandbox::Values outputs;
+      bool                pure = false;
+      std::string         error;
+    };
+
+    const Entry* evaluate(Processor& _processor, std::unordered_set<Processor*>& _visiting);
+
+    void visit(ProcessingGraph& _graph);
+
+    // by unique ID, the entries of the processors gone are dropped at each update
+    std::unordered_map<int64_t, Entry> m_entries;
+    // the entries computed or checked by the current update
+    std::unordered_map<Processor*, const Entry*> m_current;
+    size_t m_runs = 0;
+  };
+}
@@ -0,0 +1,179 @@
+#include "SessionRecorder.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <limits>
+
+#include <LibSL/LibSL.h>
+
+namespace chill {
+
+  namespace {
+    const char* c_magic   = "chill-session";
+    const int   c_version = 1;
+
+    enum Modifier { CTRL = 1, SHIFT = 2, ALT = 4, SUPER = 8 };
+  }
+
+  //-------------------------------------------------------
+
+  bool SessionRecorder::start(const std::string& _filename, const Session& _start) {
+    stop();
+    m_file.open(_filename, std::ios::binary);
+    if (!m_file) {
+      std::cerr << Console::red << "Unable to record the session in " << _filename << Console::gray << std::endl;
+      return false;
+    }
+    m_file.precision(std::numeric_limits<float>::max_digits10);
+    m_file << c_magic << " " << c_version << "\n";
+    m_file << "view " << _start.offset.x << " " << _start.offset.y << " " << _start.zoom << "\n";
+    m_file << "settings " << _start.auto_save << " " << _start.auto_export << "\n";
+    m_file << "graph " << _start.graph.size() << "\n";
+    m_file.write(_start.graph.data(), static_cast<std::streamsize>(_start.graph.size()));
+    m_file << "\n";
+    m_chars.clear();
+    return true;
+  }
+
+  //-------------------------------------------------------
+
+  void SessionRecorder::stop() {
+    if (m_file.is_open()) {
+      m_file.close();
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void SessionRecorder::character(unsigned int _char) {
+    if (recording()) {
+      m_chars.push_back(_char);
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void SessionRecorder::frame(const ImGuiIO& _io) {
+    if (!recording()) {
+      return;
+    }
+
+    int buttons = 0;
+    for (int b = 0; b < IM_ARRAYSIZE(_io.MouseDown); ++b) {
+      if (_io.MouseDown[b]) buttons |= 1 << b;
+    }
+    int modifiers = (_io.KeyCtrl ? CTRL : 0) | (_io.KeyShift ? SHIFT : 0) | (_io.KeyAlt ? ALT : 0) | (_io.KeySuper ? SUPER : 0);
+
+    std::vector<int> keys;
+    for (int k = 0; k < IM_ARRAYSIZE(_io.KeysDown); ++k) {
+      if (_io.KeysDown[k]) keys.push_back(k);
+    }
+
+    m_file << "frame " << _io.DeltaTime
+           << " " << _io.DisplaySize.x << " " << _io.DisplaySize.y
+           << " " << _io.MousePos.x << " " << _io.MousePos.y
+           << " " << buttons << " " << _io.MouseWheel << " " << modifiers
+           << " " << keys.size();
+    for (int k : keys) {
+      m_file << " " << k;
+    }
+    m_file << " " << m_chars.size();
+    for (unsigned int c : m_chars) {
+      m_file << " " << c;
+    }
+    m_file << "\n";
+    m_chars.clear();
+  }
+
+  //-------------------------------------------------------
+
+  bool SessionRecorder::load(const std::string& _filename, Session& _session) {
+    std::ifstream file(_filename, std::ios::binary);
+    if (!file) {
+      std::cerr << Console::red << "Unable to open the session " << _filename << Console::gray << std::endl;
+      return false;
+    }
+
+    std::string magic, tag;
+    int version = 0;
+    file >> magic >> version;
+    if (magic != c_magic || version != c_version) {
+      std::cerr << Console::red << _filename << " is not a Chill session" << Console::gray << std::endl;
+      return false;
+    }
+
+    file >> tag >> _session.offset.x >> _session.offset.y >> _session.zoom;
+    if (tag != "view") {
+      return false;
+    }
+
+    file >> tag >> _session.auto_save >> _session.auto_export;
+    if (tag != "settings") {
+      return false;
+    }
+
+    size_t size = 0;
+    file >> tag >> size;
+    if (tag != "graph") {
+      return false;
+    }
+    file.get(); // end of line
+    _session.graph.resize(size);
+    // empty when the recording started on an empty editor
+    if (size > 0 && !file.read(_session.graph.data(), static_cast<std::streamsize>(size))) {
+      std::cerr << Console::red << "Truncated graph in the session " << _filename << Console::gray << std::endl;
+      return false;
+    }
+
+    _session.frames.clear();
+    while (file >> tag) {
+      if (tag != "frame") {
+        std::cerr << Console::red << "Unexpected '" << tag << "' in the session " << _filename << Console::gray << std::endl;
+        return false;
+      }
+      Frame frame;
+      size_t count = 0;
+      file >> frame.delta_time
+           >> frame.display_size.x >> frame.display_size.y
+           >> frame.mouse_pos.x >> frame.mouse_pos.y
+           >> frame.buttons >> frame.wheel >> frame.modifiers
+           >> count;
+      frame.keys.resize(count);
+      for (int& k : frame.keys) file >> k;
+      file >> count;
+      frame.chars.resize(count);
+      for (unsigned int& c : frame.chars) file >> c;
+      if (!file) {
+        break; // truncated last frame, the editor was killed while recording
+      }
+      _session.frames.push_back(frame);
+    }
+    return true;
+  }
+
+  //-------------------------------------------------------
+
+  void SessionRecorder::apply(const Frame& _frame, ImGuiIO& _io) {
+    _io.DisplaySize = _frame.display_size;
+    _io.MousePos    = _frame.mouse_pos;
+    for (int b = 0; b < IM_ARRAYSIZE(_io.MouseDown); ++b) {
+      _io.MouseDown[b] = (_frame.buttons & (1 << b)) != 0;
+    }
+    _io.MouseWheel = _frame.wheel;
+    _io.KeyCtrl    = (_frame.modifiers & CTRL)  != 0;
+    _io.KeyShift   = (_frame.modifiers & SHIFT) != 0;
+    _io.KeyAlt     = (_frame.modifiers & ALT)   != 0;
+    _io.KeySuper   = (_frame.modifiers & SUPER) != 0;
+
+    std::fill(std::begin(_io.KeysDown), std::end(_io.KeysDown), false);
+    for (int k : _frame.keys) {
+      if (k >= 0 && k < IM_ARRAYSIZE(_io.KeysDown)) {
+        _io.KeysDown[k] = true;
+      }
+    }
+    for (unsigned int c : _frame.chars) {
+      _io.AddInputCharacter(c);
+    }
+  }
+}
@@ -0,0 +1,100 @@
+/** @file */
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "imgui/imgui.h"
+
+namespace chill {
+
+  /**
+   *  SessionRecorder class.
+   *  Records the ImGui inputs of each frame, along with the graph and the view
+   *  at the start, so that a session can be replayed identically.
+   *
+   *  The session file is text:
+   *    chill-session 1
+   *    view <offset x> <offset y> <zoom>
+   *    settings <auto save> <auto export>
+   *    graph <byte count>
+   *    <the .graph content>
+   *    frame <dt> <width> <height> <mouse x> <mouse y> <buttons> <wheel> <modifiers> <key count> <keys...> <char count> <chars...>
+   **/
+  class SessionRecorder
+  {
+  public:
+    /** Inputs of one frame */
+    struct Frame {
+      float                     delta_time = 0.0F;
+      ImVec2                    display_size;
+      ImVec2                    mouse_pos;
+      /** bit i is set when the mouse button i is down */
+      int                       buttons    = 0;
+      float                     wheel      = 0.0F;
+      /** ctrl 1, shift 2, alt 4, super 8 */
+      int                       modifiers  = 0;
+      std::vector<int>          keys;
+      std::vector<unsigned int> chars;
+    };
+
+    /** A whole session */
+    struct Session {
+      ImVec2             offset;
+      float              zoom        = 1.0F;
+      bool               auto_save   = true;
+      bool               auto_export = true;
+      std::string        graph;
+      std::vector<Frame> frames;
+    };
+
+    /**
+     *  Start recording in a file.
+     *  @param _filename The session file.
+     *  @param _start The graph, view and settings at the start, the frames are ignored.
+     *  @return true if the file could be opened.
+     **/
+    bool start(const std::string& _filename, const Session& _start);
+
+    /**
+     *  Stop recording, the file is closed.
+     **/
+    void stop();
+
+    bool recording() const {
+      return m_file.is_open();
+    }
+
+    /**
+     *  Record a typed character, written with the next frame.
+     *  @param _char The character.
+     **/
+    void character(unsigned int _char);
+
+    /**
+     *  Record the inputs of the current frame.
+     *  @param _io The ImGui inputs.
+     **/
+    void frame(const ImGuiIO& _io);
+
+    /**
+     *  Read a session file.
+     *  @param _filename The session file.
+     *  @param _session Filled with the session.
+     *  @return true if the session could be read.
+     **/
+    static bool load(const std::string& _filename, Session& _session);
+
+    /**
+     *  Set the ImGui inputs from a recorded frame.
+     *  @param _frame The recorded frame.
+     *  @param _io The ImGui inputs to overwrite.
+     **/
+    static void apply(const Frame& _frame, ImGuiIO& _io);
+
+  private:
+    std::ofstream             m_file;
+    std::vector<unsigned int> m_chars;
+  };
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+#define SRC_PATH "/root/repo"
@@ -1,44 +1,44 @@
 #pragma once
 
-#include "imgui/imgui.h"
+#include "CoreTypes.h"
 
 
 struct Style
 {
-  #define ui_cyan     ImColor( 73, 193, 194) // ImColor(125, 188, 193)
-  #define ui_red      ImColor(147,  55,  51)
-  #define ui_grey     ImColor(128, 128, 128)
-  #define ui_darkgrey ImColor( 38,  38,  38)
-  #define ui_orange   ImColor(255, 136,  51)
-  #define ui_green    ImColor(104, 194,  73)
-  #define ui_yellow   ImColor(255, 255, 100)
-  #define ui_white    ImColor(255, 255, 255)
-  #define ui_black    ImColor(  0,   0,   0)
+  #define ui_cyan     chill::Color( 73, 193, 194) // chill::Color(125, 188, 193)
+  #define ui_red      chill::Color(147,  55,  51)
+  #define ui_grey     chill::Color(128, 128, 128)
+  #define ui_darkgrey chill::Color( 38,  38,  38)
+  #define ui_orange   chill::Color(255, 136,  51)
+  #define ui_green    chill::Color(104, 194,  73)
+  #define ui_yellow   chill::Color(255, 255, 100)
+  #define ui_white    chill::Color(255, 255, 255)
+  #define ui_black    chill::Color(  0,   0,   0)
 
   // Window
-  ImU32 menubar_color;
+  chill::Color menubar_color;
   /** Height of the menu bar, needs to be updated before calling "ImGui::EndMainMenuBar();" */
   float menubar_height;
 
   // Graph
-  ImU32 graph_bg_color;
-  ImU32 graph_grid_color;
+  chill::Color graph_bg_color;
+  chill::Color graph_grid_color;
 
   float graph_grid_line_width;
   int   graph_grid_size;
 
   // Processor
-  ImU32 processor_bg_color;
-  ImU32 processor_default_color;
-  ImU32 processor_graph_color;
-  ImU32 processor_group_color;
-  ImU32 processor_selected_color;
-  ImU32 processor_error_color;
-  ImU32 processor_shadow_color;
-  ImU32 processor_shadow_selected_color;
-
-  ImU32 processor_title_bg_color;
-  ImU32 processor_title_color;
+  chill::Color processor_bg_color;
+  chill::Color processor_default_color;
+  chill::Color processor_graph_color;
+  chill::Color processor_group_color;
+  chill::Color processor_selected_color;
+  chill::Color processor_error_color;
+  chill::Color processor_shadow_color;
+  chill::Color processor_shadow_selected_color;
+
+  chill::Color processor_title_bg_color;
+  chill::Color processor_title_color;
 
   float processor_width;
   float processor_title_height;
@@ -52,12 +52,12 @@ struct Style
   float socket_border_width;
   float min_io_height;
 
-  ImVec2 ItemSpacing;
+  chill::Vec2 ItemSpacing;
 
   // Pipe
-  ImU32 pipe_color;
-  ImU32 pipe_selected_color;
-  ImU32 pipe_error_color;
+  chill::Color pipe_color;
+  chill::Color pipe_selected_color;
+  chill::Color pipe_error_color;
   
   float pipe_line_width;
 
@@ -69,7 +69,7 @@ struct Style
 
     // Graph
     graph_bg_color        = ui_darkgrey;
-    graph_grid_color      = ui_white & 0x25FFFFFF;
+    graph_grid_color      = ui_white.withAlpha(0x25);
     graph_grid_line_width = 1.0f;
     graph_grid_size       = 10;
 
@@ -81,8 +81,8 @@ struct Style
     processor_selected_color        = ui_orange;
     processor_error_color           = ui_red;
     processor_title_color           = ui_darkgrey;
-    processor_shadow_color          = ui_black & 0x88FFFFFF;
-    processor_shadow_selected_color = ui_orange & 0x88FFFFFF;
+    processor_shadow_color          = ui_black.withAlpha(0x88);
+    processor_shadow_selected_color = ui_orange.withAlpha(0x88);
     processor_width                 = 220.0f;
     processor_title_height          = 25.0f;
     processor_border_width          = 2.0f;
@@ -94,26 +94,14 @@ struct Style
     socket_border_width = 0.0f;
     min_io_height       = 50.0f;
 
-    ItemSpacing = ImVec2(5.0f, 5.0f);
+    ItemSpacing = chill::Vec2(5.0f, 5.0f);
 
     // Pipe
     pipe_color          = ui_cyan;
     pipe_selected_color = ui_orange;
-    pipe_error_color    = ImColor(255, 55, 51);
+    pipe_error_color    = chill::Color(255, 55, 51);
 
     pipe_line_width = 6.0F;
   }
 
-
-
-  ImVec2 delta_to_center_text(ImVec2 element_size, const char *text) {
-    ImVec2 text_size = ImGui::CalcTextSize(text);
-    return (element_size - text_size) / 2.0f;
-  }
-
-  ImVec2 delta_to_right_text(ImVec2 element_size, const char *text) {
-    ImVec2 text_size = ImGui::CalcTextSize(text);
-    return element_size - text_size;
-  }
-
 };
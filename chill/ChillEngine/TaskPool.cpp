@@ -0,0 +1,143 @@
+#include "TaskPool.h"
+
+#include <algorithm>
+
+namespace chill {
+
+  //-------------------------------------------------------
+
+  TaskPool::TaskPool(size_t _workers) {
+    if (_workers == 0) {
+      _workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    for (size_t w = 0; w < _workers; ++w) {
+      m_ranges.emplace_back(new Range());
+    }
+    for (size_t w = 1; w < _workers; ++w) {
+      m_threads.emplace_back(&TaskPool::loop, this, w);
+    }
+  }
+
+  //-------------------------------------------------------
+
+  TaskPool::~TaskPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads) {
+      thread.join();
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void TaskPool::run(size_t _count, const Body& _body) {
+    if (_count == 0) {
+      return;
+    }
+    size_t workers = m_ranges.size();
+    for (size_t w = 0; w < workers; ++w) {
+      std::lock_guard<std::mutex> lock(m_ranges[w]->mutex);
+      m_ranges[w]->begin = _count * w / workers;
+      m_ranges[w]->end   = _count * (w + 1) / workers;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_body = &_body;
+      m_busy = m_threads.size();
+      m_generation++;
+    }
+    m_wake.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_busy == 0; });
+    m_body = nullptr;
+  }
+
+  //-------------------------------------------------------
+
+  void TaskPool::loop(size_t _worker) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+      m_wake.wait(lock, [&]() { return m_stop || m_generation != seen; });
+      if (m_stop) {
+        return;
+      }
+      seen = m_generation;
+      lock.unlock();
+      work(_worker);
+      lock.lock();
+      if (--m_busy == 0) {
+        m_done.notify_all();
+      }
+    }
+  }
+
+  //-------------------------------------------------------
+
+  void TaskPool::work(size_t _worker) {
+    size_t index = 0;
+    while (next(_worker, index)) {
+      (*m_body)(index, _worker);
+    }
+  }
+
+  //-------------------------------------------------------
+
+  bool TaskPool::next(size_t _worker, size_t& _index) {
+    Range& own = *m_ranges[_worker];
+    {
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (own.begin < own.end) {
+        _index = own.begin++;
+        return true;
+      }
+    }
+
+    while (true) {
+      // the largest range left, its size is only a hint until it is locked
+      size_t victim  = _worker;
+      size_t largest = 0;
+      for (size_t w = 0; w < m_ranges.size(); ++w) {
+        if (w == _worker) {
+          continue;
+        }
+        std::lock_guard<std::mutex> lock(m_ranges[w]->mutex);
+        size_t left = m_ranges[w]->end - m_ranges[w]->begin;
+        if (left > largest) {
+          largest = left;
+          victim  = w;
+        }
+      }
+      if (largest == 0) {
+        return false;
+      }
+
+      size_t begin = 0;
+      size_t end   = 0;
+      {
+        Range& range = *m_ranges[victim];
+        std::lock_guard<std::mutex> lock(range.mutex);
+        size_t left = range.end - range.begin;
+        if (left == 0) {
+          continue;
+        }
+        end         = range.end;
+        begin       = range.end - (left + 1) / 2;
+        range.end   = begin;
+      }
+      m_steals++;
+
+      std::lock_guard<std::mutex> lock(own.mutex);
+      own.begin = begin + 1;
+      own.end   = end;
+      _index    = begin;
+      return true;
+    }
+  }
+}
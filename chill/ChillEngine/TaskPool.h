@@ -0,0 +1,89 @@
+/** @file */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chill {
+
+  /**
+   *  TaskPool class.
+   *  Threads kept alive between runs, for the tools that export many graphs.
+   *  A run splits its indices in one contiguous range per worker; a worker that
+   *  empties its range steals the upper half of the largest one left, so that
+   *  uneven tasks stay balanced with little contention.
+   *  The calling thread is worker 0, runs are not reentrant and the tasks must
+   *  not throw.
+   **/
+  class TaskPool
+  {
+  public:
+    /** Called as body(index, worker) */
+    typedef std::function<void(size_t, size_t)> Body;
+
+    /**
+     *  Start the threads.
+     *  @param _workers The number of workers, the calling thread included, 0 for one per core.
+     **/
+    explicit TaskPool(size_t _workers = 0);
+
+    /**
+     *  Stop the threads.
+     **/
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    size_t workers() const {
+      return m_ranges.size();
+    }
+
+    /**
+     *  Call a function for each index in [0, _count) and wait for all the calls.
+     *  @param _count The number of indices.
+     *  @param _body The function, called as _body(index, worker) with worker in [0, workers()).
+     **/
+    void run(size_t _count, const Body& _body);
+
+    /** Ranges stolen since the pool started */
+    size_t steals() const {
+      return m_steals;
+    }
+
+  private:
+    struct Range {
+      std::mutex mutex;
+      size_t     begin = 0;
+      size_t     end   = 0;
+    };
+
+    /** Wait for the runs, worker thread */
+    void loop(size_t _worker);
+
+    /** Run the tasks of a worker, then steal until none is left */
+    void work(size_t _worker);
+
+    /** Take the next index of a worker, stealing if its range is empty */
+    bool next(size_t _worker, size_t& _index);
+
+    std::vector<std::unique_ptr<Range>> m_ranges;
+    std::vector<std::thread>            m_threads;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const Body*             m_body       = nullptr;
+    uint64_t                m_generation = 0;
+    size_t                  m_busy       = 0;
+    bool                    m_stop       = false;
+
+    std::atomic<size_t> m_steals{ 0 };
+  };
+}
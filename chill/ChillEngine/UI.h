@@ -1,12 +1,8 @@
 #pragma once
 
 #include <LibSL/LibSL.h>
-#include <LibSL/LibSL_gl.h>
-
-#include "imgui/imgui.h"
-#define IMGUI_DEFINE_MATH_OPERATORS true
-#include "imgui/imgui_internal.h"
 
+#include "CoreTypes.h"
 #include "Style.h"
 
 class SelectableUI;
@@ -23,27 +19,21 @@ public:
   bool m_visible = true;
 
   /** Component's size */
-  ImVec2 m_size     = ImVec2(0.0f, 0.0f);
+  chill::Vec2 m_size     = chill::Vec2(0.0f, 0.0f);
 
   /** Component's position */
-  ImVec2 m_position = ImVec2(0.0f, 0.0f);
+  chill::Vec2 m_position = chill::Vec2(0.0f, 0.0f);
 
 public:
   Style style;
 
   virtual ~UI() {}
 
-  /**
-   * Draw the component
-   * return true if the element is rendered, else false
-   */
-  virtual bool draw() = 0;
-
   /**
    *  Resize a component (scale independant)
    *  @param _size The new component size
    */
-  void resize(ImVec2 _size) {
+  void resize(chill::Vec2 _size) {
     m_size = _size;
   }
 
@@ -51,7 +41,7 @@ public:
    *  Move a component
    *  @param _position The new position
    */
-  void setPosition(ImVec2 _position) {
+  void setPosition(chill::Vec2 _position) {
     m_position = _position;
   }
 
@@ -59,15 +49,15 @@ public:
   *  Translate a component
   *  @param _delta The delta
   */
-  void translate(ImVec2 _delta) {
+  void translate(chill::Vec2 _delta) {
     m_position += _delta;
   }
 
-  inline const ImVec2& getPosition() {
+  inline const chill::Vec2& getPosition() {
     return m_position;
   }
 
-  inline const ImVec2& getSize() {
+  inline const chill::Vec2& getSize() {
     return m_size;
   }
 
@@ -86,7 +76,7 @@ public:
   std::string m_name;
 
   /** Display color. */
-  ImU32 m_color;
+  chill::Color m_color;
 
   /** Parent graph, raw pointer is needed. */
   chill::ProcessingGraph * m_owner = nullptr;
@@ -126,7 +116,7 @@ public:
    *  Get the color of this ui element.
    *  @return The color of the ui element.
    **/
-  inline ImU32 color() {
+  inline chill::Color color() {
     return m_color;
   }
 
@@ -134,12 +124,10 @@ public:
    *  Set the color of ui element.
    *  @param _color The color of the ui element.
    **/
-  void setColor(const ImU32& _color) {
+  void setColor(const chill::Color& _color) {
     m_color = _color;
   }
 
-  bool draw() { return true; }
-
   virtual std::shared_ptr<SelectableUI> clone() = 0;
 
   /**
@@ -0,0 +1,369 @@
+#include "Daemon.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifndef WIN32
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <LibSL/LibSL.h>
+
+#include "GraphExporter.h"
+#include "IOs.h"
+#include "NodeLibrary.h"
+#include "ProcessingGraph.h"
+
+using namespace chill;
+
+namespace {
+  typedef std::chrono::high_resolution_clock Clock;
+
+  double since(Clock::time_point _start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - _start).count();
+  }
+
+  std::string milliseconds(double _ms) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.3f", _ms);
+    return text;
+  }
+
+  /** Split "word rest of the line" */
+  std::string next(std::string& _line) {
+    size_t begin = _line.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+      _line.clear();
+      return std::string();
+    }
+    size_t end = _line.find_first_of(" \t", begin);
+    std::string word = _line.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+    size_t rest = end == std::string::npos ? std::string::npos : _line.find_first_not_of(" \t", end);
+    _line = rest == std::string::npos ? std::string() : _line.substr(rest);
+    return word;
+  }
+}
+
+//-------------------------------------------------------
+
+Daemon::Daemon(const fs::path& _socket, const ExportOptions& _options)
+  : m_socket(_socket), m_options(_options), m_stop(false), m_requests(0), m_failed(0), m_busy_us(0)
+{
+  // the node files are read once, see refresh
+  NodeLibrary::Instance().setKeepSources(true);
+}
+
+//-------------------------------------------------------
+
+std::string Daemon::handle(const std::string& _request) {
+  auto start = Clock::now();
+  std::string line = _request;
+  while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+    line.pop_back();
+  }
+  std::string command = next(line);
+  std::string reply;
+  bool ok = false;
+  if (command == "load") {
+    std::string name = next(line);
+    ok = load(name, line, reply);
+  } else if (command == "set") {
+    std::string name = next(line);
+    ok = set(name, line, reply);
+  } else if (command == "export") {
+    std::string name = next(line);
+    ok = exportTo(name, line, reply);
+  } else if (command == "stats") {
+    ok = stats(next(line), reply);
+  } else if (command == "close") {
+    std::string name = next(line);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ok = m_graphs.erase(name) > 0;
+    reply = ok ? "" : "no graph " + name;
+  } else if (command == "refresh") {
+    NodeLibrary::Instance().setKeepSources(false);
+    NodeLibrary::Instance().setKeepSources(true);
+    ok = true;
+  } else if (command == "shutdown") {
+    m_stop = true;
+#ifndef WIN32
+    // wakes up accept
+    ::shutdown(m_listen, SHUT_RDWR);
+#endif
+    ok = true;
+  } else {
+    reply = "unknown request " + command;
+  }
+
+  double ms = since(start);
+  m_requests++;
+  m_busy_us += static_cast<size_t>(ms * 1000.0);
+  if (!ok) {
+    m_failed++;
+  }
+  return (ok ? "ok " : "error ") + milliseconds(ms) + (reply.empty() ? "" : " " + reply);
+}
+
+//-------------------------------------------------------
+
+std::shared_ptr<Daemon::Graph> Daemon::find(const std::string& _name) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto found = m_graphs.find(_name);
+  return found == m_graphs.end() ? nullptr : found->second;
+}
+
+//-------------------------------------------------------
+
+bool Daemon::load(const std::string& _name, const std::string& _file, std::string& _reply) {
+  if (_name.empty() || _file.empty()) {
+    _reply = "expected load <name> <file.graph>";
+    return false;
+  }
+  std::shared_ptr<Graph> graph(new Graph());
+  auto start   = Clock::now();
+  graph->file  = _file;
+  graph->graph = loadGraph(graph->file, _reply);
+  graph->load_ms = since(start);
+  if (!graph->graph) {
+    return false;
+  }
+  graph->nodes = countNodes(*graph->graph);
+  {
+    // replaces a graph of the same name, the requests on it finish with the old one
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_graphs[_name] = graph;
+  }
+  _reply = "nodes=" + std::to_string(graph->nodes) + " load_ms=" + milliseconds(graph->load_ms);
+  return true;
+}
+
+//-------------------------------------------------------
+
+bool Daemon::set(const std::string& _name, const std::string& _assignment, std::string& _reply) {
+  std::shared_ptr<Graph> graph = find(_name);
+  if (!graph) {
+    _reply = "no graph " + _name;
+    return false;
+  }
+  size_t equal = _assignment.find('=');
+  if (equal == std::string::npos || equal == 0) {
+    _reply = "expected set <name> <tweak>=<value>";
+    return false;
+  }
+  std::string tweak = _assignment.substr(0, equal);
+  std::string value = _assignment.substr(equal + 1);
+
+  std::lock_guard<std::mutex> lock(graph->mutex);
+  std::vector<std::shared_ptr<ProcessorInput>> inputs = graph->graph->tweaks(tweak);
+  if (inputs.empty()) {
+    _reply = "no tweak " + tweak;
+    return false;
+  }
+  for (std::shared_ptr<ProcessorInput> input : inputs) {
+    if (!input->setValue(value)) {
+      _reply = "'" + value + "' is not a value of " + tweak;
+      return false;
+    }
+  }
+  graph->sets++;
+  _reply = "inputs=" + std::to_string(inputs.size());
+  return true;
+}
+
+//-------------------------------------------------------
+
+bool Daemon::exportTo(const std::string& _name, const std::string& _file, std::string& _reply) {
+  std::shared_ptr<Graph> graph = find(_name);
+  if (!graph) {
+    _reply = "no graph " + _name;
+    return false;
+  }
+  if (_file.empty()) {
+    _reply = "expected export <name> <file.lua>";
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(graph->mutex);
+  auto start = Clock::now();
+  ExportOptions options = m_options;
+  if (options.fold_constants) {
+    graph->evaluator.update(*graph->graph);
+    options.evaluator = &graph->evaluator;
+  }
+  options.output_slots = &graph->slots;
+  graph->writer.clear();
+  ExportStats exported = GraphExporter::write(*graph->graph, graph->writer, options);
+  if (!graph->writer.save(_file)) {
+    _reply = "cannot write " + _file;
+    return false;
+  }
+  double ms = since(start);
+  graph->exports++;
+  graph->bytes     += graph->writer.size();
+  graph->export_ms += ms;
+  _reply = "bytes=" + std::to_string(graph->writer.size())
+         + " folded=" + std::to_string(exported.folded)
+         + " deduplicated=" + std::to_string(exported.deduplicated)
+         + " export_ms=" + milliseconds(ms);
+  return true;
+}
+
+//-------------------------------------------------------
+
+bool Daemon::stats(const std::string& _name, std::string& _reply) {
+  if (_name.empty()) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    _reply = "graphs="    + std::to_string(m_graphs.size())
+           + " clients="  + std::to_string(m_clients.size())
+           + " requests=" + std::to_string(m_requests)
+           + " failed="   + std::to_string(m_failed)
+           + " busy_ms="  + milliseconds(static_cast<double>(m_busy_us) / 1000.0);
+    return true;
+  }
+  std::shared_ptr<Graph> graph = find(_name);
+  if (!graph) {
+    _reply = "no graph " + _name;
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(graph->mutex);
+  _reply = "file="       + graph->file.string()
+         + " nodes="     + std::to_string(graph->nodes)
+         + " load_ms="   + milliseconds(graph->load_ms)
+         + " sets="      + std::to_string(graph->sets)
+         + " exports="   + std::to_string(graph->exports)
+         + " bytes="     + std::to_string(graph->bytes)
+         + " export_ms=" + milliseconds(graph->export_ms);
+  return true;
+}
+
+//-------------------------------------------------------
+
+#ifndef WIN32
+
+int Daemon::run() {
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::string path = m_socket.string();
+  if (path.size() >= sizeof(address.sun_path)) {
+    std::cerr << Console::red << "socket path too long: " << path << Console::gray << std::endl;
+    return 1;
+  }
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+  // a client gone while we answer is not a reason to stop
+  signal(SIGPIPE, SIG_IGN);
+
+  m_listen = socket(AF_UNIX, SOCK_STREAM, 0);
+  std::error_code removed;
+  fs::remove(m_socket, removed);
+  if (m_listen < 0
+    || bind(m_listen, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+    || listen(m_listen, 16) != 0) {
+    std::cerr << Console::red << "cannot listen on " << path << ": " << std::strerror(errno) << Console::gray << std::endl;
+    if (m_listen >= 0) {
+      close(m_listen);
+    }
+    return 1;
+  }
+  std::cout << "chill-export serving on " << path << std::endl;
+
+  while (!m_stop) {
+    int client = accept(m_listen, nullptr, nullptr);
+    if (client < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    reap();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_clients.insert(client);
+    m_threads.emplace_back(&Daemon::serve, this, client);
+  }
+
+  {
+    // wakes up the clients waiting for a request
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (int client : m_clients) {
+      ::shutdown(client, SHUT_RDWR);
+    }
+  }
+  for (std::thread& thread : m_threads) {
+    thread.join();
+  }
+  close(m_listen);
+  fs::remove(m_socket, removed);
+  std::cout << m_requests << " requests, " << m_failed << " failed" << std::endl;
+  return 0;
+}
+
+//-------------------------------------------------------
+
+void Daemon::serve(int _client) {
+  std::string pending;
+  char buffer[4096];
+  while (!m_stop) {
+    ssize_t received = recv(_client, buffer, sizeof(buffer), 0);
+    if (received <= 0) {
+      break;
+    }
+    pending.append(buffer, static_cast<size_t>(received));
+    size_t end;
+    while ((end = pending.find('\n')) != std::string::npos) {
+      std::string answer = handle(pending.substr(0, end)) + "\n";
+      pending.erase(0, end + 1);
+      size_t sent = 0;
+      while (sent < answer.size()) {
+        ssize_t written = send(_client, answer.data() + sent, answer.size() - sent, 0);
+        if (written <= 0) {
+          break;
+        }
+        sent += static_cast<size_t>(written);
+      }
+    }
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_clients.erase(_client);
+  close(_client);
+  m_finished.push_back(std::this_thread::get_id());
+}
+
+//-------------------------------------------------------
+
+void Daemon::reap() {
+  std::vector<std::thread::id> finished;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    finished.swap(m_finished);
+  }
+  // the threads are leaving serve(), they no longer need the lock
+  for (std::thread::id id : finished) {
+    auto thread = std::find_if(m_threads.begin(), m_threads.end(), [id](const std::thread& _thread) { return _thread.get_id() == id; });
+    if (thread != m_threads.end()) {
+      thread->join();
+      m_threads.erase(thread);
+    }
+  }
+}
+
+#else
+
+int Daemon::run() {
+  std::cerr << Console::red << "the daemon needs UNIX sockets, not available on this platform" << Console::gray << std::endl;
+  return 1;
+}
+
+void Daemon::serve(int) {
+}
+
+void Daemon::reap() {
+}
+
+#endif
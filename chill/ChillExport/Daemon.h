@@ -0,0 +1,111 @@
+/** @file */
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GraphExporter.h"
+#include "Graphs.h"
+#include "LuaWriter.h"
+#include "OutputSlots.h"
+#include "ScalarEvaluator.h"
+
+namespace chill {
+  class ProcessingGraph;
+}
+
+/**
+ *  Daemon class.
+ *  Keeps graphs and node files in memory between exports, for the scripts that
+ *  export many variants: a request costs the export, not a process start and a load.
+ *  Clients connect to a UNIX socket and send one request per line, answered by one line:
+ *
+ *    load <name> <file.graph>      load a graph, or load it again, under a name
+ *    set <name> <tweak>=<value>    set the tweaks with this name, see ProcessingGraph::tweaks
+ *    export <name> <file.lua>      write the IceSL script of the graph
+ *    stats [<name>]                the figures of the daemon, or of a graph
+ *    close <name>                  forget a graph
+ *    refresh                       read the node files again at the next exports
+ *    shutdown                      stop the daemon
+ *
+ *  The answers are "ok <ms> key=value..." or "error <ms> <message>", where ms is
+ *  the time spent on the request in the daemon.
+ *  The clients are served in parallel, the requests on a same graph one at a time.
+ **/
+class Daemon
+{
+public:
+  /**
+   *  @param _socket The path of the socket, replaced if it exists.
+   *  @param _options How the scripts are written.
+   **/
+  Daemon(const fs::path& _socket, const chill::ExportOptions& _options);
+
+  /**
+   *  Serve the clients until a shutdown request.
+   *  @return The exit code of the tool.
+   **/
+  int run();
+
+  /**
+   *  Answer a request, without the socket.
+   *  @param _request The request line.
+   *  @return The answer line, without the line feed.
+   **/
+  std::string handle(const std::string& _request);
+
+private:
+  /** A loaded graph */
+  struct Graph {
+    std::mutex                              mutex;
+    fs::path                                file;
+    std::shared_ptr<chill::ProcessingGraph> graph;
+    chill::LuaWriter                        writer;
+    chill::ScalarEvaluator                  evaluator;
+    // the same slots from an export to the next, for IceSL running the script again
+    chill::OutputSlots                      slots;
+    size_t                                  nodes     = 0;
+    size_t                                  sets      = 0;
+    size_t                                  exports   = 0;
+    size_t                                  bytes     = 0;
+    double                                  load_ms   = 0.0;
+    double                                  export_ms = 0.0;
+  };
+
+  /** Serve a client until it disconnects, client thread */
+  void serve(int _client);
+
+  /** Join the threads of the clients that left, listening thread */
+  void reap();
+
+  std::shared_ptr<Graph> find(const std::string& _name);
+
+  // the requests, _reply receives the figures or the error
+  bool load(const std::string& _name, const std::string& _file, std::string& _reply);
+  bool set(const std::string& _name, const std::string& _assignment, std::string& _reply);
+  bool exportTo(const std::string& _name, const std::string& _file, std::string& _reply);
+  bool stats(const std::string& _name, std::string& _reply);
+
+  fs::path             m_socket;
+  chill::ExportOptions m_options;
+  int                  m_listen = -1;
+
+  std::mutex                                    m_mutex;
+  std::map<std::string, std::shared_ptr<Graph>> m_graphs;
+  std::set<int>                                 m_clients;
+  std::vector<std::thread>                      m_threads;
+  // the threads whose client left, joined by reap()
+  std::vector<std::thread::id>                  m_finished;
+
+  std::atomic<bool>   m_stop;
+  std::atomic<size_t> m_requests;
+  std::atomic<size_t> m_failed;
+  // microseconds, to be atomic
+  std::atomic<size_t> m_busy_us;
+};
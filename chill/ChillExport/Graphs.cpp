@@ -0,0 +1,50 @@
+#include "Graphs.h"
+
+#include <mutex>
+
+#include "GraphBinary.h"
+#include "GraphLoader.h"
+#include "GraphSaver.h"
+#include "ProcessingGraph.h"
+
+using namespace chill;
+
+namespace {
+  // luabind is not meant for several states at once, the graphs that have to
+  // run in Lua are loaded one at a time
+  std::mutex s_lua_mutex;
+}
+
+//-------------------------------------------------------
+
+std::shared_ptr<ProcessingGraph> loadGraph(const fs::path& _filename, std::string& _error) {
+  std::string reason;
+  std::unique_ptr<GraphLoader> loader = GraphLoader::open(_filename, reason);
+  if (loader) {
+    loader->finish();
+    return loader->graph();
+  }
+  if (GraphBinary::recognize(_filename)) {
+    _error = reason;
+    return nullptr;
+  }
+  // not written by ProcessingGraph::save, let Lua run it
+  std::lock_guard<std::mutex> lock(s_lua_mutex);
+  GraphSaver saver;
+  saver.execute(&_filename);
+  if (!saver.mainGraph()) {
+    _error = "no main graph in Lua (" + reason + ")";
+  }
+  return saver.mainGraph();
+}
+
+//-------------------------------------------------------
+
+size_t countNodes(ProcessingGraph& _graph) {
+  size_t count = 0;
+  for (std::shared_ptr<Processor> processor : *_graph.processors()) {
+    ProcessingGraph* inner = dynamic_cast<ProcessingGraph*>(processor.get());
+    count += 1 + (inner ? countNodes(*inner) : 0);
+  }
+  return count;
+}
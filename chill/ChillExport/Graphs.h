@@ -0,0 +1,28 @@
+/** @file */
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace chill {
+  class ProcessingGraph;
+}
+
+#ifdef WIN32
+namespace fs = std::experimental::filesystem;
+#else
+namespace fs = std::filesystem;
+#endif
+
+/**
+ *  Load a graph file, written by ProcessingGraph::save or by an older version
+ *  run in Lua. Thread safe, the graphs that run in Lua are loaded one at a time.
+ *  @param _filename The graph file.
+ *  @param _error Why it did not load.
+ *  @return The main graph, nullptr if it did not load.
+ **/
+std::shared_ptr<chill::ProcessingGraph> loadGraph(const fs::path& _filename, std::string& _error);
+
+/** The number of nodes of a graph, the nested graphs included */
+size_t countNodes(chill::ProcessingGraph& _graph);
@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <LibSL/LibSL.h>
+
+#include "Daemon.h"
+#include "GraphExporter.h"
+#include "GraphSweep.h"
+#include "Graphs.h"
+#include "IOs.h"
+#include "NodeLibrary.h"
+#include "Parallel.h"
+#include "ProcessingGraph.h"
+#include "TaskPool.h"
+
+using namespace chill;
+
+namespace {
+  typedef std::chrono::high_resolution_clock Clock;
+
+  double since(Clock::time_point _start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - _start).count();
+  }
+
+  /** A tweak value given on the command line, name=value */
+  struct Override {
+    std::string name;
+    std::string value;
+  };
+
+  /** A graph to export, and how it went */
+  struct Job {
+    fs::path    graph;
+    fs::path    script;
+    size_t      nodes     = 0;
+    size_t      bytes     = 0;
+    ExportStats stats;
+    double      load_ms   = 0.0;
+    double      export_ms = 0.0;
+    std::string error;
+  };
+
+  void run(Job& _job, const std::vector<Override>& _overrides, const ExportOptions& _options) {
+    auto start = Clock::now();
+    std::shared_ptr<ProcessingGraph> graph = loadGraph(_job.graph, _job.error);
+    _job.load_ms = since(start);
+    if (!graph) {
+      return;
+    }
+    _job.nodes = countNodes(*graph);
+
+    for (const Override& o : _overrides) {
+      std::vector<std::shared_ptr<ProcessorInput>> tweaks = graph->tweaks(o.name);
+      if (tweaks.empty()) {
+        _job.error = "no tweak " + o.name;
+        return;
+      }
+      for (std::shared_ptr<ProcessorInput> tweak : tweaks) {
+        if (!tweak->setValue(o.value)) {
+          _job.error = "'" + o.value + "' is not a value of " + o.name;
+          return;
+        }
+      }
+    }
+
+    start = Clock::now();
+    LuaWriter writer;
+    _job.stats = GraphExporter::write(*graph, writer, _options);
+    if (!writer.save(_job.script)) {
+      _job.error = "cannot write " + _job.script.string();
+    }
+    _job.bytes     = writer.size();
+    _job.export_ms = since(start);
+  }
+
+  /** The chill-nodes folder of an installation, looked for as the editor does */
+  std::string findNodes() {
+    std::vector<fs::path> candidates = {
+      fs::current_path() / "chill-nodes",
+      fs::path("..") / "chill-nodes",
+      fs::path("../..") / "chill-nodes",
+    };
+    for (const fs::path& candidate : candidates) {
+      if (fs::is_directory(candidate)) {
+        return fs::absolute(candidate).string();
+      }
+    }
+    return std::string();
+  }
+}
+
+//-------------------------------------------------------
+
+/** Export the variants of a single graph */
+static int sweep(const fs::path& _graph, GraphSweep& _sweep, const std::string& _output, size_t _workers) {
+  std::string error;
+  auto start = Clock::now();
+  std::shared_ptr<ProcessingGraph> graph = loadGraph(_graph, error);
+  if (!graph) {
+    std::cerr << Console::red << _graph.string() << ": " << error << Console::gray << std::endl;
+    return 1;
+  }
+  // the workers instantiate the graph from its description, and share the node sources
+  GraphData data = GraphData::capture(*graph);
+  double load_ms = since(start);
+  NodeLibrary::Instance().setKeepSources(true);
+
+  std::string stem   = _graph.stem().string();
+  fs::path    folder = _output.empty() ? _graph.parent_path() / (stem + "-variants") : fs::path(_output);
+  TaskPool    pool(_workers);
+  GraphSweep::Stats stats;
+  bool done = _sweep.run(data.view(), folder, stem, pool, stats, error);
+  if (!done) {
+    std::cerr << Console::red << _graph.string() << ": " << error << Console::gray << std::endl;
+  }
+  if (stats.variants == 0) {
+    return done ? 0 : 1;
+  }
+  std::cout << std::fixed << std::setprecision(1)
+            << stats.variants - stats.failed << " of " << stats.variants << " variants exported to " << folder.string()
+            << " in " << stats.ms << " ms (" << 1000.0 * static_cast<double>(stats.variants) / std::max(stats.ms, 1e-3) << " variants/s), "
+            << stats.bytes << " bytes" << std::endl;
+  if (stats.folded + stats.deduplicated > 0) {
+    std::cout << stats.folded << " nodes folded, " << stats.deduplicated << " deduplicated" << std::endl;
+  }
+  std::cout << "graph loaded in " << load_ms << " ms, instantiated " << stats.instances << " times, "
+            << pool.workers() << " workers, " << pool.steals() << " steals" << std::endl;
+  return done ? 0 : 1;
+}
+
+//-------------------------------------------------------
+
+static void usage() {
+  std::cout << "usage: chill-export [options] <file.graph>..." << std::endl
+            << "  write the IceSL script of each graph, without window nor IceSL" << std::endl
+            << "  -o <path>        the .lua file when there is one graph, else a folder" << std::endl
+            << "                   (default: next to each graph)" << std::endl
+            << "  -s <name>=<val>  set the tweaks with this name, or processor/name, in every graph" << std::endl
+            << "  -j <n>           graphs exported at once (default: one per core)" << std::endl
+            << "  --fold           write the values of the nodes computing constants instead of their code" << std::endl
+            << "  --dedupe         write the code of identical nodes once, the others take its outputs" << std::endl
+            << "  --memo <n>       let IceSL keep the outputs of n nodes between the runs of a script" << std::endl
+            << "  --slots          pass the values through an array of numbered slots instead of named globals" << std::endl
+            << "  --ui-tweaks      write the boolean, integer and real tweaks as IceSL tweaks, set in IceSL" << std::endl
+            << "  --nodes <dir>    the node files (default: chill-nodes, next to or above the current folder)" << std::endl
+            << "  --index <file>   keep the signatures of the nodes in this file between runs" << std::endl
+            << "  --serve <socket> keep running, and export the graphs asked on this UNIX socket" << std::endl
+            << "                   requests: load <name> <file>, set <name> <tweak>=<value>," << std::endl
+            << "                   export <name> <file.lua>, stats [<name>], close <name>, refresh, shutdown" << std::endl
+            << "sweep, a single graph exported once per combination of tweak values:" << std::endl
+            << "  --sweep <name>=<v1;v2;...>     these values" << std::endl
+            << "  --sweep <name>=<min:max:n>     n evenly spaced numbers" << std::endl
+            << "  --sweep <name>=<min:max>       numbers drawn at random, with --random" << std::endl
+            << "  --random <n>     n variants drawn at random instead of the whole grid" << std::endl
+            << "  --seed <s>       the seed of the random draws (default: 0)" << std::endl
+            << "  --variants <file> the variants listed in a file: the names, then one line of values each" << std::endl
+            << "                   -s sets a tweak in every variant, -o is the folder of the scripts" << std::endl
+            << "                   (default: <graph>-variants next to the graph)" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  std::vector<Job>      jobs;
+  std::vector<Override> overrides;
+  std::string output;
+  std::string nodes;
+  std::string index;
+  std::string socket;
+  ExportOptions options;
+  size_t      workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+  GraphSweep  variants;
+  bool        sweeping = false;
+  size_t      random   = 0;
+  uint64_t    seed     = 0;
+  std::string error;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string option = argv[i];
+    bool has_value = i + 1 < argc;
+    if (option == "-h" || option == "--help") {
+      usage();
+      return 0;
+    } else if (option == "-o" && has_value) {
+      output = argv[++i];
+    } else if (option == "-s" && has_value) {
+      std::string assignment = argv[++i];
+      size_t equal = assignment.find('=');
+      if (equal == std::string::npos || equal == 0) {
+        std::cerr << Console::red << "expected -s <name>=<value>, got " << assignment << Console::gray << std::endl;
+        return 1;
+      }
+      overrides.push_back({ assignment.substr(0, equal), assignment.substr(equal + 1) });
+    } else if (option == "--fold") {
+      options.fold_constants = true;
+    } else if (option == "--dedupe") {
+      options.deduplicate = true;
+    } else if (option == "--slots") {
+      options.slots = true;
+    } else if (option == "--ui-tweaks") {
+      options.ui_tweaks = ExportOptions::UI_ALL;
+    } else if (option == "--memo" && has_value) {
+      options.memo_entries = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+    } else if (option == "-j" && has_value) {
+      workers = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+    } else if (option == "--nodes" && has_value) {
+      nodes = argv[++i];
+    } else if (option == "--index" && has_value) {
+      index = argv[++i];
+    } else if (option == "--serve" && has_value) {
+      socket = argv[++i];
+    } else if (option == "--sweep" && has_value) {
+      sweeping = true;
+      if (!variants.addAxis(argv[++i], error)) {
+        std::cerr << Console::red << error << Console::gray << std::endl;
+        return 1;
+      }
+    } else if (option == "--random" && has_value) {
+      sweeping = true;
+      random   = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+    } else if (option == "--seed" && has_value) {
+      seed = std::strtoull(argv[++i], nullptr, 10);
+    } else if (option == "--variants" && has_value) {
+      sweeping = true;
+      if (!variants.loadVariants(argv[++i], error)) {
+        std::cerr << Console::red << error << Console::gray << std::endl;
+        return 1;
+      }
+    } else if (!option.empty() && option[0] == '-') {
+      std::cerr << Console::red << "unknown option " << option << Console::gray << std::endl;
+      usage();
+      return 1;
+    } else {
+      Job job;
+      job.graph = option;
+      jobs.push_back(job);
+    }
+  }
+  if (jobs.empty() && socket.empty()) {
+    usage();
+    return 1;
+  }
+
+  if (nodes.empty()) {
+    nodes = findNodes();
+  }
+  while (nodes.size() > 1 && (nodes.back() == '/' || nodes.back() == '\\')) {
+    nodes.pop_back();
+  }
+  if (nodes.empty() || !fs::is_directory(nodes)) {
+    std::cerr << Console::red << "cannot find the node files, use --nodes" << Console::gray << std::endl;
+    return 1;
+  }
+  NodeLibrary::Instance().setFolder(nodes, index);
+
+  if (!socket.empty()) {
+    Daemon daemon(socket, options);
+    int result = daemon.run();
+    NodeLibrary::Instance().index().save();
+    return result;
+  }
+
+  if (sweeping) {
+    if (jobs.size() != 1) {
+      std::cerr << Console::red << "a sweep exports a single graph" << Console::gray << std::endl;
+      return 1;
+    }
+    // the tweaks set with -s are axes of a single value
+    for (const Override& o : overrides) {
+      variants.addAxis(o.name + "=" + o.value, error);
+    }
+    if (random > 0) {
+      variants.setRandom(random, seed);
+    }
+    variants.setOptions(options);
+    int result = sweep(jobs.front().graph, variants, output, workers);
+    NodeLibrary::Instance().index().save();
+    return result;
+  }
+
+  // a single .lua file, a folder, or next to the graphs
+  bool to_file = jobs.size() == 1 && fs::path(output).extension() == ".lua";
+  if (!output.empty() && !to_file) {
+    std::error_code error;
+    fs::create_directories(output, error);
+  }
+  for (Job& job : jobs) {
+    if (to_file) {
+      job.script = output;
+    } else if (!output.empty()) {
+      job.script = fs::path(output) / job.graph.filename().replace_extension(".lua");
+    } else {
+      job.script = fs::path(job.graph).replace_extension(".lua");
+    }
+  }
+
+  auto start = Clock::now();
+  parallelFor(jobs.size(), workers, [&](size_t _i) {
+    run(jobs[_i], overrides, options);
+  });
+  double total_ms = since(start);
+
+  std::cout << std::right
+            << std::setw(10) << "load ms"
+            << std::setw(11) << "export ms"
+            << std::setw(8)  << "nodes"
+            << std::setw(8)  << "folded"
+            << std::setw(8)  << "dedup"
+            << std::setw(12) << "bytes" << "  graph" << std::endl;
+  size_t failed = 0;
+  for (const Job& job : jobs) {
+    std::cout << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << job.load_ms
+              << std::setw(11) << job.export_ms
+              << std::setw(8)  << job.nodes
+              << std::setw(8)  << job.stats.folded
+              << std::setw(8)  << job.stats.deduplicated
+              << std::setw(12) << job.bytes << "  " << job.graph.string() << std::endl;
+    if (!job.error.empty()) {
+      std::cerr << Console::red << job.graph.string() << ": " << job.error << Console::gray << std::endl;
+      failed++;
+    }
+  }
+  std::cout << jobs.size() - failed << " of " << jobs.size() << " graphs exported in "
+            << std::setprecision(1) << total_ms << " ms, " << workers << " at once ("
+            << (total_ms > 0.0 ? 1000.0 * static_cast<double>(jobs.size()) / total_ms : 0.0) << " graphs/s)" << std::endl;
+
+  NodeLibrary::Instance().index().save();
+  return failed == 0 ? 0 : 1;
+}
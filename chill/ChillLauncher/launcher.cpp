@@ -1,6 +1,17 @@
 #include "NodeEditor.h"
 
+#include <cstring>
+
 int main(int argc, char **argv) {
+  // --record <session> : record the inputs while editing
+  // --replay <session> : replay a recorded session without window
+  if (argc == 3 && std::strcmp(argv[1], "--replay") == 0) {
+    return chill::NodeEditor::replay(argv[2]);
+  }
+  if (argc == 3 && std::strcmp(argv[1], "--record") == 0) {
+    chill::NodeEditor::launch(argv[2]);
+    return 0;
+  }
   chill::NodeEditor::launch();
   return 0;
 }